@@ -0,0 +1,70 @@
+#include<iostream>
+#include<string>
+#include<cstdlib>
+
+#include "VulkanEngine.h"
+#include "BenchmarkApp.h"
+
+int main(int argc, char const *argv[])
+{
+    // --objects N --pipelines M --textures K [--texture-size S] [--static-uniforms] [--seed N]
+    // --frames N [--warmup N] [--width W --height H] [--windowed] [--output FILE] [--trace FILE] [--api-stats]
+    BenchmarkConfig config;
+    std::string traceFilename;
+    bool apiStats = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--objects" && i + 1 < argc)
+            config.scene.objectCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--pipelines" && i + 1 < argc)
+            config.scene.pipelineCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--textures" && i + 1 < argc)
+            config.scene.textureCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--texture-size" && i + 1 < argc)
+            config.scene.textureSize = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--static-uniforms")
+            config.scene.dynamicUniforms = false;
+        else if (arg == "--seed" && i + 1 < argc)
+            config.scene.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--frames" && i + 1 < argc)
+            config.frameCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--warmup" && i + 1 < argc)
+            config.warmupFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--width" && i + 1 < argc)
+            config.width = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--height" && i + 1 < argc)
+            config.height = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--windowed")
+            config.headless = false;
+        else if (arg == "--output" && i + 1 < argc)
+            config.outputFilename = argv[++i];
+        else if (arg == "--trace" && i + 1 < argc)
+            traceFilename = argv[++i];
+        else if (arg == "--api-stats")
+            apiStats = true;
+        else
+        {
+            std::cout << "Unknown benchmark argument " << arg << ".\n";
+            return -1;
+        }
+    }
+
+    if (traceFilename.empty() == false)
+        VulkanEngine::getInstance().enableTrace(traceFilename);
+    if (apiStats)
+        VulkanEngine::getInstance().enableApiStats(false);
+
+    auto &benchmarkApp = BenchmarkApp::getInstance();
+    if (benchmarkApp.init(config) == false)
+    {
+        std::cout << "Failed to initialize the benchmark.\n";
+        return -1;
+    }
+
+    const bool measured = benchmarkApp.run();
+
+    benchmarkApp.cleanup();
+
+    return measured ? 0 : -1;
+}
\ No newline at end of file
@@ -2,9 +2,8 @@
 #define QUAD_H
 
 #include "VulkanHelper.h"
-#include "VulkanGraphicsPipeline.h"
-#include "VulkanDescriptorPool.h"
-#include "VulkanDescriptorSets.h"
+#include "VulkanPipelineRegistry.h"
+#include "VulkanDescriptorAllocator.h"
 #include "VulkanImage.h"
 #include "VulkanEngine.h"
 #include "VulkanRenderableObject.h"
@@ -17,35 +16,54 @@ public:
     Quad(VkDevice device);
     ~Quad() override = default;
 
-    bool init(const VulkanEngine &engine,
+    bool init(VulkanEngine &engine,
         uint32_t width, uint32_t height,
-        const std::vector<VkPipelineShaderStageCreateInfo> &shaderStagesInfo) override;
+        const std::vector<const VulkanShader*> &shaders) override;
     void cleanup() override;
     void render(VkCommandBuffer currentCommandBuffer) const override;
     void update(double dt, uint32_t frameIndex) override;
+    float sortDepth() const override;
+    std::string name() const override { return "quad"; }
+    // Blocks until the background compilation of the pipeline is over
+    bool waitForPipeline();
 
 private:
 
     // Uniform buffer object
     struct UniformBufferObject
     {
-        glm::mat4 model;
         glm::mat4 view;
         glm::mat4 proj;
     };
 
+    // Per draw data - pushed with the draw instead of going through the uniform ring
+    struct PushConstants
+    {
+        glm::mat4 model;
+    };
+
+    // Specialization constant ids of triangle.frag
+    static const uint32_t FragmentConstantBrightness = 0;
+
     // Members
-    VulkanGraphicsPipeline m_pipeline;
-    VulkanDescriptorPool m_descriptorPool;
-    VulkanDescriptorSets m_descriptorSets;
+    // Folded into the fragment shader when the pipeline is compiled
+    float m_brightness = 1.0f;
+    // Shared with the objects that use the same pipeline state
+    VulkanPipelineHandle m_pipeline;
+    VulkanPipelineRegistry *m_pipelineRegistry = nullptr;
+    VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
 
     VulkanBuffer m_quadVertexBuffer;
     VulkanBuffer m_quadIndexBuffer;
-    VulkanBuffer m_quadUniformBuffer;
     VulkanImage m_testImage;
 
+    // Per frame uniform data is streamed through the engine uniform ring
     UniformBufferObject m_quadUniformData;
+    PushConstants m_quadPushConstants;
+    VulkanUniformRing *m_uniformRing = nullptr;
+    uint32_t m_uniformDynamicOffset = 0;
     
+    // Owned by the engine layout cache
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
     VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
 
@@ -54,12 +72,17 @@ private:
     uint32_t m_width, m_height;
 
     // Methods
-    bool setupGeometry(const VulkanPhysicalDevice &physicalDevice, VkDevice device, const VulkanQueue &graphicsQueue, uint32_t framesInFlight);
-    bool createPipelineLayout(VkDevice device);
+    bool setupGeometry(const VulkanPhysicalDevice &physicalDevice, 
+        VkDevice device, 
+        VulkanMemoryAllocator &allocator, 
+        VulkanUploadManager &uploadManager);
+    bool setupDescriptorSets(VulkanDescriptorAllocator &descriptorAllocator);
+    bool createPipelineLayout(VulkanLayoutCache &layoutCache, const std::vector<const VulkanShader*> &shaders);
     bool createGraphicsPipeline(VkDevice device, 
         uint32_t width, uint32_t height, 
-        VkRenderPass renderPass,
-        const std::vector<VkPipelineShaderStageCreateInfo> &shaderStagesInfo);
+        const VulkanRenderPass &renderPass,
+        const std::vector<const VulkanShader*> &shaders,
+        VulkanPipelineRegistry &pipelineRegistry);
 
 };
 
@@ -24,9 +24,11 @@ public:
     VulkanApp(const VulkanApp &other) = delete;
     void operator=(const VulkanApp &other) = delete;
 
-    bool init(uint32_t width, uint32_t height);
+    // Headless - no window, the frames are rendered offscreen
+    bool init(uint32_t width, uint32_t height, bool headless = false);
     void cleanup();
-    void run();
+    // Until the window is closed, or frameCount frames when headless
+    void run(uint32_t frameCount = 0);
 
 private:
 
@@ -36,6 +38,7 @@ private:
     void mainLoop();
 
     Window m_window;
+    bool m_headless = false;
 
     VulkanEngine &m_vulkanEngine = VulkanEngine::getInstance();
     VulkanShader m_quadVertexShader, m_quadFragmentShader;
@@ -0,0 +1,84 @@
+#ifndef BENCHMARKAPP_H
+#define BENCHMARKAPP_H
+
+#include "VulkanHelper.h"
+#include "VulkanEngine.h"
+#include "Window.h"
+
+#include "BenchmarkScene.h"
+
+#include <string>
+#include <vector>
+
+struct BenchmarkConfig
+{
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    // Offscreen - no window or display needed
+    bool headless = true;
+    // Rendered before measuring, once every pipeline is compiled
+    uint32_t warmupFrames = 30;
+    uint32_t frameCount = 500;
+    BenchmarkSceneDesc scene;
+    std::string outputFilename = "./benchmark.json";
+};
+
+// Distribution of a per frame measure, in milliseconds
+struct BenchmarkStatistics
+{
+    uint32_t sampleCount = 0;
+    double minMilliseconds = 0.0;
+    double avgMilliseconds = 0.0;
+    double p50Milliseconds = 0.0;
+    double p90Milliseconds = 0.0;
+    double p99Milliseconds = 0.0;
+    double maxMilliseconds = 0.0;
+};
+
+// Renders a generated scene for a fixed number of frames and writes the frame time, the engine
+// CPU timings and the GPU frame time as JSON
+class BenchmarkApp
+{
+
+public:
+
+    static BenchmarkApp& getInstance()
+    {
+        static BenchmarkApp instance;
+        return instance;
+    }
+
+    BenchmarkApp(const BenchmarkApp &other) = delete;
+    void operator=(const BenchmarkApp &other) = delete;
+
+    bool init(const BenchmarkConfig &config);
+    void cleanup();
+    // Measure then write the results
+    bool run();
+
+private:
+
+    BenchmarkApp() {}
+
+    void renderFrame(double dt);
+    bool writeResults() const;
+
+    static BenchmarkStatistics computeStatistics(std::vector<double> samples);
+
+    BenchmarkConfig m_config;
+    Window m_window;
+
+    VulkanEngine &m_vulkanEngine = VulkanEngine::getInstance();
+    VulkanShader m_vertexShader, m_fragmentShader;
+    BenchmarkScene m_scene;
+
+    // One sample per measured frame - the GPU ones lag by the frames in flight
+    std::vector<double> m_frameMilliseconds;
+    std::vector<double> m_waitMilliseconds;
+    std::vector<double> m_recordMilliseconds;
+    std::vector<double> m_submitMilliseconds;
+    std::vector<double> m_gpuMilliseconds;
+
+};
+
+#endif // BENCHMARKAPP_H
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef BENCHMARKOBJECT_H
+#define BENCHMARKOBJECT_H
+
+#include "VulkanHelper.h"
+#include "VulkanEngine.h"
+#include "VulkanRenderableObject.h"
+
+#include <glm/glm.hpp>
+
+class BenchmarkScene;
+
+// Uniform block of shaders/benchmark.vert
+struct BenchmarkUniforms
+{
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::vec4 tint;
+};
+
+// One generated object - the pipelines, geometry and textures belong to the scene.
+// With dynamic uniforms the uniform block is rewritten through the uniform ring every frame,
+// otherwise it is written once into the scene uniform buffer.
+class BenchmarkObject : public VulkanRenderableObject
+{
+
+public:
+
+    BenchmarkObject(BenchmarkScene &scene, uint32_t objectIndex, uint32_t pipelineIndex, uint32_t textureIndex, const glm::mat4 &model);
+    ~BenchmarkObject() override = default;
+
+    // The shaders are unused - the scene owns the pipelines
+    bool init(VulkanEngine &engine,
+        uint32_t width, uint32_t height,
+        const std::vector<const VulkanShader*> &shaders) override;
+    void cleanup() override;
+    void render(VkCommandBuffer currentCommandBuffer) const override;
+    void update(double dt, uint32_t frameIndex) override;
+    float sortDepth() const override;
+    std::string name() const override { return "object"; }
+
+private:
+
+    // Per draw data - pushed with the draw
+    struct PushConstants
+    {
+        glm::mat4 model;
+    };
+
+    BenchmarkScene &m_scene;
+    uint32_t m_objectIndex;
+    uint32_t m_pipelineIndex;
+    uint32_t m_textureIndex;
+
+    VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+    BenchmarkUniforms m_uniformData;
+    PushConstants m_pushConstants;
+    VulkanUniformRing *m_uniformRing = nullptr;
+    // Always 0 with static uniforms - the descriptor points at the object element
+    uint32_t m_uniformDynamicOffset = 0;
+    double m_time = 0.0;
+
+    uint32_t m_width = 0, m_height = 0;
+
+};
+
+#endif // BENCHMARKOBJECT_H
\ No newline at end of file
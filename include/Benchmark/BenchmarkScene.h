@@ -0,0 +1,103 @@
+#ifndef BENCHMARKSCENE_H
+#define BENCHMARKSCENE_H
+
+#include "VulkanHelper.h"
+#include "VulkanEngine.h"
+#include "VulkanPipelineRegistry.h"
+#include "VulkanBuffer.h"
+#include "VulkanImage.h"
+#include "BenchmarkObject.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// What the benchmark scene is generated from
+struct BenchmarkSceneDesc
+{
+    uint32_t objectCount = 1000;
+    // Distinct pipeline states - the objects pick one at random
+    uint32_t pipelineCount = 4;
+    // Distinct textures - the objects pick one at random
+    uint32_t textureCount = 16;
+    uint32_t textureSize = 64;
+    // Uniform blocks rewritten through the uniform ring every frame, or written once at init
+    bool dynamicUniforms = true;
+    uint32_t seed = 1;
+};
+
+// Synthetic scene of textured quads drawn with shaders/benchmark.vert and benchmark.frag.
+// The objects are spread over the screen at random depths so the engine sorts them and
+// switches pipelines and descriptor sets between most draws.
+class BenchmarkScene
+{
+
+public:
+
+    BenchmarkScene() = default;
+    ~BenchmarkScene() = default;
+
+    BenchmarkScene(const BenchmarkScene &other) = delete;
+    void operator=(const BenchmarkScene &other) = delete;
+
+    // Creates the objects and adds them to the engine
+    bool init(VulkanEngine &engine,
+        const BenchmarkSceneDesc &desc,
+        uint32_t width, uint32_t height,
+        const std::vector<const VulkanShader*> &shaders);
+    void cleanup();
+    void update(double dt, uint32_t frameIndex);
+    // Block until every pipeline is compiled - the measured frames must draw every object
+    bool waitForPipelines();
+
+    // Written once per object by the objects with static uniforms
+    bool writeStaticUniforms(uint32_t objectIndex, const BenchmarkUniforms &uniforms);
+
+    // Shared by the objects
+    const inline BenchmarkSceneDesc &desc() const { return m_desc; }
+    const inline VkPipelineLayout pipelineLayout() const { return m_pipelineLayout; }
+    const inline VkDescriptorSetLayout descriptorSetLayout() const { return m_descriptorSetLayout; }
+    const inline std::vector<VkPushConstantRange> &pushConstantRanges() const { return m_pushConstantRanges; }
+    const inline VulkanPipelineHandle &pipeline(uint32_t pipelineIndex) const { return m_pipelines[pipelineIndex]; }
+    const inline VulkanBuffer &vertexBuffer() const { return m_vertexBuffer; }
+    const inline VulkanBuffer &indexBuffer() const { return m_indexBuffer; }
+    const inline VulkanImage &texture(uint32_t textureIndex) const { return m_textures[textureIndex]; }
+    const inline VkSampler sampler() const { return m_sampler; }
+    const inline VulkanBuffer &staticUniforms() const { return m_staticUniforms; }
+
+private:
+
+    // Specialization constant ids of benchmark.frag
+    static const uint32_t FragmentConstantBrightness = 0;
+
+    BenchmarkSceneDesc m_desc;
+    VkDevice m_device = VK_NULL_HANDLE;
+    VulkanPipelineRegistry *m_pipelineRegistry = nullptr;
+
+    // Owned by the engine layout cache
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+    std::vector<VkPushConstantRange> m_pushConstantRanges;
+
+    std::vector<VulkanPipelineHandle> m_pipelines;
+    VulkanBuffer m_vertexBuffer;
+    VulkanBuffer m_indexBuffer;
+    std::vector<VulkanImage> m_textures;
+    VkSampler m_sampler = VK_NULL_HANDLE;
+    // One element per object - only with static uniforms
+    VulkanBuffer m_staticUniforms;
+
+    std::vector<std::unique_ptr<BenchmarkObject>> m_objects;
+
+    bool createPipelineLayout(VulkanLayoutCache &layoutCache, const std::vector<const VulkanShader*> &shaders);
+    bool createPipelines(uint32_t width, uint32_t height,
+        const VulkanRenderPass &renderPass,
+        const std::vector<const VulkanShader*> &shaders,
+        VulkanPipelineRegistry &pipelineRegistry);
+    bool createGeometry(VulkanEngine &engine);
+    bool createTextures(VulkanEngine &engine);
+    bool createSampler(VkDevice device);
+
+};
+
+#endif // BENCHMARKSCENE_H
\ No newline at end of file
@@ -0,0 +1,136 @@
+#ifndef CPUPROFILER_H
+#define CPUPROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Zones are only compiled in with ENGINE_CPU_PROFILER - set by the CMake option of the same name
+#ifdef ENGINE_CPU_PROFILER
+#define CPU_PROFILE_CONCAT_INNER(a, b) a##b
+#define CPU_PROFILE_CONCAT(a, b) CPU_PROFILE_CONCAT_INNER(a, b)
+// The name must outlive the profiler - a string literal
+#define CPU_PROFILE_SCOPE(name) CpuProfileScope CPU_PROFILE_CONCAT(cpuProfileScope, __LINE__)(name)
+#define CPU_PROFILE_THREAD(name) CpuProfiler::getInstance().setThreadName(name)
+#else
+#define CPU_PROFILE_SCOPE(name)
+#define CPU_PROFILE_THREAD(name)
+#endif
+
+// Interval of an extra trace track - e.g. GPU scopes moved to the CPU clock
+struct CpuProfilerTrackEvent
+{
+    std::string name;
+    uint64_t beginNanoseconds = 0;
+    uint64_t endNanoseconds = 0;
+};
+
+// Named CPU zones of every thread. Each thread writes its zones into its own fixed size buffer without
+// locking, the buffer is registered once on the first zone of the thread. Zones over the buffer size
+// are dropped. start and stop are called between frames, when no other thread is inside a zone.
+class CpuProfiler
+{
+
+public:
+
+    static const uint32_t DefaultZonesPerThread = 1 << 18;
+
+    static CpuProfiler& getInstance()
+    {
+        static CpuProfiler instance;
+        return instance;
+    }
+
+    CpuProfiler(const CpuProfiler &other) = delete;
+    void operator=(const CpuProfiler &other) = delete;
+
+    // Steady clock in nanoseconds - the clock of every zone and track event
+    static inline uint64_t now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Drop the recorded zones and start recording
+    void start(uint32_t zonesPerThread = DefaultZonesPerThread);
+    void stop();
+    const inline bool recording() const { return m_recording.load(std::memory_order_relaxed); }
+
+    // Name of the calling thread in the trace
+    void setThreadName(const std::string &name);
+    // Lock free once the thread has a buffer
+    void record(const char *name, uint64_t beginNanoseconds, uint64_t endNanoseconds);
+
+    // Chrome trace_event JSON (chrome://tracing, Perfetto) - one row per thread, the track events in a
+    // row of their own on the same timeline
+    bool exportChromeTrace(const std::string &filename,
+        const std::string &trackName = std::string(),
+        const std::vector<CpuProfilerTrackEvent> &trackEvents = std::vector<CpuProfilerTrackEvent>()) const;
+    void printStatistics() const;
+
+private:
+
+    CpuProfiler() {}
+
+    struct Zone
+    {
+        const char *name;
+        uint64_t beginNanoseconds;
+        uint64_t endNanoseconds;
+    };
+
+    // Written by its thread only - the count is published after the zone
+    struct ThreadBuffer
+    {
+        std::string name;
+        uint32_t threadId = 0;
+        std::vector<Zone> zones;
+        std::atomic<uint32_t> zoneCount { 0 };
+        std::atomic<uint64_t> droppedCount { 0 };
+    };
+
+    std::atomic<bool> m_recording { false };
+    uint32_t m_zonesPerThread = DefaultZonesPerThread;
+    uint64_t m_startNanoseconds = 0;
+
+    // Registration only - never taken while recording a zone
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+    // Buffer of the calling thread
+    static thread_local ThreadBuffer *s_threadBuffer;
+
+    ThreadBuffer &threadBuffer();
+
+};
+
+// Records the time between its construction and destruction. Does nothing if the profiler isn't recording.
+class CpuProfileScope
+{
+
+public:
+
+    explicit CpuProfileScope(const char *name)
+        : m_name(name),
+        m_beginNanoseconds(CpuProfiler::getInstance().recording() ? CpuProfiler::now() : 0)
+    {
+    }
+    ~CpuProfileScope()
+    {
+        if (m_beginNanoseconds != 0)
+            CpuProfiler::getInstance().record(m_name, m_beginNanoseconds, CpuProfiler::now());
+    }
+
+    CpuProfileScope(const CpuProfileScope &other) = delete;
+    void operator=(const CpuProfileScope &other) = delete;
+
+private:
+
+    const char *m_name;
+    uint64_t m_beginNanoseconds;
+
+};
+
+#endif // CPUPROFILER_H
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef JOBPOOL_H
+#define JOBPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running parallel for loops. The calling thread takes
+// part in the loop and parallelFor only returns once every task is done.
+class JobPool
+{
+
+public:
+
+    JobPool() = default;
+    ~JobPool() { cleanup(); }
+
+    JobPool(const JobPool &other) = delete;
+    void operator=(const JobPool &other) = delete;
+
+    bool init(uint32_t workerCount);
+    void cleanup();
+
+    // Calls job(taskIndex) for every task index in [0, taskCount)
+    void parallelFor(uint32_t taskCount, const std::function<void(uint32_t)> &job);
+
+    // Workers plus the calling thread
+    inline const uint32_t threadCount() const { return m_workers.size() + 1; }
+
+private:
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_doneCondition;
+
+    // Current loop - guarded by the mutex, the task counter is shared lock free
+    const std::function<void(uint32_t)> *m_job = nullptr;
+    uint32_t m_taskCount = 0;
+    uint32_t m_finishedTaskCount = 0;
+    uint32_t m_activeWorkerCount = 0;
+    uint64_t m_generation = 0;
+    bool m_stop = false;
+    std::atomic<uint32_t> m_nextTask { 0 };
+
+    void workerLoop(uint32_t workerIndex);
+    uint32_t runTasks(const std::function<void(uint32_t)> &job, uint32_t taskCount);
+
+};
+
+#endif // JOBPOOL_H
\ No newline at end of file
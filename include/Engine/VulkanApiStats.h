@@ -0,0 +1,358 @@
+#ifndef VULKANAPISTATS_H
+#define VULKANAPISTATS_H
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "CpuProfiler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Every Vulkan entry point the engine calls. The last ones are loaded through vkGetDeviceProcAddr
+// and counted with VULKAN_API_CALL_POINTER at their call sites.
+#define VULKAN_API_FUNCTIONS(X) \
+    X(vkAcquireNextImageKHR) \
+    X(vkAllocateCommandBuffers) \
+    X(vkAllocateDescriptorSets) \
+    X(vkAllocateMemory) \
+    X(vkBeginCommandBuffer) \
+    X(vkBindBufferMemory) \
+    X(vkBindImageMemory) \
+    X(vkCmdBeginRenderPass) \
+    X(vkCmdBindDescriptorSets) \
+    X(vkCmdBindIndexBuffer) \
+    X(vkCmdBindPipeline) \
+    X(vkCmdBindVertexBuffers) \
+    X(vkCmdCopyBuffer) \
+    X(vkCmdCopyBufferToImage) \
+    X(vkCmdCopyImageToBuffer) \
+    X(vkCmdDraw) \
+    X(vkCmdDrawIndexed) \
+    X(vkCmdEndRenderPass) \
+    X(vkCmdExecuteCommands) \
+    X(vkCmdPipelineBarrier) \
+    X(vkCmdPushConstants) \
+    X(vkCmdResetQueryPool) \
+    X(vkCmdSetScissor) \
+    X(vkCmdSetViewport) \
+    X(vkCmdWriteTimestamp) \
+    X(vkCreateBuffer) \
+    X(vkCreateCommandPool) \
+    X(vkCreateDescriptorPool) \
+    X(vkCreateDescriptorSetLayout) \
+    X(vkCreateDescriptorUpdateTemplate) \
+    X(vkCreateDevice) \
+    X(vkCreateFramebuffer) \
+    X(vkCreateGraphicsPipelines) \
+    X(vkCreateImage) \
+    X(vkCreateImageView) \
+    X(vkCreateInstance) \
+    X(vkCreatePipelineCache) \
+    X(vkCreatePipelineLayout) \
+    X(vkCreateQueryPool) \
+    X(vkCreateRenderPass) \
+    X(vkCreateSampler) \
+    X(vkCreateSemaphore) \
+    X(vkCreateShaderModule) \
+    X(vkCreateSwapchainKHR) \
+    X(vkDestroyBuffer) \
+    X(vkDestroyCommandPool) \
+    X(vkDestroyDescriptorPool) \
+    X(vkDestroyDescriptorSetLayout) \
+    X(vkDestroyDescriptorUpdateTemplate) \
+    X(vkDestroyDevice) \
+    X(vkDestroyFramebuffer) \
+    X(vkDestroyImage) \
+    X(vkDestroyImageView) \
+    X(vkDestroyInstance) \
+    X(vkDestroyPipeline) \
+    X(vkDestroyPipelineCache) \
+    X(vkDestroyPipelineLayout) \
+    X(vkDestroyQueryPool) \
+    X(vkDestroyRenderPass) \
+    X(vkDestroySampler) \
+    X(vkDestroySemaphore) \
+    X(vkDestroyShaderModule) \
+    X(vkDestroySurfaceKHR) \
+    X(vkDestroySwapchainKHR) \
+    X(vkDeviceWaitIdle) \
+    X(vkEndCommandBuffer) \
+    X(vkEnumerateDeviceExtensionProperties) \
+    X(vkEnumerateInstanceExtensionProperties) \
+    X(vkEnumerateInstanceLayerProperties) \
+    X(vkEnumeratePhysicalDevices) \
+    X(vkFreeCommandBuffers) \
+    X(vkFreeMemory) \
+    X(vkGetBufferMemoryRequirements) \
+    X(vkGetDeviceProcAddr) \
+    X(vkGetDeviceQueue) \
+    X(vkGetImageMemoryRequirements) \
+    X(vkGetInstanceProcAddr) \
+    X(vkGetPhysicalDeviceFeatures) \
+    X(vkGetPhysicalDeviceFeatures2) \
+    X(vkGetPhysicalDeviceFormatProperties) \
+    X(vkGetPhysicalDeviceMemoryProperties) \
+    X(vkGetPhysicalDeviceProperties) \
+    X(vkGetPhysicalDeviceProperties2) \
+    X(vkGetPhysicalDeviceQueueFamilyProperties) \
+    X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+    X(vkGetPhysicalDeviceSurfaceFormatsKHR) \
+    X(vkGetPhysicalDeviceSurfacePresentModesKHR) \
+    X(vkGetPhysicalDeviceSurfaceSupportKHR) \
+    X(vkGetPipelineCacheData) \
+    X(vkGetQueryPoolResults) \
+    X(vkGetSwapchainImagesKHR) \
+    X(vkMapMemory) \
+    X(vkQueuePresentKHR) \
+    X(vkQueueSubmit) \
+    X(vkResetCommandPool) \
+    X(vkResetDescriptorPool) \
+    X(vkUnmapMemory) \
+    X(vkUpdateDescriptorSetWithTemplate) \
+    X(vkUpdateDescriptorSets) \
+    X(vkGetSemaphoreCounterValueKHR) \
+    X(vkWaitSemaphoresKHR)
+
+enum class VulkanApiFunction : uint32_t
+{
+#define VULKAN_API_ENUM(function) function,
+    VULKAN_API_FUNCTIONS(VULKAN_API_ENUM)
+#undef VULKAN_API_ENUM
+    Count
+};
+
+struct VulkanApiCallStats
+{
+    uint64_t callCount = 0;
+    uint64_t nanoseconds = 0;
+};
+
+// Calls and CPU time of every Vulkan entry point. Each thread counts into its own counters without
+// locking, registered once on its first call. The counters only grow - start and endFrame keep the
+// totals they were called with and the stats are the differences.
+class VulkanApiStats
+{
+
+public:
+
+    static const uint32_t FunctionCount = static_cast<uint32_t>(VulkanApiFunction::Count);
+
+    static VulkanApiStats& getInstance()
+    {
+        static VulkanApiStats instance;
+        return instance;
+    }
+
+    VulkanApiStats(const VulkanApiStats &other) = delete;
+    void operator=(const VulkanApiStats &other) = delete;
+
+    // Drop the collected stats and start counting - logFrames prints the calls of every frame
+    void start(bool logFrames = false);
+    void stop();
+    const inline bool recording() const { return m_recording.load(std::memory_order_relaxed); }
+
+    // Closes the frame - called once per frame by the thread submitting it
+    void endFrame();
+    // Lock free once the thread has its counters
+    void record(VulkanApiFunction function, uint64_t nanoseconds);
+
+    // Calls of the last ended frame, and of every frame ended since start
+    VulkanApiCallStats frameStats(VulkanApiFunction function) const;
+    VulkanApiCallStats totalStats(VulkanApiFunction function) const;
+    VulkanApiCallStats frameTotal() const;
+    const inline uint64_t frameCount() const { return m_frameCount; }
+
+    static const char *functionName(VulkanApiFunction function);
+    void printStatistics() const;
+
+private:
+
+    VulkanApiStats() {}
+
+    // Written by its thread only
+    struct ThreadCounters
+    {
+        std::atomic<uint64_t> callCounts[FunctionCount];
+        std::atomic<uint64_t> nanoseconds[FunctionCount];
+    };
+
+    std::atomic<bool> m_recording { false };
+    bool m_logFrames = false;
+    uint64_t m_frameCount = 0;
+
+    // Sums of every thread at start, at the end of the previous frame and of the last frame
+    std::vector<VulkanApiCallStats> m_startTotals = std::vector<VulkanApiCallStats>(FunctionCount);
+    std::vector<VulkanApiCallStats> m_previousTotals = std::vector<VulkanApiCallStats>(FunctionCount);
+    std::vector<VulkanApiCallStats> m_lastTotals = std::vector<VulkanApiCallStats>(FunctionCount);
+
+    // Registration and the sums only - never taken while counting a call
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<ThreadCounters>> m_threads;
+    // Counters of the calling thread
+    static thread_local ThreadCounters *s_threadCounters;
+
+    ThreadCounters &threadCounters();
+    void sumCounters(std::vector<VulkanApiCallStats> &totals) const;
+
+};
+
+// Records one call and the time between its construction and destruction. Does nothing if the stats aren't recording.
+class VulkanApiCallScope
+{
+
+public:
+
+    explicit VulkanApiCallScope(VulkanApiFunction function)
+        : m_function(function),
+        m_beginNanoseconds(VulkanApiStats::getInstance().recording() ? CpuProfiler::now() : 0)
+    {
+    }
+    ~VulkanApiCallScope()
+    {
+        if (m_beginNanoseconds != 0)
+            VulkanApiStats::getInstance().record(m_function, CpuProfiler::now() - m_beginNanoseconds);
+    }
+
+    VulkanApiCallScope(const VulkanApiCallScope &other) = delete;
+    void operator=(const VulkanApiCallScope &other) = delete;
+
+private:
+
+    VulkanApiFunction m_function;
+    uint64_t m_beginNanoseconds;
+
+};
+
+// Calls the function with its own parameter types - arguments convert exactly as in a direct call
+template <typename Function>
+struct VulkanApiCall;
+
+template <typename Result, typename... Params>
+struct VulkanApiCall<Result (VKAPI_PTR *)(Params...)>
+{
+    static inline Result call(VulkanApiFunction function, Result (VKAPI_PTR *vkFunction)(Params...), Params... params)
+    {
+        VulkanApiCallScope scope(function);
+        return vkFunction(params...);
+    }
+};
+
+// Calls are only counted with ENGINE_VULKAN_API_STATS - set by the CMake option of the same name.
+// Every entry point is replaced by a macro of the same name once this header is included, so the
+// engine code calls Vulkan as usual. VULKAN_API_STATS_NO_WRAPPERS keeps the plain names - for code
+// defining the entry points.
+#ifdef ENGINE_VULKAN_API_STATS
+#define VULKAN_API_CALL(function, ...) VulkanApiCall<decltype(&::function)>::call(VulkanApiFunction::function, &::function, __VA_ARGS__)
+#define VULKAN_API_CALL_POINTER(function, pointer, ...) VulkanApiCall<PFN_##function>::call(VulkanApiFunction::function, pointer, __VA_ARGS__)
+#else
+#define VULKAN_API_CALL(function, ...) function(__VA_ARGS__)
+#define VULKAN_API_CALL_POINTER(function, pointer, ...) pointer(__VA_ARGS__)
+#endif
+
+#if defined(ENGINE_VULKAN_API_STATS) && !defined(VULKAN_API_STATS_NO_WRAPPERS)
+#define vkAcquireNextImageKHR(...) VULKAN_API_CALL(vkAcquireNextImageKHR, __VA_ARGS__)
+#define vkAllocateCommandBuffers(...) VULKAN_API_CALL(vkAllocateCommandBuffers, __VA_ARGS__)
+#define vkAllocateDescriptorSets(...) VULKAN_API_CALL(vkAllocateDescriptorSets, __VA_ARGS__)
+#define vkAllocateMemory(...) VULKAN_API_CALL(vkAllocateMemory, __VA_ARGS__)
+#define vkBeginCommandBuffer(...) VULKAN_API_CALL(vkBeginCommandBuffer, __VA_ARGS__)
+#define vkBindBufferMemory(...) VULKAN_API_CALL(vkBindBufferMemory, __VA_ARGS__)
+#define vkBindImageMemory(...) VULKAN_API_CALL(vkBindImageMemory, __VA_ARGS__)
+#define vkCmdBeginRenderPass(...) VULKAN_API_CALL(vkCmdBeginRenderPass, __VA_ARGS__)
+#define vkCmdBindDescriptorSets(...) VULKAN_API_CALL(vkCmdBindDescriptorSets, __VA_ARGS__)
+#define vkCmdBindIndexBuffer(...) VULKAN_API_CALL(vkCmdBindIndexBuffer, __VA_ARGS__)
+#define vkCmdBindPipeline(...) VULKAN_API_CALL(vkCmdBindPipeline, __VA_ARGS__)
+#define vkCmdBindVertexBuffers(...) VULKAN_API_CALL(vkCmdBindVertexBuffers, __VA_ARGS__)
+#define vkCmdCopyBuffer(...) VULKAN_API_CALL(vkCmdCopyBuffer, __VA_ARGS__)
+#define vkCmdCopyBufferToImage(...) VULKAN_API_CALL(vkCmdCopyBufferToImage, __VA_ARGS__)
+#define vkCmdCopyImageToBuffer(...) VULKAN_API_CALL(vkCmdCopyImageToBuffer, __VA_ARGS__)
+#define vkCmdDraw(...) VULKAN_API_CALL(vkCmdDraw, __VA_ARGS__)
+#define vkCmdDrawIndexed(...) VULKAN_API_CALL(vkCmdDrawIndexed, __VA_ARGS__)
+#define vkCmdEndRenderPass(...) VULKAN_API_CALL(vkCmdEndRenderPass, __VA_ARGS__)
+#define vkCmdExecuteCommands(...) VULKAN_API_CALL(vkCmdExecuteCommands, __VA_ARGS__)
+#define vkCmdPipelineBarrier(...) VULKAN_API_CALL(vkCmdPipelineBarrier, __VA_ARGS__)
+#define vkCmdPushConstants(...) VULKAN_API_CALL(vkCmdPushConstants, __VA_ARGS__)
+#define vkCmdResetQueryPool(...) VULKAN_API_CALL(vkCmdResetQueryPool, __VA_ARGS__)
+#define vkCmdSetScissor(...) VULKAN_API_CALL(vkCmdSetScissor, __VA_ARGS__)
+#define vkCmdSetViewport(...) VULKAN_API_CALL(vkCmdSetViewport, __VA_ARGS__)
+#define vkCmdWriteTimestamp(...) VULKAN_API_CALL(vkCmdWriteTimestamp, __VA_ARGS__)
+#define vkCreateBuffer(...) VULKAN_API_CALL(vkCreateBuffer, __VA_ARGS__)
+#define vkCreateCommandPool(...) VULKAN_API_CALL(vkCreateCommandPool, __VA_ARGS__)
+#define vkCreateDescriptorPool(...) VULKAN_API_CALL(vkCreateDescriptorPool, __VA_ARGS__)
+#define vkCreateDescriptorSetLayout(...) VULKAN_API_CALL(vkCreateDescriptorSetLayout, __VA_ARGS__)
+#define vkCreateDescriptorUpdateTemplate(...) VULKAN_API_CALL(vkCreateDescriptorUpdateTemplate, __VA_ARGS__)
+#define vkCreateDevice(...) VULKAN_API_CALL(vkCreateDevice, __VA_ARGS__)
+#define vkCreateFramebuffer(...) VULKAN_API_CALL(vkCreateFramebuffer, __VA_ARGS__)
+#define vkCreateGraphicsPipelines(...) VULKAN_API_CALL(vkCreateGraphicsPipelines, __VA_ARGS__)
+#define vkCreateImage(...) VULKAN_API_CALL(vkCreateImage, __VA_ARGS__)
+#define vkCreateImageView(...) VULKAN_API_CALL(vkCreateImageView, __VA_ARGS__)
+#define vkCreateInstance(...) VULKAN_API_CALL(vkCreateInstance, __VA_ARGS__)
+#define vkCreatePipelineCache(...) VULKAN_API_CALL(vkCreatePipelineCache, __VA_ARGS__)
+#define vkCreatePipelineLayout(...) VULKAN_API_CALL(vkCreatePipelineLayout, __VA_ARGS__)
+#define vkCreateQueryPool(...) VULKAN_API_CALL(vkCreateQueryPool, __VA_ARGS__)
+#define vkCreateRenderPass(...) VULKAN_API_CALL(vkCreateRenderPass, __VA_ARGS__)
+#define vkCreateSampler(...) VULKAN_API_CALL(vkCreateSampler, __VA_ARGS__)
+#define vkCreateSemaphore(...) VULKAN_API_CALL(vkCreateSemaphore, __VA_ARGS__)
+#define vkCreateShaderModule(...) VULKAN_API_CALL(vkCreateShaderModule, __VA_ARGS__)
+#define vkCreateSwapchainKHR(...) VULKAN_API_CALL(vkCreateSwapchainKHR, __VA_ARGS__)
+#define vkDestroyBuffer(...) VULKAN_API_CALL(vkDestroyBuffer, __VA_ARGS__)
+#define vkDestroyCommandPool(...) VULKAN_API_CALL(vkDestroyCommandPool, __VA_ARGS__)
+#define vkDestroyDescriptorPool(...) VULKAN_API_CALL(vkDestroyDescriptorPool, __VA_ARGS__)
+#define vkDestroyDescriptorSetLayout(...) VULKAN_API_CALL(vkDestroyDescriptorSetLayout, __VA_ARGS__)
+#define vkDestroyDescriptorUpdateTemplate(...) VULKAN_API_CALL(vkDestroyDescriptorUpdateTemplate, __VA_ARGS__)
+#define vkDestroyDevice(...) VULKAN_API_CALL(vkDestroyDevice, __VA_ARGS__)
+#define vkDestroyFramebuffer(...) VULKAN_API_CALL(vkDestroyFramebuffer, __VA_ARGS__)
+#define vkDestroyImage(...) VULKAN_API_CALL(vkDestroyImage, __VA_ARGS__)
+#define vkDestroyImageView(...) VULKAN_API_CALL(vkDestroyImageView, __VA_ARGS__)
+#define vkDestroyInstance(...) VULKAN_API_CALL(vkDestroyInstance, __VA_ARGS__)
+#define vkDestroyPipeline(...) VULKAN_API_CALL(vkDestroyPipeline, __VA_ARGS__)
+#define vkDestroyPipelineCache(...) VULKAN_API_CALL(vkDestroyPipelineCache, __VA_ARGS__)
+#define vkDestroyPipelineLayout(...) VULKAN_API_CALL(vkDestroyPipelineLayout, __VA_ARGS__)
+#define vkDestroyQueryPool(...) VULKAN_API_CALL(vkDestroyQueryPool, __VA_ARGS__)
+#define vkDestroyRenderPass(...) VULKAN_API_CALL(vkDestroyRenderPass, __VA_ARGS__)
+#define vkDestroySampler(...) VULKAN_API_CALL(vkDestroySampler, __VA_ARGS__)
+#define vkDestroySemaphore(...) VULKAN_API_CALL(vkDestroySemaphore, __VA_ARGS__)
+#define vkDestroyShaderModule(...) VULKAN_API_CALL(vkDestroyShaderModule, __VA_ARGS__)
+#define vkDestroySurfaceKHR(...) VULKAN_API_CALL(vkDestroySurfaceKHR, __VA_ARGS__)
+#define vkDestroySwapchainKHR(...) VULKAN_API_CALL(vkDestroySwapchainKHR, __VA_ARGS__)
+#define vkDeviceWaitIdle(...) VULKAN_API_CALL(vkDeviceWaitIdle, __VA_ARGS__)
+#define vkEndCommandBuffer(...) VULKAN_API_CALL(vkEndCommandBuffer, __VA_ARGS__)
+#define vkEnumerateDeviceExtensionProperties(...) VULKAN_API_CALL(vkEnumerateDeviceExtensionProperties, __VA_ARGS__)
+#define vkEnumerateInstanceExtensionProperties(...) VULKAN_API_CALL(vkEnumerateInstanceExtensionProperties, __VA_ARGS__)
+#define vkEnumerateInstanceLayerProperties(...) VULKAN_API_CALL(vkEnumerateInstanceLayerProperties, __VA_ARGS__)
+#define vkEnumeratePhysicalDevices(...) VULKAN_API_CALL(vkEnumeratePhysicalDevices, __VA_ARGS__)
+#define vkFreeCommandBuffers(...) VULKAN_API_CALL(vkFreeCommandBuffers, __VA_ARGS__)
+#define vkFreeMemory(...) VULKAN_API_CALL(vkFreeMemory, __VA_ARGS__)
+#define vkGetBufferMemoryRequirements(...) VULKAN_API_CALL(vkGetBufferMemoryRequirements, __VA_ARGS__)
+#define vkGetDeviceProcAddr(...) VULKAN_API_CALL(vkGetDeviceProcAddr, __VA_ARGS__)
+#define vkGetDeviceQueue(...) VULKAN_API_CALL(vkGetDeviceQueue, __VA_ARGS__)
+#define vkGetImageMemoryRequirements(...) VULKAN_API_CALL(vkGetImageMemoryRequirements, __VA_ARGS__)
+#define vkGetInstanceProcAddr(...) VULKAN_API_CALL(vkGetInstanceProcAddr, __VA_ARGS__)
+#define vkGetPhysicalDeviceFeatures(...) VULKAN_API_CALL(vkGetPhysicalDeviceFeatures, __VA_ARGS__)
+#define vkGetPhysicalDeviceFeatures2(...) VULKAN_API_CALL(vkGetPhysicalDeviceFeatures2, __VA_ARGS__)
+#define vkGetPhysicalDeviceFormatProperties(...) VULKAN_API_CALL(vkGetPhysicalDeviceFormatProperties, __VA_ARGS__)
+#define vkGetPhysicalDeviceMemoryProperties(...) VULKAN_API_CALL(vkGetPhysicalDeviceMemoryProperties, __VA_ARGS__)
+#define vkGetPhysicalDeviceProperties(...) VULKAN_API_CALL(vkGetPhysicalDeviceProperties, __VA_ARGS__)
+#define vkGetPhysicalDeviceProperties2(...) VULKAN_API_CALL(vkGetPhysicalDeviceProperties2, __VA_ARGS__)
+#define vkGetPhysicalDeviceQueueFamilyProperties(...) VULKAN_API_CALL(vkGetPhysicalDeviceQueueFamilyProperties, __VA_ARGS__)
+#define vkGetPhysicalDeviceSurfaceCapabilitiesKHR(...) VULKAN_API_CALL(vkGetPhysicalDeviceSurfaceCapabilitiesKHR, __VA_ARGS__)
+#define vkGetPhysicalDeviceSurfaceFormatsKHR(...) VULKAN_API_CALL(vkGetPhysicalDeviceSurfaceFormatsKHR, __VA_ARGS__)
+#define vkGetPhysicalDeviceSurfacePresentModesKHR(...) VULKAN_API_CALL(vkGetPhysicalDeviceSurfacePresentModesKHR, __VA_ARGS__)
+#define vkGetPhysicalDeviceSurfaceSupportKHR(...) VULKAN_API_CALL(vkGetPhysicalDeviceSurfaceSupportKHR, __VA_ARGS__)
+#define vkGetPipelineCacheData(...) VULKAN_API_CALL(vkGetPipelineCacheData, __VA_ARGS__)
+#define vkGetQueryPoolResults(...) VULKAN_API_CALL(vkGetQueryPoolResults, __VA_ARGS__)
+#define vkGetSwapchainImagesKHR(...) VULKAN_API_CALL(vkGetSwapchainImagesKHR, __VA_ARGS__)
+#define vkMapMemory(...) VULKAN_API_CALL(vkMapMemory, __VA_ARGS__)
+#define vkQueuePresentKHR(...) VULKAN_API_CALL(vkQueuePresentKHR, __VA_ARGS__)
+#define vkQueueSubmit(...) VULKAN_API_CALL(vkQueueSubmit, __VA_ARGS__)
+#define vkResetCommandPool(...) VULKAN_API_CALL(vkResetCommandPool, __VA_ARGS__)
+#define vkResetDescriptorPool(...) VULKAN_API_CALL(vkResetDescriptorPool, __VA_ARGS__)
+#define vkUnmapMemory(...) VULKAN_API_CALL(vkUnmapMemory, __VA_ARGS__)
+#define vkUpdateDescriptorSetWithTemplate(...) VULKAN_API_CALL(vkUpdateDescriptorSetWithTemplate, __VA_ARGS__)
+#define vkUpdateDescriptorSets(...) VULKAN_API_CALL(vkUpdateDescriptorSets, __VA_ARGS__)
+#endif
+
+#endif // VULKANAPISTATS_H
\ No newline at end of file
@@ -0,0 +1,118 @@
+#ifndef VULKANBARRIERBATCH_H
+#define VULKANBARRIERBATCH_H
+
+#include "VulkanHelper.h"
+
+#include <vector>
+
+// What the next commands do with a buffer or an image. Each usage maps to the pipeline stages,
+// access mask and image layout it needs so barriers are never written by hand.
+enum class VulkanResourceUsage
+{
+    // Contents can be discarded
+    Undefined,
+    TransferSrc,
+    TransferDst,
+    VertexBuffer,
+    IndexBuffer,
+    IndirectBuffer,
+    UniformBuffer,
+    // Sampled or storage reads from the vertex or fragment shader
+    GraphicsShaderRead,
+    FragmentShaderRead,
+    ComputeShaderRead,
+    ComputeShaderWrite,
+    ColorAttachment,
+    DepthStencilAttachment,
+    // Depth test without writes, or sampled depth
+    DepthStencilRead,
+    HostRead,
+    HostWrite,
+    Present,
+    // Anything - only for debugging
+    General
+};
+
+// Stages, access and layout of a usage
+struct VulkanResourceAccess
+{
+    VkPipelineStageFlags stages;
+    VkAccessFlags access;
+    VkImageLayout layout;
+};
+
+// Synchronization state of a buffer or of one image subresource, as left by the commands recorded so far
+struct VulkanResourceState
+{
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    // VK_QUEUE_FAMILY_IGNORED - no ownership is tracked
+    uint32_t queueFamily = VK_QUEUE_FAMILY_IGNORED;
+    // Last write - a layout transition counts as a write without access
+    VkPipelineStageFlags writeStages = 0;
+    VkAccessFlags writeAccess = 0;
+    // Reads since the last write, they already see its result
+    VkPipelineStageFlags readStages = 0;
+    VkAccessFlags readAccess = 0;
+};
+
+const VulkanResourceAccess &resourceAccess(VulkanResourceUsage usage);
+// A resource uploaded by VulkanUploadManager - its data is visible to every later command
+VulkanResourceState uploadedResourceState(VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+// Collects the barriers needed by the next commands and records them in a single
+// vkCmdPipelineBarrier. Read after read in the same layout needs no barrier, and the
+// transitions of adjacent mip levels and array layers of an image are merged into one.
+class VulkanBarrierBatch
+{
+
+public:
+
+    VulkanBarrierBatch() = default;
+    ~VulkanBarrierBatch() = default;
+
+    // Move the state to the usage and queue the barrier it needs. A queueFamily different from
+    // the owner of the state transfers the ownership - record the barrier on both queues.
+    // Return true if a barrier was queued.
+    bool image(VkImage image,
+        const VkImageSubresourceRange &range,
+        VulkanResourceState &state,
+        VulkanResourceUsage usage,
+        uint32_t queueFamily = VK_QUEUE_FAMILY_IGNORED);
+    bool buffer(VkBuffer buffer,
+        VkDeviceSize offset,
+        VkDeviceSize size,
+        VulkanResourceState &state,
+        VulkanResourceUsage usage,
+        uint32_t queueFamily = VK_QUEUE_FAMILY_IGNORED);
+
+    // Record the queued barriers and clear the batch
+    void flush(VkCommandBuffer commandBuffer);
+
+    const inline bool empty() const { return m_imageBarriers.empty() && m_bufferBarriers.empty(); }
+
+private:
+
+    // Source and destination of a barrier
+    struct Dependency
+    {
+        VkPipelineStageFlags srcStages;
+        VkPipelineStageFlags dstStages;
+        VkAccessFlags srcAccess;
+        VkAccessFlags dstAccess;
+        VkImageLayout oldLayout;
+        VkImageLayout newLayout;
+        uint32_t srcQueueFamily;
+        uint32_t dstQueueFamily;
+    };
+
+    VkPipelineStageFlags m_srcStages = 0;
+    VkPipelineStageFlags m_dstStages = 0;
+    std::vector<VkImageMemoryBarrier> m_imageBarriers;
+    std::vector<VkBufferMemoryBarrier> m_bufferBarriers;
+
+    static bool resolve(VulkanResourceState &state, VulkanResourceUsage usage, uint32_t queueFamily, bool isImage, Dependency &dependency);
+    static bool merge(VkImageMemoryBarrier &barrier, const VkImageMemoryBarrier &next);
+
+};
+
+#endif // VULKANBARRIERBATCH_H
\ No newline at end of file
@@ -0,0 +1,123 @@
+#ifndef VULKANBINDLESSHEAP_H
+#define VULKANBINDLESSHEAP_H
+
+#include "VulkanHelper.h"
+#include "VulkanPhysicalDevice.h"
+#include "VulkanLayoutCache.h"
+#include "VulkanTimeline.h"
+
+#include <mutex>
+#include <vector>
+
+// Kinds of descriptors in the heap - also the binding of their array in the heap set
+enum class VulkanBindlessType : uint32_t
+{
+    SampledImage = 0,
+    StorageBuffer = 1,
+    Sampler = 2,
+    Count = 3
+};
+
+// One update-after-bind descriptor set (VK_EXT_descriptor_indexing) holding large arrays of
+// sampled images, storage buffers and samplers. Resources are registered once and keep their
+// index for their whole life, shaders read them by index:
+//
+//     layout(set = 0, binding = 0) uniform texture2D bindlessTextures[];
+//     layout(set = 0, binding = 1) buffer BindlessBuffer { uint data[]; } bindlessBuffers[];
+//     layout(set = 0, binding = 2) uniform sampler bindlessSamplers[];
+//
+// Pipelines created with pipelineLayout() get the indices of a draw through push constants, so
+// draws never bind descriptor sets and can be merged. The engine binds the set at the start of
+// every command buffer - a renderable that binds another layout at set 0 has to bind() it again.
+class VulkanBindlessHeap
+{
+
+public:
+
+    static const uint32_t InvalidIndex = 0xFFFFFFFF;
+    // Guaranteed by every device
+    static const uint32_t PushConstantSize = 128;
+    // Linear filtering, repeat addressing - registered by init
+    static const uint32_t DefaultSamplerIndex = 0;
+
+    VulkanBindlessHeap() = default;
+    ~VulkanBindlessHeap() = default;
+
+    VulkanBindlessHeap(const VulkanBindlessHeap &other) = delete;
+    void operator=(const VulkanBindlessHeap &other) = delete;
+
+    // The capacities are clamped to the device limits. Released indices are reused once the
+    // graphics timeline is past the last submit that could read them.
+    bool init(VkDevice device,
+        const VulkanPhysicalDevice &physicalDevice,
+        VulkanLayoutCache &layoutCache,
+        VulkanTimeline &graphicsTimeline,
+        uint32_t maxSampledImages = 16384,
+        uint32_t maxStorageBuffers = 16384,
+        uint32_t maxSamplers = 64);
+    void cleanup(VkDevice device);
+
+    // Safe to call from multiple threads. Return InvalidIndex when the array is full.
+    uint32_t registerImage(VkImageView imageView, VkImageLayout imageLayout);
+    uint32_t registerBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+    uint32_t registerSampler(VkSampler sampler);
+    // The descriptor stays valid for the submits already made
+    void release(VulkanBindlessType type, uint32_t index);
+
+    // Recycle the indices the GPU is done with - once per frame
+    void collectGarbage();
+
+    void bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS) const;
+
+    // Set layout is owned by the heap, pipeline layout by the layout cache
+    const inline VkDescriptorSetLayout setLayout() const { return m_setLayout; }
+    const inline VkPipelineLayout pipelineLayout() const { return m_pipelineLayout; }
+    const inline VkDescriptorSet descriptorSet() const { return m_descriptorSet; }
+    const inline uint32_t capacity(VulkanBindlessType type) const { return m_slots[static_cast<uint32_t>(type)].capacity; }
+
+    void printStatistics() const;
+
+private:
+
+    // Indices of one array
+    struct Slots
+    {
+        uint32_t capacity = 0;
+        // Never used above this
+        uint32_t nextIndex = 0;
+        std::vector<uint32_t> freeIndices;
+        uint32_t liveCount = 0;
+        uint32_t peakCount = 0;
+    };
+
+    // Released index waiting for the graphics queue
+    struct RetiredIndex
+    {
+        VulkanBindlessType type;
+        uint32_t index;
+        uint64_t retireValue;
+    };
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VulkanTimeline *m_graphicsTimeline = nullptr;
+
+    VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+    VkSampler m_defaultSampler = VK_NULL_HANDLE;
+
+    Slots m_slots[static_cast<uint32_t>(VulkanBindlessType::Count)];
+    std::vector<RetiredIndex> m_retiredIndices;
+
+    mutable std::mutex m_mutex;
+
+    uint32_t acquireIndex(VulkanBindlessType type);
+    void writeDescriptor(VulkanBindlessType type, uint32_t index, const VkDescriptorImageInfo *imageInfo, const VkDescriptorBufferInfo *bufferInfo);
+    bool createSetLayout(VkDevice device);
+    bool createDescriptorSet(VkDevice device);
+    bool createDefaultSampler(VkDevice device);
+
+};
+
+#endif // VULKANBINDLESSHEAP_H
\ No newline at end of file
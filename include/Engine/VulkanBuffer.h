@@ -3,7 +3,10 @@
 
 #include "VulkanHelper.h"
 #include <VulkanPhysicalDevice.h>
-#include <VulkanQueue.h>
+#include <VulkanMemoryAllocator.h>
+#include <VulkanUploadManager.h>
+#include <VulkanBindlessHeap.h>
+#include <VulkanBarrierBatch.h>
 
 class VulkanBuffer
 {
@@ -15,55 +18,65 @@ public:
 
     bool init(const VulkanPhysicalDevice &physicalDevice, 
         VkDevice logicalDevice,
+        VulkanMemoryAllocator &allocator,
         size_t elementSize,
         size_t elementCount,
         VkBufferUsageFlags bufferUsage, 
         void *data,
-        const VulkanQueue &queue);
+        VulkanUploadManager &uploadManager);
     bool updateUniformData(VkDevice device, uint32_t currentImage, void *data, size_t dataSize);
     void cleanup(VkDevice device);
+    // Makes the buffer readable by index from the shaders. Needs VK_BUFFER_USAGE_STORAGE_BUFFER_BIT.
+    bool registerBindless(VulkanBindlessHeap &bindlessHeap);
+    // Queue the barrier needed before the next commands use the whole buffer this way, if any
+    void transition(VulkanBarrierBatch &barriers, VulkanResourceUsage usage, uint32_t queueFamily = VK_QUEUE_FAMILY_IGNORED);
 
     const inline VkBuffer get() const { return m_buffers[0]; }
     const inline uint32_t elementSize() const { return m_elementSize; }
     const inline uint32_t elementCount() const { return m_elementCount; }
+    const inline VkDeviceSize elementOffset(uint32_t elementIndex) const { return m_elementStride * elementIndex; }
+    // Batch that uploads the initial data of a device local buffer
+    const inline VulkanUploadToken uploadToken() const { return m_uploadToken; }
+    // VulkanBindlessHeap::InvalidIndex until registered
+    const inline uint32_t bindlessIndex() const { return m_bindlessIndex; }
 
 private:
 
     std::vector<VkBuffer> m_buffers;
-    std::vector<VkDeviceMemory> m_memoryBuffers;
+    std::vector<VulkanMemoryAllocation> m_memoryBuffers;
 
-    VkBuffer m_stagingBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory m_stagingBufferMem = VK_NULL_HANDLE;
+    VulkanMemoryAllocator *m_allocator = nullptr;
 
     uint32_t m_elementSize = 0;
     uint32_t m_elementCount = 0;
+    VkDeviceSize m_elementStride = 0;
     VkDeviceSize m_bufferSize = 0;
+    VulkanUploadToken m_uploadToken = 0;
+    // Synchronization state left by the commands recorded so far
+    VulkanResourceState m_state = {};
 
-    int findMemoryInfo(VkPhysicalDevice physicalDevice, uint32_t memoryType, VkMemoryPropertyFlags properties);
-    bool createBuffer(VkPhysicalDevice physicalDevice, 
-        VkDevice logicalDevice, 
+    VulkanBindlessHeap *m_bindlessHeap = nullptr;
+    uint32_t m_bindlessIndex = VulkanBindlessHeap::InvalidIndex;
+
+    bool createBuffer(VkDevice logicalDevice, 
         size_t bufferSize, 
         VkBufferUsageFlags bufferUsage, 
         VkMemoryPropertyFlags memoryPropertyFlags,
         VkBuffer &buffer,
-        VkDeviceMemory &memory);
+        VulkanMemoryAllocation &memory);
     bool createVertexBuffer(const VulkanPhysicalDevice &physicalDevice, 
         VkDevice logicalDevice,
         size_t elementSize,
         size_t elementCount,
         VkBufferUsageFlags bufferUsage, 
         void *data,
-        const VulkanQueue &queue);
+        VulkanUploadManager &uploadManager);
     bool createUniformBuffer(const VulkanPhysicalDevice &physicalDevice, 
         VkDevice logicalDevice,
         size_t elementSize,
         size_t elementCount,
         VkBufferUsageFlags bufferUsage, 
-        void *data,
-        const VulkanQueue &queue);
-    bool setStagingBufferData(VkDevice device, size_t bufferSize, void *data);
-    void cleanupStagingBuffer(VkDevice device);
-    bool copyBuffer(VkDevice device, int transferQueueFamilyIndex, VkDeviceSize size, VkBuffer srcBuffer, VkBuffer dstBuffer, const VulkanQueue &queue);
+        void *data);
 
 };
 
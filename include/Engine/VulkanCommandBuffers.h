@@ -14,8 +14,11 @@ public:
     VulkanCommandBuffers() {}
     ~VulkanCommandBuffers() {}
 
-    bool init(VkDevice device, VkCommandPool commandPool, uint32_t bufferCount);
-    bool beginCommandBuffer(uint32_t commandBufferIndex, VkCommandBufferUsageFlags flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+    bool init(VkDevice device, VkCommandPool commandPool, uint32_t bufferCount, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+    // Secondary command buffers need the inheritance info
+    bool beginCommandBuffer(uint32_t commandBufferIndex, 
+        VkCommandBufferUsageFlags flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
+        const VkCommandBufferInheritanceInfo *inheritanceInfo = nullptr);
     bool endCommandBuffer(uint32_t commandBufferIndex);
 
     const inline std::vector<VkCommandBuffer> &get() const { return m_commandBuffers; }
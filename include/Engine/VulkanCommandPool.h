@@ -14,6 +14,8 @@ public:
     const inline VkCommandPool get() const { return m_commandPool; }
 
     bool init(VkDevice device, int graphicsQueueFamilyIndex, VkCommandPoolCreateFlags flags = 0);
+    // Returns every command buffer allocated from the pool to the initial state
+    bool reset(VkDevice device, VkCommandPoolResetFlags flags = 0);
     void cleanup(VkDevice device);
 
 private:
@@ -0,0 +1,80 @@
+#ifndef VULKANDESCRIPTORALLOCATOR_H
+#define VULKANDESCRIPTORALLOCATOR_H
+
+#include "VulkanHelper.h"
+#include "VulkanLayoutCache.h"
+
+#include <mutex>
+#include <vector>
+
+// How long a descriptor set lives
+enum class VulkanDescriptorLifetime
+{
+    // Until the allocator is cleaned up
+    Persistent,
+    // Until the frame in flight it was allocated in comes around again
+    Frame
+};
+
+// Descriptor sets for any layout, allocated from chained pools. A new pool is added
+// when the current one runs out, so objects never need a pool of their own.
+// Persistent sets and per frame sets come from separate arenas - the pools of a
+// frame are reset as a whole in beginFrame and reused.
+class VulkanDescriptorAllocator
+{
+
+public:
+
+    static const uint32_t DefaultSetsPerPool = 256;
+    static const uint32_t MaxSetsPerPool = 4096;
+
+    VulkanDescriptorAllocator() = default;
+    ~VulkanDescriptorAllocator() = default;
+
+    VulkanDescriptorAllocator(const VulkanDescriptorAllocator &other) = delete;
+    void operator=(const VulkanDescriptorAllocator &other) = delete;
+
+    bool init(VkDevice device, VulkanLayoutCache &layoutCache, uint32_t framesInFlight, uint32_t setsPerPool = DefaultSetsPerPool);
+    void cleanup(VkDevice device);
+
+    // Reset the frame arena. The GPU must be done with the frame.
+    void beginFrame(uint32_t frameIndex);
+
+    // Safe to call from multiple threads
+    bool allocate(VkDescriptorSetLayout setLayout, VkDescriptorSet &descriptorSet, VulkanDescriptorLifetime lifetime = VulkanDescriptorLifetime::Persistent);
+    // Writes all the descriptors of the set with its layout update template - see VulkanLayoutCache::getUpdateTemplate
+    bool write(VkDescriptorSet descriptorSet, VkDescriptorSetLayout setLayout, const std::vector<VulkanDescriptorInfo> &descriptors);
+
+    void printStatistics() const;
+
+private:
+
+    // Pools used by an arena, the last one is the one allocated from
+    struct Arena
+    {
+        std::vector<VkDescriptorPool> pools;
+    };
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VulkanLayoutCache *m_layoutCache = nullptr;
+
+    Arena m_persistentArena;
+    std::vector<Arena> m_frameArenas;
+    uint32_t m_currentFrame = 0;
+    // Reset pools waiting to be reused by any arena
+    std::vector<VkDescriptorPool> m_freePools;
+    // Pools grow up to MaxSetsPerPool
+    uint32_t m_nextPoolSetCount = DefaultSetsPerPool;
+
+    uint32_t m_poolCount = 0;
+    uint64_t m_allocatedSetCount = 0;
+    uint64_t m_writtenSetCount = 0;
+
+    mutable std::mutex m_mutex;
+
+    VkDescriptorPool acquirePool();
+    VkDescriptorPool createPool(uint32_t setCount);
+
+};
+
+#endif // VULKANDESCRIPTORALLOCATOR_H
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "VulkanHelper.h"
 #include "VulkanDescriptorPool.h"
 
+#include <list>
 #include <vector>
 
 class VulkanDescriptorSets
@@ -15,15 +16,23 @@ public:
     ~VulkanDescriptorSets() = default;
 
     bool init(VkDevice device, const VulkanDescriptorPool &descriptorPool, std::vector<VkDescriptorSetLayout> descriptorLayouts);
-    void setBuffer(VkDevice device, uint32_t descriptorSetIndex, uint32_t binding, uint32_t elementIndex, uint32_t descriptorCount);
+    void setBuffer(uint32_t descriptorSetIndex, 
+        uint32_t binding, 
+        uint32_t elementIndex, 
+        VkDescriptorType descriptorType, 
+        const std::vector<VkDescriptorBufferInfo> &bufferInfos);
     void updateDescriptorSets(VkDevice device);
 
+    const inline VkDescriptorSet get(uint32_t descriptorSetIndex) const { return m_descriptorSets[descriptorSetIndex]; }
+
 private:
 
     std::vector<VkDescriptorSet> m_descriptorSets;
 
     std::vector<VkWriteDescriptorSet> m_writeSets;
     std::vector<VkCopyDescriptorSet> m_copySets;
+    // Keeps the pending buffer infos alive until the writes are applied
+    std::list<std::vector<VkDescriptorBufferInfo>> m_bufferInfos;
 
 };
 
@@ -17,7 +17,6 @@ public:
     ~VulkanDisplay() {}
 
     bool createSurface(VkInstance instance, GLFWwindow *window);
-    bool createFramebuffers(VkDevice device, VkRenderPass renderPass);
     void cleanup(VkDevice device, VkInstance instance);
     bool initSwapchain(const VulkanPhysicalDevice &physicalDevice, 
         const VulkanLogicalDevice &logicalDevice,
@@ -29,7 +28,11 @@ public:
     inline const VkSurfaceFormatKHR surfaceFormat() const { return m_surfaceFormat; }
     inline const VkPresentModeKHR presentMode() const { return m_presentMode; }
     inline const VkExtent2D surfaceExtent() const { return m_surfaceExtent; }
-    inline const VkFramebuffer framebuffer(uint32_t framebufferIndex) const { return m_framebuffers[framebufferIndex]; }
+    // Framebuffers are created by the render graph
+    inline const VkImage image(uint32_t imageIndex) const { return m_swapChainImages[imageIndex]; }
+    inline const VkImageView imageView(uint32_t imageIndex) const { return m_swapChainImageViews[imageIndex]; }
+    // The swap chain images can be copied out (frame capture)
+    inline const bool supportsTransferSrc() const { return (m_imageUsage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0; }
 
 private:
 
@@ -43,10 +46,10 @@ private:
     VkSurfaceFormatKHR m_surfaceFormat;
     VkPresentModeKHR m_presentMode;
     VkExtent2D m_surfaceExtent;
+    VkImageUsageFlags m_imageUsage = 0;
     VkSwapchainKHR m_swapChain = VK_NULL_HANDLE;
     std::vector<VkImage> m_swapChainImages;
     std::vector<VkImageView> m_swapChainImageViews;
-    std::vector<VkFramebuffer> m_framebuffers;
 
     bool querySwapchainSupport(VkPhysicalDevice physicalDevice);
     VkSurfaceFormatKHR chooseSwapchainFormat();
@@ -2,6 +2,7 @@
 #define VULKANENGINE_H
 
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 #include <vulkan/vulkan.h>
 
@@ -13,13 +14,38 @@
 #include "VulkanGraphicsPipeline.h"
 #include "VulkanShader.h"
 #include "VulkanRenderPass.h"
+#include "VulkanRenderGraph.h"
 #include "VulkanCommandPool.h"
 #include "VulkanCommandBuffers.h"
 #include "VulkanBuffer.h"
 #include "VulkanImage.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanUniformRing.h"
+#include "VulkanUploadManager.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanPipelineRegistry.h"
+#include "VulkanLayoutCache.h"
+#include "VulkanDescriptorAllocator.h"
+#include "VulkanBindlessHeap.h"
+#include "VulkanFrameCapture.h"
+#include "VulkanGpuProfiler.h"
+#include "CpuProfiler.h"
 #include "Window.h"
+#include "JobPool.h"
 #include "VulkanRenderableObject.h"
 
+// CPU time of the steps of the last frame, in milliseconds
+struct VulkanFrameTimings
+{
+    // Waiting for the GPU to be done with the frame in flight
+    double waitMilliseconds = 0.0;
+    double acquireMilliseconds = 0.0;
+    // Sorting and recording of every command buffer
+    double recordMilliseconds = 0.0;
+    double submitMilliseconds = 0.0;
+    double presentMilliseconds = 0.0;
+};
+
 class VulkanEngine
 {
 public:
@@ -36,26 +62,64 @@ public:
     void operator=(const VulkanEngine &other) = delete;
 
     bool initVulkan(const Window &window, const std::string &appName, unsigned int appMajorVersion, unsigned int appMinorVersion);
+    // No window or swap chain - every frame is rendered into an engine owned offscreen image
+    bool initVulkanHeadless(uint32_t width, uint32_t height, const std::string &appName, unsigned int appMajorVersion, unsigned int appMinorVersion);
+    // Write every frameInterval-th frame to outputPrefix + frame number. Must be called before init.
+    void enableFrameCapture(const std::string &outputPrefix, VulkanImageFileFormat fileFormat, uint32_t frameInterval = 1);
+    // Record the CPU zones and the GPU scopes from init to cleanup and write them as a Chrome trace. Must be called before init.
+    void enableTrace(const std::string &filename);
+    // Count the Vulkan calls of every frame, logFrames prints one line per frame. Must be called before init.
+    void enableApiStats(bool logFrames);
+    // Room for the uniform data written in one frame. Must be called before init.
+    void setUniformRingFrameSize(VkDeviceSize frameSize);
+    // GPU time of every renderable - two timestamps per draw. Must be called before the renderables are added.
+    void enableRenderableProfiling(bool profileRenderables);
     void mainLoop();
     void printVersion() const { std::cout << "Engine version " << m_engineVersionMajor << "." << m_engineVersionMinor << ".\n"; }
     void cleanup();
-    bool setupCommandBuffers();
-    const inline void addRenderable(const VulkanRenderableObject &object) { m_renderableList.push_back(&object); }
+    void addRenderable(const VulkanRenderableObject &object);
 
     const inline VkDevice device() const { return m_logicalDevice.get(); }
     const inline VulkanPhysicalDevice &physicalDevice() const { return m_physicalDevice; }
     const inline VulkanDisplay &display() const { return m_display; }
-    const inline VulkanRenderPass &renderPass() const { return m_renderPass; }
-    const inline VulkanQueue &graphicsQueue() const { return m_graphicsQueue; }
+    // Render pass of the main pass - the renderables record into it
+    const inline VulkanRenderPass &renderPass() const { return m_renderGraph.renderPass(m_mainPass); }
+    // Queue timelines tell which submissions are done
+    inline VulkanQueue &graphicsQueue() { return m_graphicsQueue; }
+    inline VulkanQueue &transferQueue() { return m_physicalDevice.hasDedicatedTransferQueue() ? m_transferQueue : m_graphicsQueue; }
+    inline VulkanMemoryAllocator &memoryAllocator() { return m_memoryAllocator; }
+    inline VulkanUniformRing &uniformRing() { return m_uniformRing; }
+    inline VulkanUploadManager &uploadManager() { return m_uploadManager; }
+    inline VulkanPipelineCache &pipelineCache() { return m_pipelineCache; }
+    // Pipelines shared by the renderables with the same state
+    inline VulkanPipelineRegistry &pipelineRegistry() { return m_pipelineRegistry; }
+    // Descriptor set and pipeline layouts built from the shader reflection
+    inline VulkanLayoutCache &layoutCache() { return m_layoutCache; }
+    // Descriptor sets for every renderable - persistent or reset every frame
+    inline VulkanDescriptorAllocator &descriptorAllocator() { return m_descriptorAllocator; }
+    // Resources indexed from the shaders - only usable if bindlessEnabled()
+    inline VulkanBindlessHeap &bindlessHeap() { return m_bindlessHeap; }
+    const inline bool bindlessEnabled() const { return m_bindlessEnabled; }
     const inline uint32_t framesInFlight() const { return m_maxFramesInFlight; }
     const inline uint32_t frameIndex() const { return m_currentFrameIndex; }
+    const inline bool headless() const { return m_headless; }
+    // GPU time of the frame, of every render graph pass and of every renderable
+    inline VulkanGpuProfiler &gpuProfiler() { return m_gpuProfiler; }
+    const inline uint32_t gpuFrameScope() const { return m_frameScope; }
+    const inline VulkanFrameTimings &frameTimings() const { return m_frameTimings; }
 
 private:
 
     VulkanEngine() {}
 
-    void beginRenderPass(VkCommandBuffer currentCommandBuffer, VkFramebuffer currentFramebuffer);
-    void endRenderPass(VkCommandBuffer currentCommandbuffer);
+    bool initDevices();
+    bool initFrames();
+    bool createOffscreenTargets(uint32_t width, uint32_t height);
+    bool buildRenderGraph();
+    void sortRenderables();
+    bool recordCommandBuffer(uint32_t imageIndex);
+    void recordMainPass(const VulkanRenderGraphContext &context);
+    bool recordSecondaryCommandBuffers(uint32_t jobCount, const VulkanRenderGraphContext &context);
 
     void beginRender();
     void endRender();
@@ -67,22 +131,114 @@ private:
     uint32_t m_currentFrameIndex = 0;
     uint32_t m_availableImageIndex = 0;
 
+    // Uniform data that can be written by all the renderables in one frame
+    VkDeviceSize m_uniformRingFrameSize = 1024 * 1024;
+
+    // Renderables are recorded on the job pool once every recording job gets at least this many
+    uint32_t m_minRenderablesPerJob = 256;
+    uint32_t m_maxRecordingThreads = 8;
+
+    // New pipeline states requested mid-run are compiled on these threads
+    uint32_t m_pipelineCompileThreads = 2;
+
+    // Draw the opaque renderables front to back - the early depth test skips the hidden fragments
+    bool m_sortRenderables = true;
+
+    // Bindless heap - only created if the device supports descriptor indexing
+    bool m_useBindless = true;
+    bool m_bindlessEnabled = false;
+
+    // Written on shutdown, loaded on the next run
+    std::string m_pipelineCacheFilename = "./pipelinecache.bin";
+
+    // GPU timestamps - disabled if the graphics queue can't write them
+    bool m_useGpuProfiler = true;
+    bool m_profileRenderables = true;
+    // Written on shutdown, nothing is written if empty
+    std::string m_gpuProfileFilename = "./gpuprofile.csv";
+    // Chrome trace written on shutdown - nothing is recorded if empty
+    std::string m_traceFilename;
+    // Vulkan calls counted from init to cleanup
+    bool m_apiStatsEnabled = false;
+    bool m_apiStatsLogFrames = false;
+
     VkClearValue m_clearColor = { 0.0f, 0.0f, 0.0f, 1.0f }; 
+    VkClearDepthStencilValue m_clearDepthStencil = { 1.0f, 0 };
 
     VulkanInstance m_instance;
     VulkanPhysicalDevice m_physicalDevice;
     VulkanLogicalDevice m_logicalDevice;
-    VulkanQueue m_graphicsQueue, m_presentationQueue;
+    VulkanMemoryAllocator m_memoryAllocator;
+    VulkanUniformRing m_uniformRing;
+    VulkanQueue m_graphicsQueue, m_presentationQueue, m_transferQueue;
+    VulkanUploadManager m_uploadManager;
+    VulkanPipelineCache m_pipelineCache;
+    VulkanPipelineRegistry m_pipelineRegistry;
+    VulkanLayoutCache m_layoutCache;
+    VulkanDescriptorAllocator m_descriptorAllocator;
+    VulkanBindlessHeap m_bindlessHeap;
     VulkanDisplay m_display;
-    VulkanRenderPass m_renderPass;
-    VulkanCommandPool m_commandPool;
-    VulkanCommandBuffers m_commandBuffers;
+
+    // Headless - the color targets replace the swap chain images, one per frame in flight
+    bool m_headless = false;
+    VkFormat m_offscreenFormat = VK_FORMAT_UNDEFINED;
+    VkExtent2D m_offscreenExtent = {};
+    std::vector<VulkanImage> m_offscreenTargets;
+
+    // Passes of a frame - the main pass draws the renderables into the swap chain image
+    VulkanRenderGraph m_renderGraph;
+    VulkanRenderGraphResource m_backbuffer;
+    // Transient - cleared by the main pass and never stored
+    VulkanRenderGraphResource m_depthBuffer;
+    VkFormat m_depthFormat = VK_FORMAT_UNDEFINED;
+    VulkanRenderGraphPass m_mainPass;
+    // Layout and last accesses of every swap chain image
+    std::vector<VulkanResourceState> m_swapChainImageStates;
+    // Copies the color target out after the main pass, frames are written on a background thread
+    bool m_captureEnabled = false;
+    std::string m_captureOutputPrefix;
+    VulkanImageFileFormat m_captureFileFormat = VulkanImageFileFormat::PNG;
+    uint32_t m_captureFrameInterval = 1;
+    VulkanFrameCapture m_frameCapture;
+    VulkanRenderGraphPass m_capturePass;
+    // Frames rendered since init
+    uint64_t m_frameNumber = 0;
+    VulkanFrameTimings m_frameTimings;
+    // Recording jobs used by the main pass of the current frame
+    uint32_t m_mainPassJobCount = 0;
+    bool m_mainPassFailed = false;
+
+    // Everything owned by one frame in flight. The command pool is reset as a whole
+    // once the graphics timeline reaches the value of the last submit of the frame.
+    struct FrameData
+    {
+        VulkanCommandPool commandPool;
+        VulkanCommandBuffers commandBuffers;
+        // One pool per recording job - a pool is only used by the thread that runs the job
+        std::vector<VulkanCommandPool> secondaryCommandPools;
+        std::vector<VulkanCommandBuffers> secondaryCommandBuffers;
+        // 0 - never submitted
+        uint64_t submissionValue = 0;
+    };
+    std::vector<FrameData> m_frames;
 
     // Synchronization
     VulkanSynchronizationObject m_swapChainSync;
 
     // Renderable objects
     std::vector<const VulkanRenderableObject*> m_renderableList;
+    // GPU profiler scope of every renderable
+    std::unordered_map<const VulkanRenderableObject*, uint32_t> m_renderableScopes;
+    // Recording order of the current frame
+    std::vector<const VulkanRenderableObject*> m_drawList;
+    std::vector<std::pair<float, const VulkanRenderableObject*>> m_sortKeys;
+
+    // Multithreaded command recording
+    JobPool m_jobPool;
+
+    // GPU timestamps of the frame command buffers
+    VulkanGpuProfiler m_gpuProfiler;
+    uint32_t m_frameScope = 0;
 };
 
 class RenderInstance
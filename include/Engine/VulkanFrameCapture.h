@@ -0,0 +1,125 @@
+#ifndef VULKANFRAMECAPTURE_H
+#define VULKANFRAMECAPTURE_H
+
+#include "VulkanHelper.h"
+#include "VulkanPhysicalDevice.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanTimeline.h"
+#include "VulkanBarrierBatch.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class VulkanImageFileFormat
+{
+    PNG,
+    PPM,
+    // Texels as copied from the image, no header
+    Raw
+};
+
+// Copies rendered frames into a ring of persistently mapped host buffers and writes them to
+// files on a background thread. Nothing ever blocks the frame:
+//  - the copy is recorded at the end of the frame into the next free buffer, or the frame is dropped
+//  - the graphics timeline is polled once per frame for the copies that are done
+//  - the encoder thread converts and writes the file, then gives the buffer back to the ring
+// Only 8 bit RGBA and BGRA color formats are supported.
+class VulkanFrameCapture
+{
+
+public:
+
+    static const uint32_t DefaultBufferCount = 4;
+
+    VulkanFrameCapture() = default;
+    ~VulkanFrameCapture() { stopEncoderThread(); }
+
+    VulkanFrameCapture(const VulkanFrameCapture &other) = delete;
+    void operator=(const VulkanFrameCapture &other) = delete;
+
+    // Files are named outputPrefix + frame number + extension
+    bool init(VkDevice device,
+        const VulkanPhysicalDevice &physicalDevice,
+        VulkanMemoryAllocator &allocator,
+        VulkanTimeline &graphicsTimeline,
+        VkFormat format,
+        VkExtent2D extent,
+        const std::string &outputPrefix,
+        VulkanImageFileFormat fileFormat,
+        uint32_t bufferCount = DefaultBufferCount);
+    // Waits for the copies in flight and writes the frames still queued
+    void cleanup(VkDevice device);
+
+    // Record the copy of the whole image, which must be in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL.
+    // Returns false if every buffer is busy - the frame is dropped.
+    bool record(VkCommandBuffer commandBuffer, VkImage image, uint64_t frameNumber);
+    // Graphics timeline value of the submit that contains the copies recorded since the last call
+    void submitted(uint64_t submissionValue);
+    // Hand the finished copies to the encoder thread - called once per frame
+    void poll();
+
+    void printStatistics() const;
+
+private:
+
+    enum class SlotStatus
+    {
+        Free,
+        // Recorded in a command buffer that isn't submitted yet
+        Recorded,
+        // Waiting for the GPU
+        InFlight,
+        // Owned by the encoder thread
+        Encoding
+    };
+
+    struct Slot
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VulkanMemoryAllocation memory;
+        VulkanResourceState state;
+        uint64_t frameNumber = 0;
+        uint64_t submissionValue = 0;
+        std::atomic<SlotStatus> status { SlotStatus::Free };
+    };
+
+    VulkanMemoryAllocator *m_allocator = nullptr;
+    VulkanTimeline *m_graphicsTimeline = nullptr;
+
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    VkExtent2D m_extent = {};
+    VkDeviceSize m_frameSize = 0;
+    std::string m_outputPrefix;
+    VulkanImageFileFormat m_fileFormat = VulkanImageFileFormat::PNG;
+
+    // Fixed size - the slots are shared with the encoder thread
+    std::vector<std::unique_ptr<Slot>> m_slots;
+    uint32_t m_nextSlot = 0;
+    VulkanBarrierBatch m_barriers;
+
+    // Encoder thread
+    std::thread m_encoderThread;
+    std::deque<uint32_t> m_encodeQueue;
+    std::condition_variable m_encodeCondition;
+    bool m_stopEncoding = false;
+    std::mutex m_mutex;
+
+    // Statistics
+    uint64_t m_recordedCount = 0;
+    uint64_t m_droppedCount = 0;
+    std::atomic<uint64_t> m_writtenCount { 0 };
+    std::atomic<uint64_t> m_failedCount { 0 };
+
+    void encoderThreadLoop();
+    void stopEncoderThread();
+    bool writeFile(const Slot &slot) const;
+
+};
+
+#endif // VULKANFRAMECAPTURE_H
\ No newline at end of file
@@ -0,0 +1,183 @@
+#ifndef VULKANGPUPROFILER_H
+#define VULKANGPUPROFILER_H
+
+#include "VulkanHelper.h"
+#include "VulkanPhysicalDevice.h"
+#include "VulkanQueue.h"
+#include "CpuProfiler.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Rolling GPU time of a scope, in milliseconds
+struct VulkanGpuScopeStatistics
+{
+    std::string name;
+    double minMilliseconds = 0.0;
+    double avgMilliseconds = 0.0;
+    double p99Milliseconds = 0.0;
+    double lastMilliseconds = 0.0;
+    uint32_t sampleCount = 0;
+};
+
+// Timestamp queries around named scopes of the frame command buffers. Every frame in flight has its
+// own query pool, read once the graphics timeline says the frame is done, so reading never stalls.
+// The GPU time of a scope is accumulated per frame and kept for the last historySize frames.
+class VulkanGpuProfiler
+{
+
+public:
+
+    static const uint32_t InvalidSlot = 0xFFFFFFFF;
+    static const uint32_t DefaultMaxScopesPerFrame = 4096;
+    static const uint32_t DefaultHistorySize = 256;
+    static const uint32_t DefaultMaxTraceEvents = 1 << 20;
+
+    VulkanGpuProfiler() = default;
+    ~VulkanGpuProfiler() = default;
+
+    VulkanGpuProfiler(const VulkanGpuProfiler &other) = delete;
+    void operator=(const VulkanGpuProfiler &other) = delete;
+
+    // Fails if the graphics queue can't write timestamps
+    bool init(VkDevice device,
+        const VulkanPhysicalDevice &physicalDevice,
+        uint32_t framesInFlight,
+        uint32_t maxScopesPerFrame = DefaultMaxScopesPerFrame,
+        uint32_t historySize = DefaultHistorySize);
+    void cleanup(VkDevice device);
+
+    // Id of a named scope, the same name gives the same id. Not thread safe - register the scopes up front.
+    uint32_t registerScope(const std::string &name);
+
+    // Collect the results of the last use of the frame and start recording it again.
+    // The GPU must be done with the frame.
+    void beginFrame(uint32_t frameIndex);
+    // Collect the frames that were never begun again - the GPU must be idle
+    void flush();
+    // First command of the frame - outside of any render pass
+    void resetQueries(VkCommandBuffer commandBuffer);
+
+    // Thread safe. Returns the slot to end the scope with, InvalidSlot if the frame is out of queries.
+    uint32_t beginScope(VkCommandBuffer commandBuffer, uint32_t scopeId);
+    void endScope(VkCommandBuffer commandBuffer, uint32_t slot);
+
+    // Over the frames in the history
+    bool statistics(const std::string &name, VulkanGpuScopeStatistics &scopeStatistics) const;
+    std::vector<VulkanGpuScopeStatistics> statistics() const;
+    // One line per scope
+    bool dump(const std::string &filename) const;
+    void printStatistics() const;
+
+    // Match the GPU timestamps to the CPU profiler clock with a few one off submits on the queue.
+    // The offset is the middle of the best submit to wait round trip. Needed by the trace events.
+    bool calibrate(VulkanQueue &queue, VkCommandPool commandPool);
+    // Keep every timed scope for the trace, up to maxEvents
+    void setEventRecording(bool recordEvents, uint32_t maxEvents = DefaultMaxTraceEvents);
+    // Recorded scopes on the CPU profiler clock - empty if not calibrated
+    std::vector<CpuProfilerTrackEvent> traceEvents() const;
+
+    const inline bool enabled() const { return m_enabled; }
+    // Frames whose results were read - the last time of a scope changes when this does
+    const inline uint64_t collectedFrameCount() const { return m_collectedFrameCount; }
+    const inline double lastMilliseconds(uint32_t scopeId) const { return m_scopes[scopeId].lastMilliseconds; }
+
+private:
+
+    struct FrameQueries
+    {
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        // Scope of every slot - two queries per slot
+        std::vector<uint32_t> slotScopes;
+        std::unique_ptr<std::atomic<uint32_t>> slotCount;
+        // Nothing to read before the first use
+        bool recorded = false;
+    };
+
+    // Raw timestamps of one scope of one frame
+    struct Event
+    {
+        uint32_t scopeId;
+        uint64_t beginTicks;
+        uint64_t endTicks;
+    };
+
+    struct ScopeHistory
+    {
+        std::string name;
+        // Ring of the last frame times
+        std::vector<float> samples;
+        uint32_t head = 0;
+        uint32_t sampleCount = 0;
+        double lastMilliseconds = 0.0;
+    };
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    bool m_enabled = false;
+    // Nanoseconds per tick
+    double m_timestampPeriod = 1.0;
+    uint64_t m_timestampMask = ~0ull;
+    uint32_t m_maxScopesPerFrame = 0;
+    uint32_t m_historySize = 0;
+
+    std::vector<FrameQueries> m_frames;
+    uint32_t m_currentFrame = 0;
+
+    std::vector<ScopeHistory> m_scopes;
+    // Per frame accumulation, indexed by scope
+    std::vector<double> m_frameMilliseconds;
+    std::vector<bool> m_frameTouched;
+    std::vector<uint64_t> m_queryResults;
+
+    uint64_t m_droppedScopeCount = 0;
+    uint64_t m_unavailableFrameCount = 0;
+    uint64_t m_collectedFrameCount = 0;
+
+    // Trace - GPU ticks at the calibration point and the matching CPU profiler time
+    bool m_calibrated = false;
+    uint64_t m_calibrationTicks = 0;
+    uint64_t m_calibrationNanoseconds = 0;
+    bool m_recordEvents = false;
+    uint32_t m_maxEvents = 0;
+    std::vector<Event> m_events;
+    uint64_t m_droppedEventCount = 0;
+
+    void collectResults(FrameQueries &frame);
+    uint64_t toCpuNanoseconds(uint64_t ticks) const;
+    VulkanGpuScopeStatistics computeStatistics(const ScopeHistory &scope) const;
+
+};
+
+// Times the commands recorded while it lives. Does nothing if the profiler is null or disabled.
+class VulkanGpuScope
+{
+
+public:
+
+    VulkanGpuScope(VulkanGpuProfiler *profiler, VkCommandBuffer commandBuffer, uint32_t scopeId)
+        : m_profiler((profiler != nullptr && profiler->enabled()) ? profiler : nullptr),
+        m_commandBuffer(commandBuffer)
+    {
+        if (m_profiler != nullptr)
+            m_slot = m_profiler->beginScope(m_commandBuffer, scopeId);
+    }
+    ~VulkanGpuScope()
+    {
+        if (m_profiler != nullptr)
+            m_profiler->endScope(m_commandBuffer, m_slot);
+    }
+
+    VulkanGpuScope(const VulkanGpuScope &other) = delete;
+    void operator=(const VulkanGpuScope &other) = delete;
+
+private:
+
+    VulkanGpuProfiler *m_profiler;
+    VkCommandBuffer m_commandBuffer;
+    uint32_t m_slot = VulkanGpuProfiler::InvalidSlot;
+
+};
+
+#endif // VULKANGPUPROFILER_H
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "VulkanBuffer.h"
 #include "VulkanDescriptorPool.h"
 #include "VulkanDescriptorSets.h"
+#include "VulkanPipelineCache.h"
 
 // ----------------------------------------------------------------------------
 // Helper structures used to initialize the graphics pipeline
@@ -53,7 +54,8 @@ public:
         const std::vector<VkDynamicState> &dynamicStates,
         VkSampleCountFlagBits sampleCount,
         VkPipelineLayout pipelineLayout,
-        VkRenderPass &renderPass);
+        VkRenderPass &renderPass,
+        VulkanPipelineCache *pipelineCache = nullptr);
     void cleanup(VkDevice device);
 
 private:
@@ -13,4 +13,10 @@ void destroyDebugReportCallbackEXT(VkInstance instance,
     VkDebugReportCallbackEXT callback,
     const VkAllocationCallbacks *pAllocator);
 
+// Every aspect of the format - barriers on depth stencil images need both
+VkImageAspectFlags formatAspectMask(VkFormat format);
+
+// Last - replaces the Vulkan entry points with the counting wrappers
+#include "VulkanApiStats.h"
+
 #endif // VULKANHELPER_H
\ No newline at end of file
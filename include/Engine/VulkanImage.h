@@ -3,6 +3,12 @@
 
 #include "VulkanHelper.h"
 #include "VulkanPhysicalDevice.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanUploadManager.h"
+#include "VulkanBindlessHeap.h"
+#include "VulkanBarrierBatch.h"
+
+#include <vector>
 
 struct VulkanImageInfo
 {
@@ -23,7 +29,7 @@ public:
     VulkanImage() = default;
     ~VulkanImage() = default;
 
-    bool init(const VulkanPhysicalDevice &physicalDevice,
+    bool init(VulkanMemoryAllocator &allocator,
         VkDevice device, 
         VkImageType imageType, 
         VkFormat format,
@@ -37,7 +43,24 @@ public:
         VkImageLayout initialLayout,
         VkMemoryPropertyFlags memoryPropertyFlags);
     void cleanup(VkDevice device);
-    void transitionLayoutTo(VkImageLayout newLayout);
+    // Queue the barriers that move the subresources to the usage - adjacent mip levels and layers share one barrier.
+    // The tracked state is updated right away so the batch must be flushed before the commands that use the image.
+    void transition(VulkanBarrierBatch &barriers,
+        VulkanResourceUsage usage,
+        uint32_t baseMipLevel = 0,
+        uint32_t mipLevelCount = VK_REMAINING_MIP_LEVELS,
+        uint32_t baseArrayLayer = 0,
+        uint32_t arrayLayerCount = VK_REMAINING_ARRAY_LAYERS,
+        uint32_t queueFamily = VK_QUEUE_FAMILY_IGNORED);
+    // Whole image, the barrier is recorded immediately
+    void transitionLayoutTo(VkCommandBuffer commandBuffer, VulkanResourceUsage usage);
+    // Queue an upload of tightly packed texel data to mip 0 of every layer
+    bool upload(VulkanUploadManager &uploadManager,
+        VkImageAspectFlags imageAspect,
+        const void *data,
+        VkDeviceSize dataSize,
+        VkImageLayout finalLayout,
+        VulkanUploadToken &token);
     bool createView(VkDevice device,
         VkImageAspectFlags imageAspect,
         VkFormat viewFormat = VK_FORMAT_UNDEFINED,
@@ -46,20 +69,36 @@ public:
         uint32_t layerCount = 1,
         uint32_t baseMipLevel = 0,
         uint32_t levelCount = 1);
+    // Makes the view readable by index from the shaders. The image must be in imageLayout when it's sampled.
+    bool registerBindless(VulkanBindlessHeap &bindlessHeap, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
     // Accessors
     const inline VkImage get() const { return m_image; }
+    const inline VkImageView view() const { return m_imageView; }
+    const inline VulkanImageInfo &info() const { return m_imageInfo; }
+    // Layout after the transitions recorded so far
+    const inline VkImageLayout layout(uint32_t mipLevel = 0, uint32_t arrayLayer = 0) const { return m_subresourceStates[subresourceIndex(mipLevel, arrayLayer)].layout; }
+    // Tracked state of one subresource - for the code that records its own barriers (render graph)
+    inline VulkanResourceState &state(uint32_t mipLevel = 0, uint32_t arrayLayer = 0) { return m_subresourceStates[subresourceIndex(mipLevel, arrayLayer)]; }
+    // VulkanBindlessHeap::InvalidIndex until registered
+    const inline uint32_t bindlessIndex() const { return m_bindlessIndex; }
 
 private:
 
     bool createImage(VkDevice device);
-    bool allocateImageMemory(const VulkanPhysicalDevice &physicalDevice, VkDevice device, VkMemoryPropertyFlags memoryPropertyFlags);
+    bool allocateImageMemory(VkDevice device, VkMemoryPropertyFlags memoryPropertyFlags);
+    const inline uint32_t subresourceIndex(uint32_t mipLevel, uint32_t arrayLayer) const { return arrayLayer * m_imageInfo.mipCount + mipLevel; }
 
     VulkanImageInfo m_imageInfo = {};
     VkImage m_image = VK_NULL_HANDLE;
     VkImageView m_imageView = VK_NULL_HANDLE;
-    VkDeviceMemory m_imageMemory = VK_NULL_HANDLE;
-    VkImageLayout m_currentLayout = VK_IMAGE_LAYOUT_UNDEFINED, m_oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VulkanMemoryAllocation m_imageMemory = {};
+    VulkanMemoryAllocator *m_allocator = nullptr;
+    VkImageAspectFlags m_aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    // One per mip level of every array layer, layer major
+    std::vector<VulkanResourceState> m_subresourceStates;
+    VulkanBindlessHeap *m_bindlessHeap = nullptr;
+    uint32_t m_bindlessIndex = VulkanBindlessHeap::InvalidIndex;
 
 };
 
@@ -17,9 +17,11 @@ public:
     VulkanInstance() {}
     ~VulkanInstance();
 
+    // Headless instances don't enable the surface extensions - no window system is needed
     bool init(const std::string &appName, 
         unsigned int major, unsigned int minor,
-        unsigned int appMajor, unsigned int appMinor);
+        unsigned int appMajor, unsigned int appMinor,
+        bool headless = false);
     void cleanup();
 
     const inline VkInstance get() const { return m_instance; }
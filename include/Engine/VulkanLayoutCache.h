@@ -0,0 +1,73 @@
+#ifndef VULKANLAYOUTCACHE_H
+#define VULKANLAYOUTCACHE_H
+
+#include "VulkanHelper.h"
+#include "VulkanShaderReflection.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+// One descriptor as read by the descriptor update templates
+union VulkanDescriptorInfo
+{
+    VkDescriptorImageInfo image;
+    VkDescriptorBufferInfo buffer;
+    VkBufferView texelBufferView;
+};
+
+// Descriptor set layouts and pipeline layouts built from the shader reflection.
+// Identical layouts are created once and shared by every pipeline that asks for them.
+// Layouts are small so they live until cleanup.
+class VulkanLayoutCache
+{
+
+public:
+
+    VulkanLayoutCache() = default;
+    ~VulkanLayoutCache() = default;
+
+    VulkanLayoutCache(const VulkanLayoutCache &other) = delete;
+    void operator=(const VulkanLayoutCache &other) = delete;
+
+    bool init(VkDevice device);
+    void cleanup(VkDevice device);
+
+    // Layouts matching the merged interface of the shader stages. setLayouts[i] is the layout of set i.
+    // pushConstantRanges are the ranges declared by the pipeline layout.
+    // Uniform buffers get uniformBufferType - dynamic by default since per frame data lives in the uniform ring.
+    bool getPipelineLayout(const std::vector<const VulkanShaderReflection*> &stages,
+        VkPipelineLayout &pipelineLayout,
+        std::vector<VkDescriptorSetLayout> &setLayouts,
+        std::vector<VkPushConstantRange> &pushConstantRanges,
+        VkDescriptorType uniformBufferType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+    VkDescriptorSetLayout getDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings);
+    VkPipelineLayout getPipelineLayout(const std::vector<VkDescriptorSetLayout> &setLayouts, const std::vector<VkPushConstantRange> &pushConstantRanges);
+
+    // Writes every descriptor of a set layout created by the cache in one call. The template reads one
+    // VulkanDescriptorInfo per descriptor, in binding order then array element order.
+    VkDescriptorUpdateTemplate getUpdateTemplate(VkDescriptorSetLayout setLayout);
+    // Number of VulkanDescriptorInfo read by the update template of the layout
+    uint32_t descriptorCount(VkDescriptorSetLayout setLayout) const;
+
+    void printStatistics() const;
+
+private:
+
+    VkDevice m_device = VK_NULL_HANDLE;
+
+    // Keyed by the create info fields
+    std::map<std::vector<uint64_t>, VkDescriptorSetLayout> m_descriptorSetLayouts;
+    std::map<std::vector<uint64_t>, VkPipelineLayout> m_pipelineLayouts;
+    // Bindings and update template of the set layouts
+    std::map<VkDescriptorSetLayout, std::vector<VkDescriptorSetLayoutBinding>> m_setLayoutBindings;
+    std::map<VkDescriptorSetLayout, VkDescriptorUpdateTemplate> m_updateTemplates;
+
+    uint32_t m_descriptorSetLayoutRequests = 0;
+    uint32_t m_pipelineLayoutRequests = 0;
+
+    mutable std::mutex m_mutex;
+
+};
+
+#endif // VULKANLAYOUTCACHE_H
\ No newline at end of file
@@ -12,9 +12,14 @@ public:
     VulkanLogicalDevice() {}
     ~VulkanLogicalDevice() {}
 
+    // Creates queueCount queues in every queue family from the list. Duplicated families are created once.
+    // VK_EXT_descriptor_indexing is enabled with the given features if they're not null.
+    // VK_KHR_swapchain is only required when presenting.
     bool init(VkPhysicalDevice physicalDevice,
-        uint32_t queueFamilyIndex, 
-        uint32_t queueCount);
+        const std::vector<uint32_t> &queueFamilyIndices, 
+        uint32_t queueCount,
+        const VkPhysicalDeviceDescriptorIndexingFeaturesEXT *descriptorIndexingFeatures = nullptr,
+        bool presentation = true);
     void cleanup();
 
     inline const VkDevice &get() const { return m_logicalDevice; }
@@ -0,0 +1,127 @@
+#ifndef VULKANMEMORYALLOCATOR_H
+#define VULKANMEMORYALLOCATOR_H
+
+#include "VulkanHelper.h"
+#include "VulkanPhysicalDevice.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Kind of resource bound to a memory range. Linear (buffers, linear images) and optimal
+// (optimal tiled images) resources can't share a bufferImageGranularity page.
+enum class VulkanResourceType
+{
+    Free,
+    Linear,
+    Optimal
+};
+
+struct VulkanSuballocation
+{
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    VulkanResourceType type;
+};
+
+// One VkDeviceMemory object that is sub-allocated using a first-fit free list
+struct VulkanMemoryBlock
+{
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+    VkDeviceSize usedBytes = 0;
+    uint32_t allocationCount = 0;
+    void *mappedData = nullptr;
+    // Ordered by offset, neighbouring free ranges are always merged
+    std::list<VulkanSuballocation> suballocations;
+};
+
+struct VulkanMemoryAllocation
+{
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    uint32_t memoryTypeIndex = 0;
+    // Valid for host visible memory - the owning block stays mapped for its whole lifetime
+    void *mappedData = nullptr;
+    // nullptr for dedicated allocations
+    VulkanMemoryBlock *block = nullptr;
+};
+
+struct VulkanHeapStatistics
+{
+    VkDeviceSize heapSize = 0;
+    // Bytes allocated from the driver (blocks + dedicated allocations)
+    VkDeviceSize reservedBytes = 0;
+    // Bytes handed out to resources
+    VkDeviceSize usedBytes = 0;
+    uint32_t blockCount = 0;
+    uint32_t dedicatedAllocationCount = 0;
+    uint32_t allocationCount = 0;
+};
+
+class VulkanMemoryAllocator
+{
+
+public:
+
+    static const VkDeviceSize DefaultBlockSize = 64 * 1024 * 1024;
+
+    VulkanMemoryAllocator() = default;
+    ~VulkanMemoryAllocator() = default;
+
+    VulkanMemoryAllocator(const VulkanMemoryAllocator &other) = delete;
+    void operator=(const VulkanMemoryAllocator &other) = delete;
+
+    bool init(const VulkanPhysicalDevice &physicalDevice, VkDeviceSize preferredBlockSize = DefaultBlockSize);
+    void cleanup(VkDevice device);
+
+    bool allocate(VkDevice device,
+        const VkMemoryRequirements &memoryRequirements,
+        VkMemoryPropertyFlags memoryPropertyFlags,
+        VulkanResourceType resourceType,
+        VulkanMemoryAllocation &allocation);
+    void free(VkDevice device, VulkanMemoryAllocation &allocation);
+
+    // Query the memory requirements, allocate and bind the memory to the resource
+    bool allocateForBuffer(VkDevice device, VkBuffer buffer, VkMemoryPropertyFlags memoryPropertyFlags, VulkanMemoryAllocation &allocation);
+    bool allocateForImage(VkDevice device, VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags memoryPropertyFlags, VulkanMemoryAllocation &allocation);
+
+    std::vector<VulkanHeapStatistics> getStatistics() const;
+    void printStatistics() const;
+
+    inline const uint32_t driverAllocationCount() const { return m_driverAllocationCount.load(std::memory_order_relaxed); }
+
+private:
+
+    struct MemoryType
+    {
+        std::vector<std::unique_ptr<VulkanMemoryBlock>> blocks;
+        std::vector<VulkanMemoryAllocation> dedicatedAllocations;
+    };
+
+    VkPhysicalDeviceMemoryProperties m_memoryProperties = {};
+    VkDeviceSize m_bufferImageGranularity = 1;
+    VkDeviceSize m_preferredBlockSize = DefaultBlockSize;
+    // Changed under the lock, read without it
+    std::atomic<uint32_t> m_driverAllocationCount { 0 };
+
+    std::vector<MemoryType> m_memoryTypes;
+    mutable std::mutex m_mutex;
+
+    bool allocateFromType(VkDevice device,
+        uint32_t memoryTypeIndex,
+        const VkMemoryRequirements &memoryRequirements,
+        VulkanResourceType resourceType,
+        VulkanMemoryAllocation &allocation);
+    bool allocateDeviceMemory(VkDevice device, uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory &memory, void **mappedData);
+    void freeDeviceMemory(VkDevice device, VkDeviceMemory memory, void *mappedData);
+    bool allocateFromBlock(VulkanMemoryBlock &block, VkDeviceSize size, VkDeviceSize alignment, VulkanResourceType resourceType, VkDeviceSize &offset);
+    void freeFromBlock(VulkanMemoryBlock &block, VkDeviceSize offset);
+    VkDeviceSize blockSizeForType(uint32_t memoryTypeIndex) const;
+
+};
+
+#endif // VULKANMEMORYALLOCATOR_H
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "VulkanHelper.h"
 
+#include <vector>
+
 class VulkanPhysicalDevice
 {
 
@@ -11,12 +13,27 @@ public:
     VulkanPhysicalDevice() {}
     ~VulkanPhysicalDevice() {}
 
+    // Without a surface (headless) presentation support isn't required
     bool init(VkInstance instance, VkQueueFlags requiredQueueFamilyFlags, VkSurfaceKHR surface);
 
     inline const int getGraphicsQueueFamilyIndex() const { return m_graphicsQueueFamilyIndex; }
+    // -1 if the device was picked without a surface
     inline const int getPresentationQueueFamilyIndex() const { return m_presentationQueueFamilyIndex; }
+    // -1 if the device has no transfer only queue family
+    inline const int getTransferQueueFamilyIndex() const { return m_transferQueueFamilyIndex; }
+    inline const bool hasDedicatedTransferQueue() const { return m_transferQueueFamilyIndex != -1; }
     inline const VkPhysicalDevice &get() const { return m_physicalDevice; }
     inline const VkPhysicalDeviceMemoryProperties &getMemoryProperties() const { return m_memoryProperties; }
+    inline const VkPhysicalDeviceProperties &getDeviceProperties() const { return m_deviceProperties; }
+    // VK_EXT_descriptor_indexing with everything the bindless heap needs
+    inline const bool supportsDescriptorIndexing() const { return m_descriptorIndexingSupported; }
+    inline const VkPhysicalDeviceDescriptorIndexingFeaturesEXT &getDescriptorIndexingFeatures() const { return m_descriptorIndexingFeatures; }
+    inline const VkPhysicalDeviceDescriptorIndexingPropertiesEXT &getDescriptorIndexingProperties() const { return m_descriptorIndexingProperties; }
+
+    // First candidate with the format features for the tiling, VK_FORMAT_UNDEFINED if none has them
+    VkFormat findSupportedFormat(const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const;
+    // Optimal tiling depth attachment format - the smallest precise one, with a stencil aspect if asked for
+    VkFormat findDepthFormat(bool needsStencil = false) const;
 
 private:
 
@@ -30,7 +47,12 @@ private:
     VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
     int m_graphicsQueueFamilyIndex = -1;
     int m_presentationQueueFamilyIndex = -1;
+    int m_transferQueueFamilyIndex = -1;
     VkPhysicalDeviceMemoryProperties m_memoryProperties = {};
+    VkPhysicalDeviceProperties m_deviceProperties = {};
+    bool m_descriptorIndexingSupported = false;
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT m_descriptorIndexingFeatures = {};
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT m_descriptorIndexingProperties = {};
 
     bool hasRequiredFeatures(VkPhysicalDevice &physicalDevice,
         VkPhysicalDeviceProperties &deviceProperties,
@@ -38,6 +60,7 @@ private:
         uint16_t &deviceScore);
 
     bool findQueueFamilies(VkQueueFlags requiredQueueFamilyFlags, VkSurfaceKHR surface);
+    void queryDescriptorIndexingSupport();
 };
 
 #endif // VULKANPHYSICALDEVICE_H
\ No newline at end of file
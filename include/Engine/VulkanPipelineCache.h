@@ -0,0 +1,65 @@
+#ifndef VULKANPIPELINECACHE_H
+#define VULKANPIPELINECACHE_H
+
+#include "VulkanHelper.h"
+#include "VulkanPhysicalDevice.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+// State of the cache at startup
+enum class VulkanPipelineCacheState
+{
+    // No cache file
+    Cold,
+    // The cache file was written by a different device or driver and was discarded
+    Invalidated,
+    // Pipelines are created from the cache file contents
+    Warm
+};
+
+// VkPipelineCache loaded from a file at startup and written back on shutdown.
+// Pipeline caches are internally synchronized, the compile threads share this one.
+class VulkanPipelineCache
+{
+
+public:
+
+    VulkanPipelineCache() = default;
+    ~VulkanPipelineCache() = default;
+
+    VulkanPipelineCache(const VulkanPipelineCache &other) = delete;
+    void operator=(const VulkanPipelineCache &other) = delete;
+
+    bool init(VkDevice device, const VulkanPhysicalDevice &physicalDevice, const std::string &filename);
+    // Writes the cache file
+    bool save(VkDevice device);
+    void cleanup(VkDevice device);
+
+    // Time spent in vkCreate*Pipelines - used to compare cold and warm startups
+    void addPipelineCreation(double milliseconds);
+    void printStatistics() const;
+
+    const inline VkPipelineCache get() const { return m_pipelineCache; }
+    const inline VulkanPipelineCacheState state() const { return m_state; }
+
+private:
+
+    VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+
+    std::string m_filename;
+    VulkanPipelineCacheState m_state = VulkanPipelineCacheState::Cold;
+    size_t m_loadedBytes = 0;
+    double m_loadMilliseconds = 0.0;
+
+    std::atomic<uint32_t> m_pipelineCount { 0 };
+    std::atomic<uint64_t> m_creationMicroseconds { 0 };
+
+    bool isCompatible(const std::vector<char> &cacheData, const VulkanPhysicalDevice &physicalDevice) const;
+    std::vector<char> readFile(const std::string &filename) const;
+    bool writeFile(const std::string &filename, const std::vector<char> &data) const;
+
+};
+
+#endif // VULKANPIPELINECACHE_H
\ No newline at end of file
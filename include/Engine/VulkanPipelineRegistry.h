@@ -0,0 +1,197 @@
+#ifndef VULKANPIPELINEREGISTRY_H
+#define VULKANPIPELINEREGISTRY_H
+
+#include "VulkanHelper.h"
+#include "VulkanGraphicsPipeline.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanTimeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Full create state of a graphics pipeline - the arguments of VulkanGraphicsPipeline::init
+struct VulkanPipelineDesc
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VertexInputState vertexInputState;
+    DepthStencilState depthStencilState;
+    // Shader modules are identified by their handle, entry point and specialization data.
+    // The modules must stay alive until the pipeline is compiled.
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStagesInfo;
+    std::vector<VkPipelineColorBlendAttachmentState> colorBlendStates;
+    std::vector<VkDynamicState> dynamicStates;
+    VkSampleCountFlagBits sampleCount = VK_SAMPLE_COUNT_1_BIT;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    // Only used to create the pipeline - render passes with the same compatibility key share pipelines
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint64_t renderPassCompatibilityKey = 0;
+};
+
+enum class VulkanPipelineStatus
+{
+    // Waiting for or running on a compile thread
+    Pending,
+    Ready,
+    Failed
+};
+
+// Registry internals - shared between the registry, its compile threads and the handles
+struct VulkanPipelineEntry
+{
+    // Copy of the requested state - owns the entry point names and specialization data it points to
+    VulkanPipelineDesc desc;
+    std::vector<std::string> entryPointNames;
+    std::vector<VkSpecializationInfo> specializationInfos;
+    std::vector<std::vector<VkSpecializationMapEntry>> specializationMapEntries;
+    std::vector<std::vector<uint8_t>> specializationData;
+
+    // Serialized create state - compared on lookup
+    std::vector<uint8_t> key;
+    uint64_t hash = 0;
+
+    VulkanGraphicsPipeline pipeline;
+    std::atomic<VulkanPipelineStatus> status { VulkanPipelineStatus::Pending };
+    std::chrono::steady_clock::time_point requestTime;
+
+    // Guarded by the registry mutex
+    uint32_t refCount = 0;
+    // Graphics timeline value of the last frame that could use the pipeline once unreferenced
+    uint64_t retireValue = 0;
+};
+
+class VulkanPipelineRegistry;
+
+// Reference to a shared pipeline that may still be compiling. Copies share the reference
+// taken by the registry, it is dropped once with VulkanPipelineRegistry::release.
+class VulkanPipelineHandle
+{
+
+public:
+
+    VulkanPipelineHandle() = default;
+
+    inline const bool valid() const { return m_entry != nullptr; }
+    inline const VulkanPipelineStatus status() const { return m_entry->status.load(std::memory_order_acquire); }
+    inline const bool isReady() const { return valid() && status() == VulkanPipelineStatus::Ready; }
+
+    // Pipeline to bind for a draw - the fallback until the pipeline is ready.
+    // VK_NULL_HANDLE means the draw should be skipped. Call once per draw, draws without
+    // the real pipeline are counted as hitches.
+    VkPipeline get() const;
+
+private:
+
+    friend class VulkanPipelineRegistry;
+
+    std::shared_ptr<VulkanPipelineEntry> m_entry;
+    VulkanPipelineRegistry *m_registry = nullptr;
+    VkPipeline m_fallback = VK_NULL_HANDLE;
+
+};
+
+// Graphics pipelines shared by all the objects with the same create state.
+// Pipelines are looked up by a hash of the whole state, the full state is compared on a hit
+// so colliding hashes never share a pipeline. Handles are refcounted - a pipeline that
+// is no longer referenced is destroyed once the graphics queue is done with the frames using it.
+//
+// New pipelines can be compiled on background threads against the shared pipeline cache
+// so introducing a new state mid-run doesn't stall the frame. Until then the handle returns
+// the fallback pipeline given with the request, or nothing so the draw is skipped.
+class VulkanPipelineRegistry
+{
+
+public:
+
+    static const uint32_t DefaultCompileThreadCount = 2;
+
+    VulkanPipelineRegistry() = default;
+    ~VulkanPipelineRegistry() { stopCompileThreads(); }
+
+    VulkanPipelineRegistry(const VulkanPipelineRegistry &other) = delete;
+    void operator=(const VulkanPipelineRegistry &other) = delete;
+
+    // The graphics timeline tells when an unreferenced pipeline can be destroyed
+    bool init(VkDevice device,
+        VulkanTimeline &graphicsTimeline,
+        VulkanPipelineCache *pipelineCache = nullptr,
+        uint32_t compileThreadCount = DefaultCompileThreadCount);
+    // Pipelines still queued for compilation are dropped
+    void cleanup(VkDevice device);
+
+    // Returns a ready pipeline matching the state and takes a reference to it - blocks if it has to be compiled.
+    // The handle is invalid on failure.
+    VulkanPipelineHandle acquire(const VulkanPipelineDesc &desc);
+    // Same without blocking - the pipeline is compiled on a compile thread if it doesn't exist yet.
+    // The fallback must stay alive as long as the returned handle is used.
+    VulkanPipelineHandle acquireAsync(const VulkanPipelineDesc &desc, VkPipeline fallback = VK_NULL_HANDLE);
+    // Blocks until the compilation of the pipeline is over. Returns false if it failed.
+    bool wait(const VulkanPipelineHandle &handle);
+    // Drops the reference taken by acquire and invalidates the handle
+    void release(VulkanPipelineHandle &handle);
+    // Destroys the unreferenced pipelines the GPU is done with - called once per frame
+    void collectGarbage();
+
+    void printStatistics() const;
+
+    inline const uint32_t hitCount() const { return m_hitCount; }
+    inline const uint32_t missCount() const { return m_missCount; }
+
+private:
+
+    friend class VulkanPipelineHandle;
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VulkanTimeline *m_graphicsTimeline = nullptr;
+    VulkanPipelineCache *m_pipelineCache = nullptr;
+
+    // Entries by create state hash
+    std::unordered_map<uint64_t, std::vector<std::shared_ptr<VulkanPipelineEntry>>> m_entries;
+    uint32_t m_entryCount = 0;
+    uint32_t m_retiredCount = 0;
+
+    // Compile threads
+    std::vector<std::thread> m_compileThreads;
+    std::deque<std::shared_ptr<VulkanPipelineEntry>> m_compileQueue;
+    std::condition_variable m_compileCondition;
+    // Notified when a compilation is over
+    std::condition_variable m_readyCondition;
+    bool m_stopCompiling = false;
+
+    mutable std::mutex m_mutex;
+
+    // Statistics
+    uint32_t m_hitCount = 0;
+    uint32_t m_missCount = 0;
+    uint32_t m_destroyedCount = 0;
+    // Hitches - the frame either blocked on a compilation or drew without the real pipeline
+    uint32_t m_asyncCompileCount = 0;
+    double m_maxReadyMilliseconds = 0.0;
+    double m_totalReadyMilliseconds = 0.0;
+    uint32_t m_blockingWaitCount = 0;
+    double m_blockingWaitMilliseconds = 0.0;
+    mutable std::atomic<uint64_t> m_fallbackDrawCount { 0 };
+    mutable std::atomic<uint64_t> m_skippedDrawCount { 0 };
+
+    // Takes a reference to the entry of the state, created is set if the caller has to compile it
+    VulkanPipelineHandle acquireEntry(const VulkanPipelineDesc &desc, bool &created);
+    // async - requested through acquireAsync, the time until the pipeline is ready is a hitch
+    bool compile(VulkanPipelineEntry &entry, bool async);
+    void compileThreadLoop();
+    void stopCompileThreads();
+
+    static void copyDesc(const VulkanPipelineDesc &desc, VulkanPipelineEntry &entry);
+    static void buildKey(const VulkanPipelineDesc &desc, std::vector<uint8_t> &key);
+    static uint64_t hashKey(const std::vector<uint8_t> &key);
+
+};
+
+#endif // VULKANPIPELINEREGISTRY_H
\ No newline at end of file
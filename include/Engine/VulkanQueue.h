@@ -3,19 +3,29 @@
 
 #include "VulkanHelper.h"
 #include "VulkanCommandBuffers.h"
+#include "VulkanTimeline.h"
 
+#include <mutex>
 #include <vector>
 
+// Binary semaphores for the swap chain - the presentation engine doesn't support timeline semaphores
 struct VulkanSynchronizationObject
 {
     std::vector<VkSemaphore> waitForObjects;
     std::vector<VkSemaphore> signalObjects;
-    std::vector<VkFence> fences;
 
-    bool init(VkDevice device, uint32_t waitForObjectCount, uint32_t signalObjectCount, uint32_t fencesCount);
+    bool init(VkDevice device, uint32_t waitForObjectCount, uint32_t signalObjectCount);
     void cleanup(VkDevice device);
 };
 
+// Semaphore a submit waits on. The value is ignored for binary semaphores.
+struct VulkanSemaphoreWait
+{
+    VkSemaphore semaphore;
+    uint64_t value;
+    VkPipelineStageFlags stage;
+};
+
 class VulkanQueue
 {
 
@@ -24,16 +34,28 @@ public:
     VulkanQueue() {}
     ~VulkanQueue() {}
 
-    void init(VkDevice logicalDevice, uint32_t queueFamilyIndex, uint32_t queueIndex);
-    bool submitCommandBuffers(VkDevice logicalDevice, const std::vector<VkCommandBuffer> &commandBuffers) const;
-    bool submitCommandBuffers(const VulkanSynchronizationObject &syncObject, uint32_t currentFrameIndex, const std::vector<VkCommandBuffer> &commandBuffers) const;
+    bool init(VkDevice logicalDevice, uint32_t queueFamilyIndex, uint32_t queueIndex);
+    void cleanup(VkDevice logicalDevice);
+
+    // Every submit signals the next value of the queue timeline and returns it in submissionValue
+    bool submitCommandBuffers(const std::vector<VkCommandBuffer> &commandBuffers,
+        uint64_t &submissionValue,
+        const std::vector<VulkanSemaphoreWait> &waitSemaphores = {},
+        const std::vector<VkSemaphore> &signalSemaphores = {});
+    bool submitCommandBuffersAndWait(const std::vector<VkCommandBuffer> &commandBuffers);
 
     const inline VkQueue &queueHandle() const { return m_queueHandle; }
+    const inline uint32_t familyIndex() const { return m_queueFamilyIndex; }
+    inline VulkanTimeline &timeline() { return m_timeline; }
 
 private:
 
-    VkQueue m_queueHandle;
-    VkDevice *m_device = nullptr;
+    VkQueue m_queueHandle = VK_NULL_HANDLE;
+    uint32_t m_queueFamilyIndex = 0;
+    VulkanTimeline m_timeline;
+
+    // vkQueueSubmit needs external synchronization and the timeline values have to be signalled in order
+    std::mutex m_submitMutex;
 
 };
 
@@ -0,0 +1,191 @@
+#ifndef VULKANRENDERGRAPH_H
+#define VULKANRENDERGRAPH_H
+
+#include "VulkanHelper.h"
+#include "VulkanPhysicalDevice.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanBarrierBatch.h"
+#include "VulkanRenderPass.h"
+#include "VulkanGpuProfiler.h"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Virtual image of a render graph
+struct VulkanRenderGraphResource
+{
+    uint32_t index = 0xFFFFFFFF;
+    const inline bool valid() const { return index != 0xFFFFFFFF; }
+};
+
+struct VulkanRenderGraphPass
+{
+    uint32_t index = 0xFFFFFFFF;
+    const inline bool valid() const { return index != 0xFFFFFFFF; }
+};
+
+// Image owned by the graph - only lives between its first and last use in a frame
+struct VulkanRenderGraphImageDesc
+{
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent2D extent = {};
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+// What a pass records into. renderPass and framebuffer are null for passes without attachments.
+struct VulkanRenderGraphContext
+{
+    VkCommandBuffer commandBuffer;
+    VkRenderPass renderPass;
+    VkFramebuffer framebuffer;
+    VkExtent2D extent;
+};
+
+// Frame graph - passes declare the images they read and write, the graph works out the rest:
+//  - passes that don't contribute to an imported image (or have no side effects) are culled
+//  - every pass with attachments gets a render pass whose store ops depend on the later readers
+//  - barriers and layout transitions between the passes are recorded with a VulkanBarrierBatch
+//  - transient images whose lifetimes don't overlap share the same memory
+// The graph is declared and compiled once, then executed every frame. Imported images (the
+// swap chain image) are bound again before every execution.
+class VulkanRenderGraph
+{
+
+public:
+
+    typedef std::function<void(const VulkanRenderGraphContext &context)> ExecuteCallback;
+
+    VulkanRenderGraph() = default;
+    ~VulkanRenderGraph() = default;
+
+    VulkanRenderGraph(const VulkanRenderGraph &other) = delete;
+    void operator=(const VulkanRenderGraph &other) = delete;
+
+    // Resources
+    VulkanRenderGraphResource createImage(const std::string &name, const VulkanRenderGraphImageDesc &desc);
+    // Image owned outside the graph, left in finalUsage at the end of the frame
+    VulkanRenderGraphResource importImage(const std::string &name, const VulkanRenderGraphImageDesc &desc, VulkanResourceUsage finalUsage);
+
+    // Passes - executed in the order they are added
+    VulkanRenderGraphPass addPass(const std::string &name, ExecuteCallback execute);
+    void writeColor(VulkanRenderGraphPass pass, VulkanRenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearColorValue clearValue = {});
+    void writeDepthStencil(VulkanRenderGraphPass pass, VulkanRenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearDepthStencilValue clearValue = { 1.0f, 0 });
+    // Depth test against the contents without writing them
+    void readDepthStencil(VulkanRenderGraphPass pass, VulkanRenderGraphResource resource);
+    // Sampled or copied by the pass
+    void read(VulkanRenderGraphPass pass, VulkanRenderGraphResource resource, VulkanResourceUsage usage = VulkanResourceUsage::FragmentShaderRead);
+    // Never culled - for passes that write outside the graph
+    void setSideEffects(VulkanRenderGraphPass pass);
+    // Can change between executions, e.g. when the pass content is recorded in secondary command buffers
+    void setSubpassContents(VulkanRenderGraphPass pass, VkSubpassContents subpassContents);
+
+    // Cull, create the render passes and the transient images. Nothing can be added afterwards.
+    bool compile(VkDevice device, const VulkanPhysicalDevice &physicalDevice, VulkanMemoryAllocator &allocator);
+    void cleanup(VkDevice device);
+
+    // Time every pass on the GPU - the scopes are named after the passes
+    void setProfiler(VulkanGpuProfiler *profiler);
+
+    // The state is updated by every execution
+    void bindImportedImage(VulkanRenderGraphResource resource, VkImage image, VkImageView imageView, VulkanResourceState &state);
+    bool execute(VkCommandBuffer commandBuffer);
+
+    // Valid after compile - pipelines are created against it
+    const VulkanRenderPass &renderPass(VulkanRenderGraphPass pass) const { return m_passes[pass.index].renderPass; }
+    const inline bool isCulled(VulkanRenderGraphPass pass) const { return m_passes[pass.index].culled; }
+    // View of a transient image - for the descriptors of the passes that read it
+    const inline VkImageView imageView(VulkanRenderGraphResource resource) const { return m_resources[resource.index].imageView; }
+    // Image bound to the resource for the current execution - for the copies recorded by the passes
+    const inline VkImage image(VulkanRenderGraphResource resource) const { return m_resources[resource.index].image; }
+
+    void printStatistics() const;
+
+private:
+
+    // How a pass uses a resource
+    struct Access
+    {
+        uint32_t resource;
+        VulkanResourceUsage usage;
+        // Attachments only
+        bool attachment;
+        VkAttachmentLoadOp loadOp;
+        VkClearValue clearValue;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        ExecuteCallback execute;
+        std::vector<Access> accesses;
+        bool sideEffects = false;
+        VkSubpassContents subpassContents = VK_SUBPASS_CONTENTS_INLINE;
+
+        bool culled = false;
+        uint32_t profilerScope = 0;
+        VulkanRenderPass renderPass;
+        VkExtent2D extent = {};
+        // Attachment order - color attachments then the depth stencil attachment
+        std::vector<uint32_t> attachmentAccesses;
+        std::vector<VkClearValue> clearValues;
+    };
+
+    struct Resource
+    {
+        std::string name;
+        VulkanRenderGraphImageDesc desc;
+        bool imported = false;
+        VulkanResourceUsage finalUsage = VulkanResourceUsage::Undefined;
+        VkImageUsageFlags usage = 0;
+
+        // Alive pass range, firstPass > lastPass if unused
+        uint32_t firstPass = 0xFFFFFFFF;
+        uint32_t lastPass = 0;
+        // Previous user of the aliased memory - the first use waits for it
+        int aliasPredecessor = -1;
+        uint32_t aliasGroup = 0xFFFFFFFF;
+
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView imageView = VK_NULL_HANDLE;
+        VulkanResourceState ownState;
+        VulkanResourceState *state = nullptr;
+        VkMemoryRequirements memoryRequirements = {};
+    };
+
+    // Transient images bound to the same memory
+    struct AliasGroup
+    {
+        VkMemoryRequirements memoryRequirements = {};
+        std::vector<uint32_t> resources;
+        VulkanMemoryAllocation memory;
+    };
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VulkanMemoryAllocator *m_allocator = nullptr;
+    bool m_compiled = false;
+
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<AliasGroup> m_aliasGroups;
+    // Keyed by the attachment views
+    std::map<std::pair<uint32_t, std::vector<VkImageView>>, VkFramebuffer> m_framebuffers;
+
+    VulkanBarrierBatch m_barriers;
+    VulkanGpuProfiler *m_profiler = nullptr;
+
+    VkDeviceSize m_transientBytes = 0;
+    VkDeviceSize m_aliasedBytes = 0;
+
+    void addAccess(VulkanRenderGraphPass pass, VulkanRenderGraphResource resource, VulkanResourceUsage usage, bool attachment, VkAttachmentLoadOp loadOp, VkClearValue clearValue);
+    void cullPasses();
+    void computeLifetimes();
+    bool createRenderPass(VkDevice device, uint32_t passIndex);
+    bool createTransientImages(VkDevice device, const VulkanPhysicalDevice &physicalDevice, VulkanMemoryAllocator &allocator);
+    bool isReadLater(uint32_t resourceIndex, uint32_t passIndex) const;
+    VkFramebuffer getFramebuffer(uint32_t passIndex);
+
+};
+
+#endif // VULKANRENDERGRAPH_H
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "VulkanHelper.h"
 
+#include <vector>
+
 class VulkanRenderPass
 {
 
@@ -11,14 +13,24 @@ public:
     VulkanRenderPass() {}
     ~VulkanRenderPass() {}
 
-    bool init(VkDevice device, VkFormat swapChainFormat);
+    // Single subpass render pass. The attachments must already be in their subpass layout
+    // (color attachment or depth stencil layout) - the layout transitions and the dependencies
+    // with the other passes are barriers recorded by the render graph.
+    bool init(VkDevice device,
+        const std::vector<VkAttachmentDescription> &colorAttachments,
+        const VkAttachmentDescription *depthStencilAttachment = nullptr);
     void cleanup(VkDevice device);
 
     inline const VkRenderPass get() const { return m_renderPass; }
+    inline const uint32_t attachmentCount() const { return m_attachmentCount; }
+    // Equal for render passes that pipelines can be shared between (same attachment formats and sample counts)
+    inline const uint64_t compatibilityKey() const { return m_compatibilityKey; }
 
 private:
 
     VkRenderPass m_renderPass = VK_NULL_HANDLE;
+    uint32_t m_attachmentCount = 0;
+    uint64_t m_compatibilityKey = 0;
 
 };
 
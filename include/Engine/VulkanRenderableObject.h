@@ -2,6 +2,9 @@
 #define VULKANRENDERABLEOBJECT_H
 
 #include "VulkanHelper.h"
+#include "VulkanShader.h"
+#include <string>
+#include <utility>
 #include <vector>
 
 class VulkanEngine;
@@ -14,17 +17,40 @@ public:
     VulkanRenderableObject() = default;
     virtual ~VulkanRenderableObject() = default;
 
-    virtual bool init(const VulkanEngine &engine,
+    virtual bool init(VulkanEngine &engine,
         uint32_t width, uint32_t height,
-        const std::vector<VkPipelineShaderStageCreateInfo> &shaderStagesInfo) = 0;
+        const std::vector<const VulkanShader*> &shaders) = 0;
     virtual void cleanup() = 0;
     virtual void render(VkCommandBuffer currentCommandBuffer) const = 0;
     virtual void update(double dt, uint32_t frameIndex) = 0;
 
-private:
+    // Opaque renderables are drawn front to back so the depth test rejects the hidden fragments
+    // before they are shaded, the others back to front after them
+    virtual bool isOpaque() const { return true; }
+    // View space distance to the camera used to sort the renderables
+    virtual float sortDepth() const { return 0.0f; }
+    // Shown by the profilers
+    virtual std::string name() const { return "renderable"; }
 
+protected:
 
+    // Push constant ranges declared by the pipeline layout of the renderable
+    std::vector<VkPushConstantRange> m_pushConstantRanges;
+
+    // Writes per draw data straight into the command buffer - no buffer write or descriptor binding.
+    // The bytes must be covered by the push constant ranges, the stage flags are taken from them.
+    bool pushConstants(VkCommandBuffer commandBuffer, 
+        VkPipelineLayout pipelineLayout, 
+        uint32_t offset, 
+        uint32_t size, 
+        const void *data) const;
 
 };
 
+// Draw order of a frame - opaque renderables front to back, then the others back to front.
+// sortKeys is scratch storage, kept by the caller so the sort doesn't allocate every frame.
+void sortDrawList(const std::vector<const VulkanRenderableObject*> &renderables,
+    std::vector<std::pair<float, const VulkanRenderableObject*>> &sortKeys,
+    std::vector<const VulkanRenderableObject*> &drawList);
+
 #endif // VULKANRENDERABLEOBJECT_H
\ No newline at end of file
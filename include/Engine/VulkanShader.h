@@ -2,6 +2,8 @@
 #define VULKANSHADER_H
 
 #include "VulkanHelper.h"
+#include "VulkanShaderReflection.h"
+#include "VulkanSpecializationConstants.h"
 
 #include <fstream>
 #include <vector>
@@ -20,16 +22,23 @@ public:
 
     inline const VkShaderModule shaderModule() const { return m_shaderModule; }
     inline const VkPipelineShaderStageCreateInfo shaderStageInfo() const { return m_shaderStageCreateInfo; }
+    // Stage specialized with the given constants - they must outlive the returned info.
+    // Constants the shader doesn't declare or with the wrong size are reported.
+    VkPipelineShaderStageCreateInfo shaderStageInfo(const VulkanSpecializationConstants &constants) const;
+    // Descriptor bindings, push constants and inputs declared by the shader
+    inline const VulkanShaderReflection &reflection() const { return m_reflection; }
 
 private:
 
     std::vector<char> readFile(const std::string &filename);
 
     VkShaderModule m_shaderModule = VK_NULL_HANDLE;
-    VkPipelineShaderStageCreateInfo m_shaderStageCreateInfo;
+    VkPipelineShaderStageCreateInfo m_shaderStageCreateInfo = {};
+    VulkanShaderReflection m_reflection;
 
     bool createShaderModule(VkDevice device,
-        const std::string &shaderFilename);
+        const std::string &shaderFilename,
+        std::vector<char> &shaderBinary);
 };
 
 #endif // VULKANSHADER_H
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef VULKANSHADERREFLECTION_H
+#define VULKANSHADERREFLECTION_H
+
+#include "VulkanHelper.h"
+
+#include <map>
+#include <vector>
+
+// Stage input variable - vertex attributes for vertex shaders
+struct VulkanShaderInput
+{
+    uint32_t location;
+    // VK_FORMAT_UNDEFINED for types that don't map to a single attribute (matrices, doubles...)
+    VkFormat format;
+};
+
+// Resource interface of one shader stage read from its SPIR-V: descriptor bindings,
+// push constants and stage inputs. Only the declarations are parsed, so every
+// resource declared by the module is reported even if the entry point doesn't use it.
+class VulkanShaderReflection
+{
+
+public:
+
+    VulkanShaderReflection() = default;
+    ~VulkanShaderReflection() = default;
+
+    bool init(const std::vector<char> &spirv, VkShaderStageFlagBits stage);
+
+    // Uniform buffers are reported as VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, the layout decides whether they are dynamic.
+    // Runtime sized arrays have a descriptorCount of 0.
+    inline const std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> &descriptorSets() const { return m_descriptorSets; }
+    inline const std::vector<VkPushConstantRange> &pushConstantRanges() const { return m_pushConstantRanges; }
+    inline const std::vector<VulkanShaderInput> &inputs() const { return m_inputs; }
+    // Size in bytes of the specialization constants by constant id
+    inline const std::map<uint32_t, uint32_t> &specializationConstants() const { return m_specializationConstants; }
+    inline const VkShaderStageFlagBits stage() const { return m_stage; }
+
+private:
+
+    // What the parser keeps of the ids it needs
+    struct SpirvId
+    {
+        uint32_t opcode = 0;
+        // Type operands - component/element/pointee type
+        uint32_t typeId = 0;
+        // Vector/matrix component count, array length id, image dim, int/float width
+        uint32_t count = 0;
+        // Storage class of pointers and variables, signedness of ints, sampled operand of images
+        uint32_t storageClass = 0;
+        // OpConstant value
+        uint32_t value = 0;
+        std::vector<uint32_t> members;
+        std::vector<uint32_t> memberOffsets;
+        std::vector<uint32_t> memberMatrixStrides;
+
+        // Decorations
+        uint32_t set = 0;
+        uint32_t binding = 0;
+        uint32_t location = 0;
+        uint32_t arrayStride = 0;
+        uint32_t specId = 0;
+        bool hasSpecId = false;
+        bool hasBinding = false;
+        bool hasLocation = false;
+        bool isBuiltIn = false;
+        bool isBlock = false;
+        bool isBufferBlock = false;
+    };
+
+    VkShaderStageFlagBits m_stage = VK_SHADER_STAGE_VERTEX_BIT;
+    std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> m_descriptorSets;
+    std::vector<VkPushConstantRange> m_pushConstantRanges;
+    std::vector<VulkanShaderInput> m_inputs;
+    std::map<uint32_t, uint32_t> m_specializationConstants;
+
+    bool parse(const std::vector<uint32_t> &code, std::vector<SpirvId> &ids) const;
+    bool descriptorType(const std::vector<SpirvId> &ids, uint32_t typeId, uint32_t storageClass, VkDescriptorType &type, uint32_t &count) const;
+    uint32_t typeSize(const std::vector<SpirvId> &ids, uint32_t typeId, uint32_t matrixStride = 0) const;
+    VkFormat inputFormat(const std::vector<SpirvId> &ids, uint32_t typeId) const;
+
+};
+
+#endif // VULKANSHADERREFLECTION_H
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef VULKANSPECIALIZATIONCONSTANTS_H
+#define VULKANSPECIALIZATIONCONSTANTS_H
+
+#include "VulkanHelper.h"
+
+#include <map>
+#include <vector>
+
+// Values of the specialization constants of a shader stage, set by constant id
+// (layout(constant_id = N) in GLSL). The driver folds them into the pipeline so
+// feature toggles and loop counts cost nothing at runtime.
+class VulkanSpecializationConstants
+{
+
+public:
+
+    VulkanSpecializationConstants() = default;
+    ~VulkanSpecializationConstants() = default;
+
+    VulkanSpecializationConstants(const VulkanSpecializationConstants &other);
+    VulkanSpecializationConstants &operator=(const VulkanSpecializationConstants &other);
+
+    void set(uint32_t constantId, bool value);
+    void set(uint32_t constantId, int32_t value);
+    void set(uint32_t constantId, uint32_t value);
+    void set(uint32_t constantId, float value);
+
+    inline const bool empty() const { return m_values.empty(); }
+    inline const std::map<uint32_t, std::vector<uint8_t>> &values() const { return m_values; }
+
+    // Valid until the next set. The constants are laid out in constant id order
+    // so the same values always give the same pipeline state.
+    const VkSpecializationInfo *info() const { return empty() ? nullptr : &m_info; }
+
+private:
+
+    std::map<uint32_t, std::vector<uint8_t>> m_values;
+
+    std::vector<VkSpecializationMapEntry> m_mapEntries;
+    std::vector<uint8_t> m_data;
+    VkSpecializationInfo m_info = {};
+
+    void setValue(uint32_t constantId, const void *value, size_t size);
+    void updateInfo();
+
+};
+
+#endif // VULKANSPECIALIZATIONCONSTANTS_H
\ No newline at end of file
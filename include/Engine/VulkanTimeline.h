@@ -0,0 +1,52 @@
+#ifndef VULKANTIMELINE_H
+#define VULKANTIMELINE_H
+
+#include "VulkanHelper.h"
+
+#include <atomic>
+#include <limits>
+
+// Timeline semaphore (VK_KHR_timeline_semaphore) owned by a queue. Every submit to the queue
+// signals the next value so "is submission N done" is a single counter comparison.
+class VulkanTimeline
+{
+
+public:
+
+    VulkanTimeline() = default;
+    ~VulkanTimeline() = default;
+
+    VulkanTimeline(const VulkanTimeline &other) = delete;
+    void operator=(const VulkanTimeline &other) = delete;
+
+    bool init(VkDevice device);
+    void cleanup(VkDevice device);
+
+    // Reserve the value signalled by the next submit. Called by the owning queue.
+    inline uint64_t nextValue() { return ++m_lastSubmittedValue; }
+
+    // Reads the counter from the device
+    uint64_t completedValue();
+    // Non blocking - only queries the device if the cached counter is behind
+    bool hasCompleted(uint64_t value);
+    bool wait(uint64_t value, uint64_t timeout = std::numeric_limits<uint64_t>::max());
+    bool waitIdle() { return wait(m_lastSubmittedValue); }
+
+    const inline VkSemaphore get() const { return m_semaphore; }
+    const inline uint64_t lastSubmittedValue() const { return m_lastSubmittedValue; }
+
+private:
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VkSemaphore m_semaphore = VK_NULL_HANDLE;
+
+    std::atomic<uint64_t> m_lastSubmittedValue { 0 };
+    std::atomic<uint64_t> m_completedValue { 0 };
+
+    // Extension entry points aren't exported by the loader
+    PFN_vkGetSemaphoreCounterValueKHR m_getSemaphoreCounterValue = nullptr;
+    PFN_vkWaitSemaphoresKHR m_waitSemaphores = nullptr;
+
+};
+
+#endif // VULKANTIMELINE_H
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef VULKANUNIFORMRING_H
+#define VULKANUNIFORMRING_H
+
+#include "VulkanHelper.h"
+#include "VulkanPhysicalDevice.h"
+#include "VulkanMemoryAllocator.h"
+
+#include <atomic>
+
+// One persistently mapped uniform buffer split into a slice per frame in flight.
+// Uniform blocks are bump allocated from the slice of the current frame and bound
+// through VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC descriptors using the returned offset.
+class VulkanUniformRing
+{
+
+public:
+
+    VulkanUniformRing() = default;
+    ~VulkanUniformRing() = default;
+
+    bool init(VkDevice device,
+        VulkanMemoryAllocator &allocator,
+        const VulkanPhysicalDevice &physicalDevice,
+        VkDeviceSize frameSize,
+        uint32_t framesInFlight);
+    void cleanup(VkDevice device);
+
+    // Start writing into the slice of the given frame. The GPU must be done with that frame.
+    void beginFrame(uint32_t frameIndex);
+    // Reserve an aligned block in the current frame slice. Returns the CPU address to write to
+    // or nullptr if the slice is full. Safe to call from multiple threads.
+    void *allocate(VkDeviceSize size, uint32_t &dynamicOffset);
+    bool write(const void *data, VkDeviceSize size, uint32_t &dynamicOffset);
+
+    const inline VkBuffer get() const { return m_buffer; }
+    const inline VkDeviceSize alignment() const { return m_alignment; }
+    const inline VkDeviceSize frameSize() const { return m_frameSize; }
+
+private:
+
+    VkBuffer m_buffer = VK_NULL_HANDLE;
+    VulkanMemoryAllocation m_memory = {};
+    VulkanMemoryAllocator *m_allocator = nullptr;
+
+    VkDeviceSize m_alignment = 1;
+    VkDeviceSize m_frameSize = 0;
+    uint32_t m_framesInFlight = 0;
+
+    // Offsets relative to the beginning of the buffer
+    VkDeviceSize m_frameBegin = 0;
+    std::atomic<VkDeviceSize> m_head { 0 };
+
+};
+
+#endif // VULKANUNIFORMRING_H
\ No newline at end of file
@@ -0,0 +1,130 @@
+#ifndef VULKANUPLOADMANAGER_H
+#define VULKANUPLOADMANAGER_H
+
+#include "VulkanHelper.h"
+#include "VulkanQueue.h"
+#include "VulkanCommandPool.h"
+#include "VulkanCommandBuffers.h"
+#include "VulkanMemoryAllocator.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Identifies the batch an upload was recorded in. Tokens grow monotonically so a
+// completed token means every upload with a smaller or equal token is done as well.
+typedef uint64_t VulkanUploadToken;
+
+// Batches buffer and image uploads. Data is copied into a persistently mapped staging ring
+// and the copies are recorded into a recycled command buffer. All the copies recorded
+// between two flushes are sent with a single submit and retired through the queue timeline.
+// Callers only wait when they need the uploaded data on the CPU side or want to free it.
+//
+// When the transfer queue comes from a different family than the graphics queue the batch
+// releases the ownership of its resources on the transfer queue. A second command buffer
+// acquires them on the graphics queue after waiting on the transfer queue timeline,
+// so the graphics queue only waits on the GPU and the copies overlap rendering.
+class VulkanUploadManager
+{
+
+public:
+
+    static const VkDeviceSize DefaultStagingSize = 32 * 1024 * 1024;
+    static const uint32_t DefaultContextCount = 4;
+
+    VulkanUploadManager() = default;
+    ~VulkanUploadManager() = default;
+
+    VulkanUploadManager(const VulkanUploadManager &other) = delete;
+    void operator=(const VulkanUploadManager &other) = delete;
+
+    bool init(VkDevice device,
+        VulkanMemoryAllocator &allocator,
+        VulkanQueue &transferQueue,
+        VulkanQueue &graphicsQueue,
+        VkDeviceSize stagingSize = DefaultStagingSize,
+        uint32_t contextCount = DefaultContextCount);
+    void cleanup(VkDevice device);
+
+    // Record a copy into the current batch. The data is copied to the staging ring before returning.
+    // Buffers bigger than the staging ring are split in several copies.
+    bool uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size, VulkanUploadToken &token);
+    // Copy tightly packed texel data to mip 0 of the image and leave it in finalLayout
+    bool uploadImage(VkImage dstImage,
+        VkImageAspectFlags aspect,
+        VkExtent3D extent,
+        uint32_t layerCount,
+        const void *data,
+        VkDeviceSize size,
+        VkImageLayout finalLayout,
+        VulkanUploadToken &token);
+
+    // Submit the current batch. Does nothing if no upload was recorded since the last flush.
+    bool flush();
+    // Non blocking - retires the batches the GPU is done with
+    bool isComplete(VulkanUploadToken token);
+    // Flushes the batch of the token if needed and blocks until it is executed
+    bool wait(VulkanUploadToken token);
+    bool waitIdle();
+
+    inline const VulkanUploadToken completedToken() const { return m_completedToken; }
+    inline const bool transfersOwnership() const { return m_transferQueueFamilyIndex != m_graphicsQueueFamilyIndex; }
+
+private:
+
+    // A recycled command buffer and the staging ring range its copies read from
+    struct UploadContext
+    {
+        VulkanCommandPool commandPool;
+        VulkanCommandBuffers commandBuffers;
+        // Ownership acquire on the graphics queue - only used when the queue families differ
+        VulkanCommandPool acquireCommandPool;
+        VulkanCommandBuffers acquireCommandBuffers;
+        std::vector<VkBufferMemoryBarrier> bufferOwnershipBarriers;
+        std::vector<VkImageMemoryBarrier> imageOwnershipBarriers;
+        // Timeline value of the last submit of the batch - on the graphics queue when ownership is transferred
+        uint64_t submissionValue = 0;
+        VulkanUploadToken token = 0;
+        // Staging ring head after the last allocation of the batch
+        VkDeviceSize ringEnd = 0;
+        // Staging bytes owned by the batch, including the padding and the bytes skipped on wrap
+        VkDeviceSize ringBytes = 0;
+        bool recording = false;
+    };
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VulkanQueue *m_transferQueue = nullptr;
+    VulkanQueue *m_graphicsQueue = nullptr;
+    uint32_t m_transferQueueFamilyIndex = 0;
+    uint32_t m_graphicsQueueFamilyIndex = 0;
+    VulkanMemoryAllocator *m_allocator = nullptr;
+
+    // Staging ring
+    VkBuffer m_stagingBuffer = VK_NULL_HANDLE;
+    VulkanMemoryAllocation m_stagingMemory = {};
+    VkDeviceSize m_stagingSize = 0;
+    VkDeviceSize m_head = 0;
+    VkDeviceSize m_tail = 0;
+    VkDeviceSize m_usedBytes = 0;
+
+    std::vector<UploadContext> m_contexts;
+    // Contexts submitted to the queue, oldest first
+    std::deque<uint32_t> m_inFlight;
+    uint32_t m_currentContext = 0;
+
+    VulkanUploadToken m_nextToken = 1;
+    VulkanUploadToken m_completedToken = 0;
+
+    std::mutex m_mutex;
+
+    bool beginBatch();
+    bool flushBatch();
+    bool submitOwnershipAcquire(UploadContext &context, uint64_t transferValue);
+    inline VulkanQueue &completionQueue() { return transfersOwnership() ? *m_graphicsQueue : *m_transferQueue; }
+    bool retireOldest(bool block);
+    bool reserveStaging(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset);
+    bool tryReserveStaging(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset);
+
+};
+
+#endif // VULKANUPLOADMANAGER_H
\ No newline at end of file
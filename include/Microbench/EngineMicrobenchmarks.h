@@ -0,0 +1,77 @@
+#ifndef ENGINEMICROBENCHMARKS_H
+#define ENGINEMICROBENCHMARKS_H
+
+#include "VulkanHelper.h"
+#include "VulkanCommandBuffers.h"
+#include "VulkanPipelineRegistry.h"
+
+#include "Microbench.h"
+#include "MicrobenchDevice.h"
+#include "MicrobenchRenderable.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+// CPU cost of the engine hot paths, one benchmark per path:
+//  - vertex input descriptions, built into new vectors on every call
+//  - queue submission, with the per submit semaphore and timeline vectors
+//  - uniform writes into the ring, alone and for a whole render list
+//  - render list sort and command recording
+//  - pipeline lookup by create state hash
+//  - descriptor set allocation and template writes
+class EngineMicrobenchmarks
+{
+
+public:
+
+    EngineMicrobenchmarks() = default;
+    ~EngineMicrobenchmarks() = default;
+
+    EngineMicrobenchmarks(const EngineMicrobenchmarks &other) = delete;
+    void operator=(const EngineMicrobenchmarks &other) = delete;
+
+    // Uniform ring frame size needed by the render list benchmarks
+    static VkDeviceSize uniformFrameSize(uint32_t objectCount);
+
+    // Renderables are placed at random depths, one in eight is blended
+    bool init(MicrobenchDevice &device, uint32_t objectCount, uint32_t seed);
+    void cleanup();
+
+    void addBenchmarks(Microbench &microbench);
+
+private:
+
+    MicrobenchDevice *m_device = nullptr;
+
+    // Pipeline state - the null driver never reads the shader code
+    VkShaderModule m_vertexShaderModule = VK_NULL_HANDLE;
+    VkShaderModule m_fragmentShaderModule = VK_NULL_HANDLE;
+    float m_brightness = 1.0f;
+    VkSpecializationMapEntry m_specializationMapEntry = {};
+    VkSpecializationInfo m_specializationInfo = {};
+    VkRenderPass m_renderPass = VK_NULL_HANDLE;
+    VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+    VulkanPipelineDesc m_pipelineDesc;
+
+    VkSampler m_sampler = VK_NULL_HANDLE;
+    VkImageView m_imageView = VK_NULL_HANDLE;
+    std::vector<VulkanDescriptorInfo> m_descriptors;
+
+    MicrobenchDrawState m_drawState;
+    std::vector<std::unique_ptr<MicrobenchRenderable>> m_renderables;
+    std::vector<const VulkanRenderableObject*> m_renderableList;
+    std::vector<std::pair<float, const VulkanRenderableObject*>> m_sortKeys;
+    std::vector<const VulkanRenderableObject*> m_drawList;
+
+    VulkanCommandBuffers m_commandBuffers;
+    VkSemaphore m_waitSemaphore = VK_NULL_HANDLE;
+    VkSemaphore m_signalSemaphore = VK_NULL_HANDLE;
+
+    bool createPipelineState();
+    bool createDescriptors();
+    bool createRenderables(uint32_t objectCount, uint32_t seed);
+
+};
+
+#endif // ENGINEMICROBENCHMARKS_H
\ No newline at end of file
@@ -0,0 +1,95 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct MicrobenchConfig
+{
+    // Measured samples per benchmark, the warmup ones are thrown away
+    uint32_t sampleCount = 30;
+    uint32_t warmupSampleCount = 3;
+    // Iterations per sample are doubled until a sample takes this long - keeps the clock resolution out of the results
+    double minSampleMilliseconds = 10.0;
+    // Only the benchmarks whose name contains it are run
+    std::string filter;
+};
+
+// Time of one iteration, in nanoseconds
+struct MicrobenchResult
+{
+    std::string name;
+    uint64_t iterationsPerSample = 0;
+    uint32_t sampleCount = 0;
+    double minNanoseconds = 0.0;
+    double medianNanoseconds = 0.0;
+    double meanNanoseconds = 0.0;
+    double maxNanoseconds = 0.0;
+    // Spread - median absolute deviation and standard deviation of the samples
+    double madNanoseconds = 0.0;
+    double stddevNanoseconds = 0.0;
+    // 95% confidence interval of the median, from the ranks of the sorted samples
+    double medianLowNanoseconds = 0.0;
+    double medianHighNanoseconds = 0.0;
+};
+
+// Keeps the compiler from removing the computation of a value nobody reads
+template <typename T>
+inline void keepValue(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static const void *volatile sink;
+    sink = &value;
+#endif
+}
+
+// Runs CPU microbenchmarks with repeated timed samples. Every benchmark is a callback running
+// its body for the given number of iterations, setup belongs outside of it. Results are written
+// as JSON and compared against a previous run to catch regressions.
+class Microbench
+{
+
+public:
+
+    typedef std::function<void(uint64_t iterations)> RunCallback;
+
+    Microbench() = default;
+    ~Microbench() = default;
+
+    Microbench(const Microbench &other) = delete;
+    void operator=(const Microbench &other) = delete;
+
+    void add(const std::string &name, RunCallback run);
+    // Runs every benchmark matching the filter and prints its result
+    void run(const MicrobenchConfig &config);
+
+    bool writeResults(const std::string &filename) const;
+    // Regressions are medians slower than the baseline by more than thresholdPercent whose confidence
+    // intervals don't overlap. Returns false if any benchmark regressed or the baseline can't be read.
+    bool compareBaseline(const std::string &filename, double thresholdPercent) const;
+
+    const inline std::vector<MicrobenchResult> &results() const { return m_results; }
+
+private:
+
+    struct Benchmark
+    {
+        std::string name;
+        RunCallback run;
+    };
+
+    std::vector<Benchmark> m_benchmarks;
+    std::vector<MicrobenchResult> m_results;
+
+    static double sampleNanoseconds(const RunCallback &run, uint64_t iterations);
+    static uint64_t calibrate(const RunCallback &run, double minSampleMilliseconds);
+    static MicrobenchResult computeResult(const std::string &name, uint64_t iterations, std::vector<double> samples);
+    static bool readResults(const std::string &filename, std::vector<MicrobenchResult> &results);
+
+};
+
+#endif // MICROBENCH_H
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef MICROBENCHDEVICE_H
+#define MICROBENCHDEVICE_H
+
+#include "VulkanHelper.h"
+#include "VulkanInstance.h"
+#include "VulkanPhysicalDevice.h"
+#include "VulkanLogicalDevice.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanQueue.h"
+#include "VulkanCommandPool.h"
+#include "VulkanLayoutCache.h"
+#include "VulkanDescriptorAllocator.h"
+#include "VulkanUniformRing.h"
+#include "VulkanPipelineRegistry.h"
+
+// Engine objects the microbenchmarks run against. Created through the usual engine code
+// on whatever Vulkan implementation is linked - the null driver in the microbenchmark target.
+class MicrobenchDevice
+{
+
+public:
+
+    static const uint32_t FramesInFlight = 2;
+    static const VkDeviceSize DefaultUniformFrameSize = 4 * 1024 * 1024;
+
+    MicrobenchDevice() = default;
+    ~MicrobenchDevice() = default;
+
+    MicrobenchDevice(const MicrobenchDevice &other) = delete;
+    void operator=(const MicrobenchDevice &other) = delete;
+
+    bool init(VkDeviceSize uniformFrameSize = DefaultUniformFrameSize);
+    void cleanup();
+
+    inline VkDevice device() const { return m_logicalDevice.get(); }
+    inline const VulkanPhysicalDevice &physicalDevice() const { return m_physicalDevice; }
+    inline VulkanQueue &graphicsQueue() { return m_graphicsQueue; }
+    inline VkCommandPool commandPool() const { return m_commandPool.get(); }
+    inline VulkanLayoutCache &layoutCache() { return m_layoutCache; }
+    inline VulkanDescriptorAllocator &descriptorAllocator() { return m_descriptorAllocator; }
+    inline VulkanUniformRing &uniformRing() { return m_uniformRing; }
+    inline VulkanPipelineRegistry &pipelineRegistry() { return m_pipelineRegistry; }
+
+private:
+
+    VulkanInstance m_instance;
+    VulkanPhysicalDevice m_physicalDevice;
+    VulkanLogicalDevice m_logicalDevice;
+    VulkanMemoryAllocator m_memoryAllocator;
+    VulkanQueue m_graphicsQueue;
+    VulkanCommandPool m_commandPool;
+    VulkanLayoutCache m_layoutCache;
+    VulkanDescriptorAllocator m_descriptorAllocator;
+    VulkanUniformRing m_uniformRing;
+    VulkanPipelineRegistry m_pipelineRegistry;
+
+};
+
+#endif // MICROBENCHDEVICE_H
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef MICROBENCHRENDERABLE_H
+#define MICROBENCHRENDERABLE_H
+
+#include "VulkanHelper.h"
+#include "VulkanRenderableObject.h"
+#include "VulkanPipelineRegistry.h"
+#include "VulkanUniformRing.h"
+
+#include <glm/glm.hpp>
+
+// Uniform block of a renderable - same layout as the benchmark objects
+struct MicrobenchUniforms
+{
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::vec4 tint;
+};
+
+// State shared by every renderable
+struct MicrobenchDrawState
+{
+    VulkanPipelineHandle pipeline;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    std::vector<VkPushConstantRange> pushConstantRanges;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    uint32_t indexCount = 0;
+};
+
+// Renderable recording the same commands as a real object - set up by the microbenchmarks,
+// the engine is never involved
+class MicrobenchRenderable : public VulkanRenderableObject
+{
+
+public:
+
+    MicrobenchRenderable(const MicrobenchDrawState &drawState, VulkanUniformRing &uniformRing, float depth, bool opaque);
+    ~MicrobenchRenderable() override = default;
+
+    // Unused - everything comes from the draw state
+    bool init(VulkanEngine &engine,
+        uint32_t width, uint32_t height,
+        const std::vector<const VulkanShader*> &shaders) override { return true; }
+    void cleanup() override {}
+    void render(VkCommandBuffer currentCommandBuffer) const override;
+    void update(double dt, uint32_t frameIndex) override;
+    bool isOpaque() const override { return m_opaque; }
+    float sortDepth() const override { return m_depth; }
+    std::string name() const override { return "microbench renderable"; }
+
+private:
+
+    struct PushConstants
+    {
+        glm::mat4 model;
+    };
+
+    const MicrobenchDrawState &m_drawState;
+    VulkanUniformRing &m_uniformRing;
+    float m_depth;
+    bool m_opaque;
+
+    MicrobenchUniforms m_uniformData;
+    PushConstants m_pushConstants;
+    uint32_t m_uniformDynamicOffset = 0;
+    double m_time = 0.0;
+
+};
+
+#endif // MICROBENCHRENDERABLE_H
\ No newline at end of file
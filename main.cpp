@@ -1,4 +1,6 @@
 #include<iostream>
+#include<string>
+#include<cstdlib>
 
 #include "VulkanEngine.h"
 #include "VulkanApp.h"
@@ -7,15 +9,58 @@ int main(int argc, char const *argv[])
 {
     uint32_t m_width = 800, m_height = 600;
 
+    // --headless [--frames N] - render N frames offscreen, no window or display needed
+    // --capture PREFIX [--capture-format png|ppm|raw] [--capture-interval N] - write the frames to files
+    // --trace FILE - write the CPU zones and GPU scopes of the run as a Chrome trace
+    // --api-stats [--api-stats-log] - count the Vulkan calls, print them on exit or after every frame
+    bool headless = false;
+    uint32_t frameCount = 100;
+    std::string capturePrefix;
+    VulkanImageFileFormat captureFormat = VulkanImageFileFormat::PNG;
+    uint32_t captureInterval = 1;
+    std::string traceFilename;
+    bool apiStats = false;
+    bool apiStatsLog = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--headless")
+            headless = true;
+        else if (arg == "--frames" && i + 1 < argc)
+            frameCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--capture" && i + 1 < argc)
+            capturePrefix = argv[++i];
+        else if (arg == "--capture-format" && i + 1 < argc)
+        {
+            const std::string format = argv[++i];
+            captureFormat = (format == "ppm") ? VulkanImageFileFormat::PPM : (format == "raw") ? VulkanImageFileFormat::Raw : VulkanImageFileFormat::PNG;
+        }
+        else if (arg == "--capture-interval" && i + 1 < argc)
+            captureInterval = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--trace" && i + 1 < argc)
+            traceFilename = argv[++i];
+        else if (arg == "--api-stats")
+            apiStats = true;
+        else if (arg == "--api-stats-log")
+            apiStats = apiStatsLog = true;
+    }
+
+    if (capturePrefix.empty() == false)
+        VulkanEngine::getInstance().enableFrameCapture(capturePrefix, captureFormat, captureInterval);
+    if (traceFilename.empty() == false)
+        VulkanEngine::getInstance().enableTrace(traceFilename);
+    if (apiStats)
+        VulkanEngine::getInstance().enableApiStats(apiStatsLog);
+
     auto &vulkanApp = VulkanApp::getInstance();
-    if (vulkanApp.init(m_width, m_height) == false)
+    if (vulkanApp.init(m_width, m_height, headless) == false)
     {
         std::cout << "Failed to initialize vulkan app.\n";
         return -1;
     }
 
     // Main loop
-    vulkanApp.run();
+    vulkanApp.run(frameCount);
 
     // Cleanup vulkan
     vulkanApp.cleanup();
@@ -0,0 +1,77 @@
+#include<iostream>
+#include<string>
+#include<cstdlib>
+
+#include "Microbench.h"
+#include "MicrobenchDevice.h"
+#include "EngineMicrobenchmarks.h"
+
+int main(int argc, char const *argv[])
+{
+    // [--samples N] [--warmup N] [--min-sample-ms X] [--filter NAME] [--objects N] [--seed N]
+    // [--output FILE] [--baseline FILE [--threshold PERCENT]]
+    MicrobenchConfig config;
+    uint32_t objectCount = 1000;
+    uint32_t seed = 1;
+    std::string outputFilename = "./microbench.json";
+    std::string baselineFilename;
+    double thresholdPercent = 5.0;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--samples" && i + 1 < argc)
+            config.sampleCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--warmup" && i + 1 < argc)
+            config.warmupSampleCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--min-sample-ms" && i + 1 < argc)
+            config.minSampleMilliseconds = std::strtod(argv[++i], nullptr);
+        else if (arg == "--filter" && i + 1 < argc)
+            config.filter = argv[++i];
+        else if (arg == "--objects" && i + 1 < argc)
+            objectCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--output" && i + 1 < argc)
+            outputFilename = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc)
+            baselineFilename = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc)
+            thresholdPercent = std::strtod(argv[++i], nullptr);
+        else
+        {
+            std::cout << "Unknown microbenchmark argument " << arg << ".\n";
+            return -1;
+        }
+    }
+    if (config.sampleCount == 0)
+    {
+        std::cout << "At least one sample is needed.\n";
+        return -1;
+    }
+
+    MicrobenchDevice device;
+    EngineMicrobenchmarks engineMicrobenchmarks;
+    if (device.init(EngineMicrobenchmarks::uniformFrameSize(objectCount)) == false ||
+        engineMicrobenchmarks.init(device, objectCount, seed) == false)
+    {
+        std::cout << "Failed to initialize the microbenchmarks.\n";
+        engineMicrobenchmarks.cleanup();
+        device.cleanup();
+        return -1;
+    }
+
+    Microbench microbench;
+    engineMicrobenchmarks.addBenchmarks(microbench);
+
+    std::cout << "\nMicrobenchmarks: " << config.sampleCount << " samples of at least " << config.minSampleMilliseconds << " ms\n\n";
+    microbench.run(config);
+
+    bool passed = microbench.writeResults(outputFilename);
+    if (baselineFilename.empty() == false)
+        passed = microbench.compareBaseline(baselineFilename, thresholdPercent) && passed;
+
+    engineMicrobenchmarks.cleanup();
+    device.cleanup();
+
+    return passed ? 0 : -1;
+}
\ No newline at end of file
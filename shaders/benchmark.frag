@@ -0,0 +1,19 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// One value per pipeline of the benchmark scene
+layout(constant_id = 0) const float brightness = 1.0f;
+
+// Shared by the objects that use the same texture
+layout(binding = 1) uniform sampler2D objectTexture;
+
+layout(location = 0) in vec3 vertexColor;
+layout(location = 0) out vec4 outputColor;
+
+void main()
+{
+    // Screen space texel lookup - the vertex format has no texture coordinates
+    ivec2 textureExtent = textureSize(objectTexture, 0);
+    vec3 texel = texelFetch(objectTexture, ivec2(gl_FragCoord.xy) % textureExtent, 0).rgb;
+    outputColor = vec4(vertexColor * texel * brightness, 1.0f);
+}
\ No newline at end of file
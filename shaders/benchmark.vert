@@ -0,0 +1,30 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+out gl_PerVertex
+{
+    vec4 gl_Position;
+};
+
+// Static or rewritten every frame depending on the benchmark scene
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+    vec4 tint;
+} ubo;
+
+// Per draw data - written into the command buffer
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+} pushConstants;
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec3 color;
+
+layout(location = 0) out vec3 fragColor;
+
+void main()
+{
+    gl_Position = ubo.proj * ubo.view * pushConstants.model * vec4(position, 0.0f, 1.0f);
+    fragColor = color * ubo.tint.rgb;
+}
\ No newline at end of file
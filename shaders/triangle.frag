@@ -1,10 +1,13 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// Set when the pipeline is created
+layout(constant_id = 0) const float brightness = 1.0f;
+
 layout(location = 0) in vec3 vertexColor;
 layout(location = 0) out vec4 outputColor;
 
 void main()
 {
-    outputColor = vec4(vertexColor, 1.0f);
+    outputColor = vec4(vertexColor * brightness, 1.0f);
 }
\ No newline at end of file
@@ -7,11 +7,15 @@ out gl_PerVertex
 };
 
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 proj;
 } ubo;
 
+// Per draw data - written into the command buffer
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+} pushConstants;
+
 layout(location = 0) in vec2 position;
 layout(location = 1) in vec3 color;
 
@@ -19,6 +23,6 @@ layout(location = 0) out vec3 fragColor;
 
 void main()
 {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 0.0f, 1.0f);
+    gl_Position = ubo.proj * ubo.view * pushConstants.model * vec4(position, 0.0f, 1.0f);
     fragColor = color;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "Quad.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "VulkanLogicalDevice.h"
@@ -7,35 +8,42 @@
 Quad::Quad(VkDevice device)
     : m_logicalDevice(device)
 {
-
+    m_quadPushConstants.model = glm::mat4(1.0f);
+    m_quadUniformData.view = glm::mat4(1.0f);
+    m_quadUniformData.proj = glm::mat4(1.0f);
 }
 
-bool Quad::init(const VulkanEngine &engine,
+bool Quad::init(VulkanEngine &engine,
     uint32_t width, uint32_t height, 
-    const std::vector<VkPipelineShaderStageCreateInfo> &shaderStagesInfo)
+    const std::vector<const VulkanShader*> &shaders)
 {
     m_width = width;
     m_height = height;
 
     // Create pipeline layout
-    if (createPipelineLayout(engine.device()) == false) return false;
+    if (createPipelineLayout(engine.layoutCache(), shaders) == false) return false;
 
     // Create graphics pipeline
-    if (createGraphicsPipeline(engine.device(), width, height, engine.renderPass().get(), shaderStagesInfo) == false) return false;
+    if (createGraphicsPipeline(engine.device(), width, height, engine.renderPass(), shaders, engine.pipelineRegistry()) == false) return false;
 
-    // Create descriptor pool
-    std::vector<VkDescriptorPoolSize> poolSizes = {
-        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 }
-    };
-    if (m_descriptorPool.init(engine.device(), poolSizes, poolSizes.size()) == false)
+    // Descriptor set - lives as long as the engine descriptor allocator
+    if (engine.descriptorAllocator().allocate(m_descriptorSetLayout, m_descriptorSet) == false)
         return false;
 
-    // Create descriptor set
-    if (m_descriptorSets.init(engine.device(), m_descriptorPool, { m_descriptorSetLayout }) == false)
+    // Setup geometry
+    if (setupGeometry(engine.physicalDevice(), engine.device(), engine.memoryAllocator(), engine.uploadManager()) == false)
         return false;
 
-    // Setup geometry
-    if (setupGeometry(engine.physicalDevice(), engine.device(), engine.graphicsQueue(), engine.framesInFlight()) == false)
+    // Test image - readable by index from bindless shaders
+    if (engine.bindlessEnabled())
+    {
+        if (m_testImage.registerBindless(engine.bindlessHeap()) == false)
+            return false;
+    }
+
+    // Point the uniform buffer descriptor at the engine uniform ring
+    m_uniformRing = &engine.uniformRing();
+    if (setupDescriptorSets(engine.descriptorAllocator()) == false)
         return false;
 
     // Success
@@ -44,20 +52,27 @@ bool Quad::init(const VulkanEngine &engine,
     
 void Quad::cleanup()
 {
-    // Descriptor set layout
-    if (m_descriptorSetLayout != VK_NULL_HANDLE)
-        vkDestroyDescriptorSetLayout(m_logicalDevice, m_descriptorSetLayout, nullptr);
-
-    // Pipeline layout
-    if (m_pipelineLayout != VK_NULL_HANDLE)
-        vkDestroyPipelineLayout(m_logicalDevice, m_pipelineLayout, nullptr);
+    // Graphics pipeline - destroyed by the registry once nothing uses it. Wait for a compilation
+    // still in progress, it reads the shader modules. The layouts belong to the engine layout cache.
+    if (m_pipelineRegistry != nullptr)
+    {
+        m_pipelineRegistry->wait(m_pipeline);
+        m_pipelineRegistry->release(m_pipeline);
+    }
 
-    // Descritpor pool
-    m_descriptorPool.cleanup(m_logicalDevice);
+    // Buffers and images - returns their memory to the engine allocator
+    m_quadVertexBuffer.cleanup(m_logicalDevice);
+    m_quadIndexBuffer.cleanup(m_logicalDevice);
+    m_testImage.cleanup(m_logicalDevice);
 }
 
 void Quad::render(VkCommandBuffer currentCommandBuffer) const
 {
+    // Skip the quad until its pipeline is compiled
+    const VkPipeline pipeline = m_pipeline.get();
+    if (pipeline == VK_NULL_HANDLE)
+        return;
+
     // Set dynamic viewport
     VkViewport viewport = {};
     viewport.x = 0.0f;
@@ -69,7 +84,15 @@ void Quad::render(VkCommandBuffer currentCommandBuffer) const
 
     vkCmdSetViewport(currentCommandBuffer, 0, 1, &viewport);
     // Bind the pipline
-    vkCmdBindPipeline(currentCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.get());
+    vkCmdBindPipeline(currentCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    // Bind the descriptor set - the dynamic offset selects this frame's uniform block in the ring
+    vkCmdBindDescriptorSets(currentCommandBuffer, 
+        VK_PIPELINE_BIND_POINT_GRAPHICS, 
+        m_pipelineLayout, 
+        0, 1, &m_descriptorSet, 
+        1, &m_uniformDynamicOffset);
+    // Model matrix - goes straight into the command buffer
+    pushConstants(currentCommandBuffer, m_pipelineLayout, 0, sizeof(PushConstants), &m_quadPushConstants);
     // Bind the quad vertex buffer
     VkBuffer vertexBuffers[] = { m_quadVertexBuffer.get() };
     VkDeviceSize offsets[] = { 0 };
@@ -82,15 +105,34 @@ void Quad::render(VkCommandBuffer currentCommandBuffer) const
 
 void Quad::update(double dt, uint32_t frameIndex)
 {
-    // Update uniform data
-    if (m_quadUniformBuffer.updateUniformData(m_logicalDevice, 
-            frameIndex,
-            reinterpret_cast<void*>(&m_quadUniformData),
-            sizeof(UniformBufferObject)) == 0)
+    // Update uniform data - written straight into the persistently mapped ring slice of the current frame
+    if (m_uniformRing->write(&m_quadUniformData, sizeof(UniformBufferObject), m_uniformDynamicOffset) == false)
         std::cout << "Failed to update uniform data.\n";
 }
 
-bool Quad::setupGeometry(const VulkanPhysicalDevice &physicalDevice, VkDevice device, const VulkanQueue &graphicsQueue, uint32_t framesInFlight)
+float Quad::sortDepth() const
+{
+    // The camera looks down -z in view space
+    const glm::vec4 viewPosition = m_quadUniformData.view * m_quadPushConstants.model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    return -viewPosition.z;
+}
+
+bool Quad::waitForPipeline()
+{
+    if (m_pipelineRegistry->wait(m_pipeline) == false)
+    {
+        std::cout << "Failed to compile the quad pipeline.\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
+
+bool Quad::setupGeometry(const VulkanPhysicalDevice &physicalDevice, 
+    VkDevice device, 
+    VulkanMemoryAllocator &allocator, 
+    VulkanUploadManager &uploadManager)
 {
     // Triangle vertex buffer setup
     std::vector<VertexPC> vertices = {
@@ -107,30 +149,24 @@ bool Quad::setupGeometry(const VulkanPhysicalDevice &physicalDevice, VkDevice de
     // Init vertex buffer
     if (m_quadVertexBuffer.init(physicalDevice, 
             device, 
+            allocator,
             sizeof(vertices[0]),
             vertices.size(),
             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
             reinterpret_cast<void*>(vertices.data()),
-            graphicsQueue) == 0) return false;
+            uploadManager) == 0) return false;
     // Init index buffer
     if (m_quadIndexBuffer.init(physicalDevice,
             device,
+            allocator,
             sizeof(indices[0]),
             indices.size(),
             VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
             reinterpret_cast<void*>(indices.data()),
-            graphicsQueue) == 0) return false;
-    // Init uniform buffer
-    if (m_quadUniformBuffer.init(physicalDevice,
-            device,
-            sizeof(UniformBufferObject),
-            framesInFlight,
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            reinterpret_cast<void*>(&m_quadUniformData),
-            graphicsQueue) == 0) return false;
+            uploadManager) == 0) return false;
 
     // Image
-    if (m_testImage.init(physicalDevice, 
+    if (m_testImage.init(allocator, 
         device, 
         VK_IMAGE_TYPE_2D, 
         VK_FORMAT_R16G16B16A16_SFLOAT,
@@ -145,85 +181,42 @@ bool Quad::setupGeometry(const VulkanPhysicalDevice &physicalDevice, VkDevice de
     return true;
 }
 
-bool Quad::createPipelineLayout(VkDevice device)
+bool Quad::setupDescriptorSets(VulkanDescriptorAllocator &descriptorAllocator)
 {
-    // Descriptor binding  
-    //  - binding - number that corresponds to a resource of the same type in the shader stages
-    //  E.g. GLSL: layout (set=1, binding=1) uniform uniformBuffer
-
-	//	- descriptor type - specifies the type of resource descriptors used for this binding
-    //  E.g. VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, etc.
-
-    //	- count - number of descriptors contained in the binding that will be accessed in the shader as an array.
-    //  E.g. GLSL: layout (set=0, binding=1) uniform texture2D sampledImagesArray[12];
-
-	//	- set of shaders that can access the binding
-    //  E.g. VK_SHADER_STAGE_FRAGMENT_BIT, VK_SHADER_STAGE_VERTEX_BIT, etc.
-
-    //  - set of immutable samplers
-    //  Used when we don't want to update the samplers dynamically
-
-    // Setup an array of descriptor bindings
-    const VkDescriptorSetLayoutBinding layoutBindings[] = 
-    {
-        // Descriptor binding to a uniform buffer
-        {
-            0,                                      // binding
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,      // descriptorType
-            1,                                      // descriptorCount
-            VK_SHADER_STAGE_VERTEX_BIT,             // stageFlags
-            nullptr                                 // pImmutableSamplers
-        }
+    // One descriptor per binding of the set layout, in binding order.
+    // The offset inside the ring is supplied when the descriptor set is bound.
+    VulkanDescriptorInfo uniformBufferDescriptor = {};
+    uniformBufferDescriptor.buffer = {
+        m_uniformRing->get(),                   // buffer
+        0,                                      // offset
+        sizeof(UniformBufferObject)             // range
     };
 
-    // Descriptor set layout - defines the types and number of descriptors in a descriptor set
-    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
-    // In the current example we'll only have one decriptor set, so only one element of type VkDescriptorSetLayoutCreateInfo
-    const VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo[] = 
-    {
-        // Descriptor set layout create into for our descriptor set that contains one binding
-        {
-            VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,        // sType
-            nullptr,                                                    // pNext
-            0,                                                          // flags
-            1,                                                          // bindingCount
-            &layoutBindings[0]                                          // pBindings
-        }
-    };
-    // Create the descriptor set layout
-    if (vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo[0], nullptr, &m_descriptorSetLayout) != VK_SUCCESS)
+    return descriptorAllocator.write(m_descriptorSet, m_descriptorSetLayout, { uniformBufferDescriptor });
+}
+
+bool Quad::createPipelineLayout(VulkanLayoutCache &layoutCache, const std::vector<const VulkanShader*> &shaders)
+{
+    // Descriptor set layouts and pipeline layout built from the bindings and push constants
+    // declared by the shaders - shared with every other object using the same interface.
+    // The uniform buffer is dynamic so we can move it around the uniform ring.
+    std::vector<const VulkanShaderReflection*> stages;
+    for (const VulkanShader *shader : shaders)
+        stages.push_back(&shader->reflection());
+
+    std::vector<VkDescriptorSetLayout> setLayouts;
+    if (layoutCache.getPipelineLayout(stages, m_pipelineLayout, setLayouts, m_pushConstantRanges) == false)
     {
-        std::cout << "Failed to create the quad descriptor set layout. \n";
+        std::cout << "Failed to create the quad pipeline layout. \n";
         return false;
     }
-
-    // Pipeline layout
-    //  - describes the set of resources that can be accessed by a pipeline
-	//  - gives access to a descriptor set from a pipeline
-	//  - the sequence of descriptor set layouts determines the interface between the shader stages and shader resources
-	//  - each pipeline is created based on a pipeline layout
-    
-    // Structure
-    // pipeline layout
-	// {
-    //      descriptor_set_layout0 descriptor_set_layout1 ... descriptor_set_layoutN
-	//      push_constant_range0 push_constant_range1 ... push_constant_rangeN
-    // }
-    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
-        VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,			// sType
-	    nullptr,												// pNext
-	    0,														// flags
-	    1,														// setLayoutCount													 // sets included in the pipeline
-	    &m_descriptorSetLayout,									// pSetLayouts 														// descriptor set layouts
-	    0,														// pushConstantRangeCount
-	    nullptr													// pPushConstantRanges
-    };
-    // Create the pipeline layout
-    if (vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+    // The quad binds its uniform buffer in set 0
+    if (setLayouts.empty())
     {
-        std::cout << "Failed to create pipeline layout.\n";
+        std::cout << "The quad shaders don't declare any descriptor set. \n";
         return false;
     }
+    m_descriptorSetLayout = setLayouts[0];
 
     // Success
     return true;
@@ -231,16 +224,39 @@ bool Quad::createPipelineLayout(VkDevice device)
 
 bool Quad::createGraphicsPipeline(VkDevice device, 
     uint32_t width, uint32_t height, 
-    VkRenderPass renderPass,
-    const std::vector<VkPipelineShaderStageCreateInfo> &shaderStagesInfo)
+    const VulkanRenderPass &renderPass,
+    const std::vector<const VulkanShader*> &shaders,
+    VulkanPipelineRegistry &pipelineRegistry)
 {
+    VulkanPipelineDesc pipelineDesc = {};
+    pipelineDesc.width = width;
+    pipelineDesc.height = height;
+
     // Depth stencil state
-    DepthStencilState depthStencilState = {};
+    pipelineDesc.depthStencilState = {};
 
     // Vertex input state
-    VertexInputState vertexInputState = {};
-    vertexInputState.vertexBindingDescriptions = VertexPC::getBindingDescription();
-    vertexInputState.vertexAttributeDescriptions = VertexPC::getAttributeDescriptions();
+    pipelineDesc.vertexInputState.vertexBindingDescriptions = VertexPC::getBindingDescription();
+    pipelineDesc.vertexInputState.vertexAttributeDescriptions = VertexPC::getAttributeDescriptions();
+
+    // The vertex format must feed every input of the vertex shader
+    for (const VulkanShader *shader : shaders)
+    {
+        if (shader->reflection().stage() != VK_SHADER_STAGE_VERTEX_BIT)
+            continue;
+        for (const VulkanShaderInput &input : shader->reflection().inputs())
+        {
+            const auto &attributes = pipelineDesc.vertexInputState.vertexAttributeDescriptions;
+            const bool matched = std::any_of(attributes.begin(), attributes.end(), [&input](const VkVertexInputAttributeDescription &attribute) {
+                return attribute.location == input.location && attribute.format == input.format;
+            });
+            if (matched == false)
+            {
+                std::cout << "The quad vertex format doesn't match the vertex shader input at location " << input.location << ".\n";
+                return false;
+            }
+        }
+    }
 
     // Define blend states
 
@@ -271,26 +287,36 @@ bool Quad::createGraphicsPipeline(VkDevice device,
     };
 
     // Blending states list - one per attachment
-    std::vector<VkPipelineColorBlendAttachmentState> blendAttachmentStates = {
+    pipelineDesc.colorBlendStates = {
         colorBlendAttachmentState
     };
 
     // Dynamic states
-    std::vector<VkDynamicState> dynamicStates = {
+    pipelineDesc.dynamicStates = {
         VK_DYNAMIC_STATE_VIEWPORT
     };
 
-    // Initialize graphics pipeline
-    if (m_pipeline.init(device, 
-        width, height, 
-        vertexInputState, 
-        depthStencilState, 
-        shaderStagesInfo,
-        blendAttachmentStates,
-        dynamicStates,
-        VK_SAMPLE_COUNT_1_BIT,
-        m_pipelineLayout,
-        renderPass) == false) return false;
+    // Specialized fragment stage - the constants are part of the pipeline state
+    VulkanSpecializationConstants fragmentConstants;
+    fragmentConstants.set(FragmentConstantBrightness, m_brightness);
+    for (const VulkanShader *shader : shaders)
+    {
+        if (shader->reflection().stage() == VK_SHADER_STAGE_FRAGMENT_BIT)
+            pipelineDesc.shaderStagesInfo.push_back(shader->shaderStageInfo(fragmentConstants));
+        else
+            pipelineDesc.shaderStagesInfo.push_back(shader->shaderStageInfo());
+    }
+    pipelineDesc.sampleCount = VK_SAMPLE_COUNT_1_BIT;
+    pipelineDesc.pipelineLayout = m_pipelineLayout;
+    pipelineDesc.renderPass = renderPass.get();
+    pipelineDesc.renderPassCompatibilityKey = renderPass.compatibilityKey();
+
+    // Get the graphics pipeline - only compiled if no other object uses the same state.
+    // Compiled in the background so init doesn't block on it.
+    m_pipeline = pipelineRegistry.acquireAsync(pipelineDesc);
+    if (m_pipeline.valid() == false)
+        return false;
+    m_pipelineRegistry = &pipelineRegistry;
 
     // Success
     return true;
@@ -2,22 +2,33 @@
 
 #include "VertexFormat.h"
 
+#include <chrono>
+
 VulkanApp::VulkanApp()
 {
     
 }
 
-bool VulkanApp::init(uint32_t width, uint32_t height)
+bool VulkanApp::init(uint32_t width, uint32_t height, bool headless)
 {
+    const auto startupStart = std::chrono::steady_clock::now();
+    m_headless = headless;
+
     // Window initialization
-    if (m_window.init("Vulkan", width, height) == 0) return false;
+    if (m_headless == false)
+    {
+        if (m_window.init("Vulkan", width, height) == 0) return false;
+    }
 
     // Vulkan engine
     m_vulkanEngine.printVersion();
     unsigned int appVersionMajor = 1;
     unsigned int appVersionMinor = 0;
     // Init vulkan engine
-    if (m_vulkanEngine.initVulkan(m_window, "VulkanEngine", appVersionMajor, appVersionMinor) == false)
+    const bool engineInitialized = m_headless ? 
+        m_vulkanEngine.initVulkanHeadless(width, height, "VulkanEngine", appVersionMajor, appVersionMinor) :
+        m_vulkanEngine.initVulkan(m_window, "VulkanEngine", appVersionMajor, appVersionMinor);
+    if (engineInitialized == false)
     {
         std::cout << "Failed to init Vulkan. Closing app... \n";
         return false;
@@ -31,17 +42,23 @@ bool VulkanApp::init(uint32_t width, uint32_t height)
     m_quad = std::make_unique<Quad>(m_vulkanEngine.device());
     if (m_quad->init(m_vulkanEngine,
         width, height,
-        { m_quadVertexShader.shaderStageInfo(), m_quadFragmentShader.shaderStageInfo() }) == false)
+        { &m_quadVertexShader, &m_quadFragmentShader }) == false)
     {
         std::cout << "Failed to initialize quad.\n";
         return false;
     }
 
-    // Register renderable objects
+    // Register renderable objects - their commands are recorded every frame
     m_vulkanEngine.addRenderable(*m_quad);
 
-    // Setup command buffers
-    if (m_vulkanEngine.setupCommandBuffers() == 0) return false;
+    // Compare with the previous run to see what the pipeline cache saves - the startup
+    // includes the compilation of the pipelines
+    if (m_quad->waitForPipeline() == false)
+        return false;
+    const bool warmPipelineCache = m_vulkanEngine.pipelineCache().state() == VulkanPipelineCacheState::Warm;
+    std::cout << "\nStartup took " 
+        << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupStart).count() << " ms ("
+        << (warmPipelineCache ? "warm" : "cold") << " pipeline cache).\n";
 
     // Success
     return true;
@@ -52,17 +69,45 @@ void VulkanApp::update(double dt)
     m_quad->update(dt, m_vulkanEngine.frameIndex());
 }
 
-void VulkanApp::run()
+void VulkanApp::run(uint32_t frameCount)
 {
     double dt = 0.0f;
+    CPU_PROFILE_THREAD("Main");
 
-    while (!glfwWindowShouldClose(m_window.get()))
+    if (m_headless)
     {
-        glfwPollEvents();
-        RenderInstance instance(m_vulkanEngine);
-
-        // Rendering
-        update(dt);
+        // Same frame loop without the window events
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            // Outlives the render instance - the frame zone covers endRender too
+            CPU_PROFILE_SCOPE("Frame");
+            RenderInstance instance(m_vulkanEngine);
+
+            // Rendering
+            {
+                CPU_PROFILE_SCOPE("Update");
+                update(dt);
+            }
+        }
+    }
+    else
+    {
+        while (!glfwWindowShouldClose(m_window.get()))
+        {
+            // Outlives the render instance - the frame zone covers endRender too
+            CPU_PROFILE_SCOPE("Frame");
+            {
+                CPU_PROFILE_SCOPE("Poll events");
+                glfwPollEvents();
+            }
+            RenderInstance instance(m_vulkanEngine);
+
+            // Rendering
+            {
+                CPU_PROFILE_SCOPE("Update");
+                update(dt);
+            }
+        }
     }
 
     // Wait for the queue to finish executing commands before going further
@@ -71,13 +116,15 @@ void VulkanApp::run()
 
 void VulkanApp::cleanup()
 {
+    // Renderables first - their pipelines may still be compiling from the shader modules
+    m_quad->cleanup();
+
     // Shaders
     m_quadVertexShader.cleanup(m_vulkanEngine.device());
     m_quadFragmentShader.cleanup(m_vulkanEngine.device());
 
-    m_quad->cleanup();
-
     m_vulkanEngine.cleanup();
 
-    m_window.cleanup();
+    if (m_headless == false)
+        m_window.cleanup();
 }
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include "BenchmarkApp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    void writeStatistics(std::ostream &stream, const char *name, const BenchmarkStatistics &statistics)
+    {
+        stream << "  \"" << name << "\": { \"samples\": " << statistics.sampleCount
+            << ", \"min\": " << statistics.minMilliseconds
+            << ", \"avg\": " << statistics.avgMilliseconds
+            << ", \"p50\": " << statistics.p50Milliseconds
+            << ", \"p90\": " << statistics.p90Milliseconds
+            << ", \"p99\": " << statistics.p99Milliseconds
+            << ", \"max\": " << statistics.maxMilliseconds << " }";
+    }
+}
+
+bool BenchmarkApp::init(const BenchmarkConfig &config)
+{
+    m_config = config;
+
+    if (m_config.headless == false)
+    {
+        if (m_window.init("Vulkan benchmark", m_config.width, m_config.height) == 0) return false;
+    }
+
+    // Every object writes its uniform block every frame with dynamic uniforms
+    if (m_config.scene.dynamicUniforms)
+        m_vulkanEngine.setUniformRingFrameSize((static_cast<VkDeviceSize>(m_config.scene.objectCount) + 1) * 256 + 64 * 1024);
+    // Two timestamps per draw would be measured along with the draws
+    m_vulkanEngine.enableRenderableProfiling(false);
+
+    m_vulkanEngine.printVersion();
+    const bool engineInitialized = m_config.headless ?
+        m_vulkanEngine.initVulkanHeadless(m_config.width, m_config.height, "VulkanEngineBenchmark", 1, 0) :
+        m_vulkanEngine.initVulkan(m_window, "VulkanEngineBenchmark", 1, 0);
+    if (engineInitialized == false)
+    {
+        std::cout << "Failed to init Vulkan. Closing benchmark... \n";
+        return false;
+    }
+
+    // Shaders
+    if (m_vertexShader.init(m_vulkanEngine.device(), "./shaders/binaries/benchmark.vert.spv", VK_SHADER_STAGE_VERTEX_BIT) == 0) return false;
+    if (m_fragmentShader.init(m_vulkanEngine.device(), "./shaders/binaries/benchmark.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT) == 0) return false;
+
+    // Scene - adds its objects to the engine
+    if (m_scene.init(m_vulkanEngine, m_config.scene, m_config.width, m_config.height, { &m_vertexShader, &m_fragmentShader }) == false)
+    {
+        std::cout << "Failed to initialize the benchmark scene.\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
+
+void BenchmarkApp::cleanup()
+{
+    // Objects first - their pipelines may still be compiling from the shader modules
+    m_scene.cleanup();
+
+    m_vertexShader.cleanup(m_vulkanEngine.device());
+    m_fragmentShader.cleanup(m_vulkanEngine.device());
+
+    m_vulkanEngine.cleanup();
+
+    if (m_config.headless == false)
+        m_window.cleanup();
+}
+
+bool BenchmarkApp::run()
+{
+    // Fixed step - the scene doesn't depend on the frame rate
+    const double dt = 1.0 / 60.0;
+    CPU_PROFILE_THREAD("Main");
+
+    // Nothing compiles during the measured frames
+    if (m_scene.waitForPipelines() == false)
+        return false;
+    for (uint32_t frame = 0; frame < m_config.warmupFrames; ++frame)
+        renderFrame(dt);
+
+    m_frameMilliseconds.reserve(m_config.frameCount);
+    m_waitMilliseconds.reserve(m_config.frameCount);
+    m_recordMilliseconds.reserve(m_config.frameCount);
+    m_submitMilliseconds.reserve(m_config.frameCount);
+    m_gpuMilliseconds.reserve(m_config.frameCount);
+
+    // Vulkan calls of the measured frames only
+    VulkanApiStats &apiStats = VulkanApiStats::getInstance();
+    if (apiStats.recording())
+        apiStats.start();
+
+    VulkanGpuProfiler &gpuProfiler = m_vulkanEngine.gpuProfiler();
+    uint64_t collectedFrameCount = gpuProfiler.collectedFrameCount();
+    uint64_t frameStart = CpuProfiler::now();
+    for (uint32_t frame = 0; frame < m_config.frameCount; ++frame)
+    {
+        if (m_config.headless == false && glfwWindowShouldClose(m_window.get()))
+            break;
+
+        renderFrame(dt);
+
+        // Start to start - includes the wait for the frame in flight
+        const uint64_t frameEnd = CpuProfiler::now();
+        m_frameMilliseconds.push_back((frameEnd - frameStart) / 1000000.0);
+        frameStart = frameEnd;
+
+        const VulkanFrameTimings &frameTimings = m_vulkanEngine.frameTimings();
+        m_waitMilliseconds.push_back(frameTimings.waitMilliseconds);
+        m_recordMilliseconds.push_back(frameTimings.recordMilliseconds);
+        m_submitMilliseconds.push_back(frameTimings.submitMilliseconds);
+
+        // Results of an older frame, read without waiting in beginRender
+        if (gpuProfiler.enabled() && gpuProfiler.collectedFrameCount() != collectedFrameCount)
+        {
+            collectedFrameCount = gpuProfiler.collectedFrameCount();
+            m_gpuMilliseconds.push_back(gpuProfiler.lastMilliseconds(m_vulkanEngine.gpuFrameScope()));
+        }
+    }
+
+    vkDeviceWaitIdle(m_vulkanEngine.device());
+
+    return writeResults();
+}
+
+void BenchmarkApp::renderFrame(double dt)
+{
+    CPU_PROFILE_SCOPE("Frame");
+    if (m_config.headless == false)
+        glfwPollEvents();
+
+    RenderInstance instance(m_vulkanEngine);
+    m_scene.update(dt, m_vulkanEngine.frameIndex());
+}
+
+bool BenchmarkApp::writeResults() const
+{
+    std::ofstream file(m_config.outputFilename);
+    if (file.is_open() == false)
+    {
+        std::cout << "Failed to open " << m_config.outputFilename << " to write the benchmark results.\n";
+        return false;
+    }
+
+    const BenchmarkSceneDesc &scene = m_scene.desc();
+    const BenchmarkStatistics frameStatistics = computeStatistics(m_frameMilliseconds);
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n";
+    file << "  \"device\": \"" << m_vulkanEngine.physicalDevice().getDeviceProperties().deviceName << "\",\n";
+    file << "  \"headless\": " << (m_config.headless ? "true" : "false") << ",\n";
+    file << "  \"width\": " << m_config.width << ",\n";
+    file << "  \"height\": " << m_config.height << ",\n";
+    file << "  \"scene\": { \"objects\": " << scene.objectCount
+        << ", \"pipelines\": " << scene.pipelineCount
+        << ", \"textures\": " << scene.textureCount
+        << ", \"textureSize\": " << scene.textureSize
+        << ", \"dynamicUniforms\": " << (scene.dynamicUniforms ? "true" : "false")
+        << ", \"seed\": " << scene.seed << " },\n";
+    file << "  \"warmupFrames\": " << m_config.warmupFrames << ",\n";
+    file << "  \"frames\": " << m_frameMilliseconds.size() << ",\n";
+    writeStatistics(file, "frameMs", frameStatistics);
+    file << ",\n";
+    writeStatistics(file, "waitMs", computeStatistics(m_waitMilliseconds));
+    file << ",\n";
+    writeStatistics(file, "recordMs", computeStatistics(m_recordMilliseconds));
+    file << ",\n";
+    writeStatistics(file, "submitMs", computeStatistics(m_submitMilliseconds));
+    file << ",\n";
+    writeStatistics(file, "gpuMs", computeStatistics(m_gpuMilliseconds));
+    // Average calls and CPU microseconds per frame of every entry point called
+    const VulkanApiStats &apiStats = VulkanApiStats::getInstance();
+    if (apiStats.recording() && apiStats.frameCount() != 0)
+    {
+        const double apiFrameCount = static_cast<double>(apiStats.frameCount());
+        file << ",\n  \"vulkanApi\": {";
+        bool first = true;
+        for (uint32_t functionIndex = 0; functionIndex < VulkanApiStats::FunctionCount; ++functionIndex)
+        {
+            const VulkanApiFunction function = static_cast<VulkanApiFunction>(functionIndex);
+            const VulkanApiCallStats stats = apiStats.totalStats(function);
+            if (stats.callCount == 0)
+                continue;
+
+            file << (first ? "\n" : ",\n") << "    \"" << VulkanApiStats::functionName(function) << "\": { \"callsPerFrame\": "
+                << stats.callCount / apiFrameCount << ", \"usPerFrame\": " << stats.nanoseconds / apiFrameCount / 1000.0 << " }";
+            first = false;
+        }
+        file << "\n  }";
+    }
+    file << "\n}\n";
+
+    std::cout << "\nBenchmark: " << m_frameMilliseconds.size() << " frames, "
+        << frameStatistics.avgMilliseconds << " ms avg, "
+        << frameStatistics.p99Milliseconds << " ms p99 - results written to " << m_config.outputFilename << "\n";
+
+    return file.good();
+}
+
+BenchmarkStatistics BenchmarkApp::computeStatistics(std::vector<double> samples)
+{
+    BenchmarkStatistics statistics;
+    statistics.sampleCount = static_cast<uint32_t>(samples.size());
+    if (samples.empty())
+        return statistics;
+
+    std::sort(samples.begin(), samples.end());
+
+    double total = 0.0;
+    for (double sample : samples)
+        total += sample;
+
+    // Nearest rank
+    auto percentile = [&samples](double fraction) {
+        const size_t rank = static_cast<size_t>(std::ceil(samples.size() * fraction));
+        return samples[std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0)];
+    };
+
+    statistics.minMilliseconds = samples.front();
+    statistics.avgMilliseconds = total / samples.size();
+    statistics.p50Milliseconds = percentile(0.50);
+    statistics.p90Milliseconds = percentile(0.90);
+    statistics.p99Milliseconds = percentile(0.99);
+    statistics.maxMilliseconds = samples.back();
+
+    return statistics;
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "BenchmarkObject.h"
+#include "BenchmarkScene.h"
+
+#include <cmath>
+#include <iostream>
+
+BenchmarkObject::BenchmarkObject(BenchmarkScene &scene, uint32_t objectIndex, uint32_t pipelineIndex, uint32_t textureIndex, const glm::mat4 &model)
+    : m_scene(scene),
+    m_objectIndex(objectIndex),
+    m_pipelineIndex(pipelineIndex),
+    m_textureIndex(textureIndex)
+{
+    m_pushConstants.model = model;
+    m_uniformData.view = glm::mat4(1.0f);
+    // Orthographic, looking down -z - view depth [0, 1] maps to the depth range
+    m_uniformData.proj = glm::mat4(1.0f);
+    m_uniformData.proj[2][2] = -1.0f;
+    m_uniformData.tint = glm::vec4(1.0f);
+}
+
+bool BenchmarkObject::init(VulkanEngine &engine,
+    uint32_t width, uint32_t height,
+    const std::vector<const VulkanShader*> &shaders)
+{
+    m_width = width;
+    m_height = height;
+    m_pushConstantRanges = m_scene.pushConstantRanges();
+
+    // Descriptor set - lives as long as the engine descriptor allocator
+    if (engine.descriptorAllocator().allocate(m_scene.descriptorSetLayout(), m_descriptorSet) == false)
+        return false;
+
+    // Uniform block - the ring offset is picked every frame, the static element is written once
+    VulkanDescriptorInfo uniformBufferDescriptor = {};
+    if (m_scene.desc().dynamicUniforms)
+    {
+        m_uniformRing = &engine.uniformRing();
+        uniformBufferDescriptor.buffer = { m_uniformRing->get(), 0, sizeof(BenchmarkUniforms) };
+    }
+    else
+    {
+        if (m_scene.writeStaticUniforms(m_objectIndex, m_uniformData) == false)
+            return false;
+        const VulkanBuffer &staticUniforms = m_scene.staticUniforms();
+        uniformBufferDescriptor.buffer = { staticUniforms.get(), staticUniforms.elementOffset(m_objectIndex), sizeof(BenchmarkUniforms) };
+    }
+
+    VulkanDescriptorInfo textureDescriptor = {};
+    textureDescriptor.image = {
+        m_scene.sampler(),                              // sampler
+        m_scene.texture(m_textureIndex).view(),         // imageView
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL        // imageLayout
+    };
+
+    return engine.descriptorAllocator().write(m_descriptorSet, m_scene.descriptorSetLayout(), { uniformBufferDescriptor, textureDescriptor });
+}
+
+void BenchmarkObject::cleanup()
+{
+    // Everything else is shared and released by the scene
+    m_descriptorSet = VK_NULL_HANDLE;
+}
+
+void BenchmarkObject::render(VkCommandBuffer currentCommandBuffer) const
+{
+    const VkPipeline pipeline = m_scene.pipeline(m_pipelineIndex).get();
+    if (pipeline == VK_NULL_HANDLE)
+        return;
+
+    VkViewport viewport = {};
+    viewport.width = m_width;
+    viewport.height = m_height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(currentCommandBuffer, 0, 1, &viewport);
+
+    // Every object binds its whole state - the render list doesn't skip redundant binds
+    vkCmdBindPipeline(currentCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdBindDescriptorSets(currentCommandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        m_scene.pipelineLayout(),
+        0, 1, &m_descriptorSet,
+        1, &m_uniformDynamicOffset);
+    pushConstants(currentCommandBuffer, m_scene.pipelineLayout(), 0, sizeof(PushConstants), &m_pushConstants);
+
+    VkBuffer vertexBuffers[] = { m_scene.vertexBuffer().get() };
+    VkDeviceSize offsets[] = { 0 };
+    vkCmdBindVertexBuffers(currentCommandBuffer, 0, 1, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(currentCommandBuffer, m_scene.indexBuffer().get(), 0, VK_INDEX_TYPE_UINT16);
+    vkCmdDrawIndexed(currentCommandBuffer, m_scene.indexBuffer().elementCount(), 1, 0, 0, 0);
+}
+
+void BenchmarkObject::update(double dt, uint32_t frameIndex)
+{
+    if (m_uniformRing == nullptr)
+        return;
+
+    // Something changes every frame so the write can't be skipped
+    m_time += dt;
+    const float pulse = 0.75f + 0.25f * static_cast<float>(std::sin(m_time + m_objectIndex));
+    m_uniformData.tint = glm::vec4(pulse, pulse, pulse, 1.0f);
+    if (m_uniformRing->write(&m_uniformData, sizeof(BenchmarkUniforms), m_uniformDynamicOffset) == false)
+        std::cout << "Failed to update benchmark object uniform data.\n";
+}
+
+float BenchmarkObject::sortDepth() const
+{
+    const glm::vec4 viewPosition = m_uniformData.view * m_pushConstants.model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    return -viewPosition.z;
+}
\ No newline at end of file
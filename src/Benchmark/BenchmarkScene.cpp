@@ -0,0 +1,307 @@
+#include "BenchmarkScene.h"
+
+#include "VertexFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+bool BenchmarkScene::init(VulkanEngine &engine,
+    const BenchmarkSceneDesc &desc,
+    uint32_t width, uint32_t height,
+    const std::vector<const VulkanShader*> &shaders)
+{
+    m_desc = desc;
+    m_desc.pipelineCount = std::max(1u, m_desc.pipelineCount);
+    m_desc.textureCount = std::max(1u, m_desc.textureCount);
+    m_device = engine.device();
+
+    // Shared state
+    if (createPipelineLayout(engine.layoutCache(), shaders) == false) return false;
+    if (createPipelines(width, height, engine.renderPass(), shaders, engine.pipelineRegistry()) == false) return false;
+    if (createGeometry(engine) == false) return false;
+    if (createTextures(engine) == false) return false;
+    if (createSampler(engine.device()) == false) return false;
+
+    // Static uniform blocks - one aligned element per object, written by the objects
+    if (m_desc.dynamicUniforms == false && m_desc.objectCount > 0)
+    {
+        BenchmarkUniforms uniforms = {};
+        if (m_staticUniforms.init(engine.physicalDevice(),
+            engine.device(),
+            engine.memoryAllocator(),
+            sizeof(BenchmarkUniforms),
+            m_desc.objectCount,
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            &uniforms,
+            engine.uploadManager()) == false) return false;
+    }
+
+    // Objects on a grid covering the screen, at random depths, pipelines and textures
+    std::mt19937 random(m_desc.seed);
+    std::uniform_real_distribution<float> depthDistribution(0.1f, 0.9f);
+    std::uniform_int_distribution<uint32_t> pipelineDistribution(0, m_desc.pipelineCount - 1);
+    std::uniform_int_distribution<uint32_t> textureDistribution(0, m_desc.textureCount - 1);
+
+    const uint32_t columnCount = std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(m_desc.objectCount)))));
+    const float cellSize = 2.0f / columnCount;
+    m_objects.reserve(m_desc.objectCount);
+    for (uint32_t objectIndex = 0; objectIndex < m_desc.objectCount; ++objectIndex)
+    {
+        const float x = -1.0f + cellSize * (objectIndex % columnCount + 0.5f);
+        const float y = -1.0f + cellSize * (objectIndex / columnCount + 0.5f);
+        // Overlapping neighbours - the depth test and the sort order matter
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, -depthDistribution(random)));
+        model = glm::scale(model, glm::vec3(cellSize * 1.5f, cellSize * 1.5f, 1.0f));
+
+        const uint32_t pipelineIndex = pipelineDistribution(random);
+        const uint32_t textureIndex = textureDistribution(random);
+        m_objects.push_back(std::make_unique<BenchmarkObject>(*this, objectIndex, pipelineIndex, textureIndex, model));
+        if (m_objects.back()->init(engine, width, height, shaders) == false)
+        {
+            std::cout << "Failed to initialize benchmark object " << objectIndex << ".\n";
+            return false;
+        }
+        engine.addRenderable(*m_objects.back());
+    }
+
+    // Success
+    return true;
+}
+
+void BenchmarkScene::cleanup()
+{
+    for (auto &object : m_objects)
+        object->cleanup();
+    m_objects.clear();
+
+    // Pipelines - destroyed by the registry once nothing uses them
+    if (m_pipelineRegistry != nullptr)
+    {
+        for (auto &pipeline : m_pipelines)
+        {
+            m_pipelineRegistry->wait(pipeline);
+            m_pipelineRegistry->release(pipeline);
+        }
+    }
+    m_pipelines.clear();
+
+    m_vertexBuffer.cleanup(m_device);
+    m_indexBuffer.cleanup(m_device);
+    if (m_desc.dynamicUniforms == false && m_desc.objectCount > 0)
+        m_staticUniforms.cleanup(m_device);
+    for (auto &texture : m_textures)
+        texture.cleanup(m_device);
+    m_textures.clear();
+
+    if (m_sampler != VK_NULL_HANDLE)
+        vkDestroySampler(m_device, m_sampler, nullptr);
+    m_sampler = VK_NULL_HANDLE;
+}
+
+void BenchmarkScene::update(double dt, uint32_t frameIndex)
+{
+    for (auto &object : m_objects)
+        object->update(dt, frameIndex);
+}
+
+bool BenchmarkScene::waitForPipelines()
+{
+    for (const auto &pipeline : m_pipelines)
+    {
+        if (m_pipelineRegistry->wait(pipeline) == false)
+        {
+            std::cout << "Failed to compile a benchmark pipeline.\n";
+            return false;
+        }
+    }
+
+    // Success
+    return true;
+}
+
+bool BenchmarkScene::writeStaticUniforms(uint32_t objectIndex, const BenchmarkUniforms &uniforms)
+{
+    BenchmarkUniforms data = uniforms;
+    return m_staticUniforms.updateUniformData(m_device, objectIndex, &data, sizeof(BenchmarkUniforms));
+}
+
+bool BenchmarkScene::createPipelineLayout(VulkanLayoutCache &layoutCache, const std::vector<const VulkanShader*> &shaders)
+{
+    // Dynamic uniform buffer at binding 0 and the texture at binding 1 of set 0. Static uniforms
+    // are bound with a zero dynamic offset so both modes share the layouts and pipelines.
+    std::vector<const VulkanShaderReflection*> stages;
+    for (const VulkanShader *shader : shaders)
+        stages.push_back(&shader->reflection());
+
+    std::vector<VkDescriptorSetLayout> setLayouts;
+    if (layoutCache.getPipelineLayout(stages, m_pipelineLayout, setLayouts, m_pushConstantRanges) == false)
+    {
+        std::cout << "Failed to create the benchmark pipeline layout.\n";
+        return false;
+    }
+    if (setLayouts.empty())
+    {
+        std::cout << "The benchmark shaders don't declare any descriptor set.\n";
+        return false;
+    }
+    m_descriptorSetLayout = setLayouts[0];
+
+    // Success
+    return true;
+}
+
+bool BenchmarkScene::createPipelines(uint32_t width, uint32_t height,
+    const VulkanRenderPass &renderPass,
+    const std::vector<const VulkanShader*> &shaders,
+    VulkanPipelineRegistry &pipelineRegistry)
+{
+    m_pipelineRegistry = &pipelineRegistry;
+
+    VulkanPipelineDesc pipelineDesc = {};
+    pipelineDesc.width = width;
+    pipelineDesc.height = height;
+    pipelineDesc.depthStencilState = {};
+    pipelineDesc.vertexInputState.vertexBindingDescriptions = VertexPC::getBindingDescription();
+    pipelineDesc.vertexInputState.vertexAttributeDescriptions = VertexPC::getAttributeDescriptions();
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachmentState = {
+        VK_FALSE,                           // blendEnable
+        VK_BLEND_FACTOR_ONE,                // srcColorBlendFactor
+        VK_BLEND_FACTOR_ZERO,               // dstColorBlendFactor
+        VK_BLEND_OP_ADD,                    // colorBlendOp
+        VK_BLEND_FACTOR_ONE,                // srcAlphaBlendFactor
+        VK_BLEND_FACTOR_ZERO,               // dstAlphaBlendFactor
+        VK_BLEND_OP_ADD,                    // alphaBlendOp
+        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT   // colorWriteMask
+    };
+    pipelineDesc.colorBlendStates = { colorBlendAttachmentState };
+    pipelineDesc.dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT };
+    pipelineDesc.sampleCount = VK_SAMPLE_COUNT_1_BIT;
+    pipelineDesc.pipelineLayout = m_pipelineLayout;
+    pipelineDesc.renderPass = renderPass.get();
+    pipelineDesc.renderPassCompatibilityKey = renderPass.compatibilityKey();
+
+    // A different brightness constant per pipeline - every one is a distinct state in the registry
+    m_pipelines.resize(m_desc.pipelineCount);
+    for (uint32_t pipelineIndex = 0; pipelineIndex < m_desc.pipelineCount; ++pipelineIndex)
+    {
+        VulkanSpecializationConstants fragmentConstants;
+        fragmentConstants.set(FragmentConstantBrightness, 1.0f - 0.5f * pipelineIndex / m_desc.pipelineCount);
+
+        pipelineDesc.shaderStagesInfo.clear();
+        for (const VulkanShader *shader : shaders)
+        {
+            if (shader->reflection().stage() == VK_SHADER_STAGE_FRAGMENT_BIT)
+                pipelineDesc.shaderStagesInfo.push_back(shader->shaderStageInfo(fragmentConstants));
+            else
+                pipelineDesc.shaderStagesInfo.push_back(shader->shaderStageInfo());
+        }
+
+        m_pipelines[pipelineIndex] = pipelineRegistry.acquireAsync(pipelineDesc);
+        if (m_pipelines[pipelineIndex].valid() == false)
+            return false;
+    }
+
+    // Success
+    return true;
+}
+
+bool BenchmarkScene::createGeometry(VulkanEngine &engine)
+{
+    std::vector<VertexPC> vertices = {
+        {{-0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}},
+        {{0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}},
+        {{0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}},
+        {{-0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}}
+    };
+
+    std::vector<uint16_t> indices = {
+        0, 1, 2, 2, 3, 0
+    };
+
+    if (m_vertexBuffer.init(engine.physicalDevice(),
+        engine.device(),
+        engine.memoryAllocator(),
+        sizeof(vertices[0]),
+        vertices.size(),
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        reinterpret_cast<void*>(vertices.data()),
+        engine.uploadManager()) == 0) return false;
+    if (m_indexBuffer.init(engine.physicalDevice(),
+        engine.device(),
+        engine.memoryAllocator(),
+        sizeof(indices[0]),
+        indices.size(),
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        reinterpret_cast<void*>(indices.data()),
+        engine.uploadManager()) == 0) return false;
+
+    // Success
+    return true;
+}
+
+bool BenchmarkScene::createTextures(VulkanEngine &engine)
+{
+    const uint32_t textureSize = std::max(1u, m_desc.textureSize);
+    std::vector<uint32_t> texels(textureSize * textureSize);
+
+    m_textures.resize(m_desc.textureCount);
+    for (uint32_t textureIndex = 0; textureIndex < m_desc.textureCount; ++textureIndex)
+    {
+        VulkanImage &texture = m_textures[textureIndex];
+        if (texture.init(engine.memoryAllocator(),
+            engine.device(),
+            VK_IMAGE_TYPE_2D,
+            VK_FORMAT_R8G8B8A8_UNORM,
+            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            textureSize, textureSize, 1, 1, 1, VK_SAMPLE_COUNT_1_BIT,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == false) return false;
+        if (texture.createView(engine.device(), VK_IMAGE_ASPECT_COLOR_BIT) == false) return false;
+
+        // Checkerboard tinted by the texture index - RGBA8 little endian
+        const uint32_t tint = 0xFF000000 | ((textureIndex * 0x9E3779B9u) & 0x00FFFFFF) | 0x00404040;
+        for (uint32_t y = 0; y < textureSize; ++y)
+        {
+            for (uint32_t x = 0; x < textureSize; ++x)
+                texels[y * textureSize + x] = (((x / 8) + (y / 8)) % 2 == 0) ? tint : 0xFFFFFFFF;
+        }
+
+        // Sampled from the first frame - the upload batch is submitted ahead of it
+        VulkanUploadToken uploadToken = 0;
+        if (texture.upload(engine.uploadManager(),
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            texels.data(),
+            texels.size() * sizeof(uint32_t),
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            uploadToken) == false) return false;
+    }
+
+    // Success
+    return true;
+}
+
+bool BenchmarkScene::createSampler(VkDevice device)
+{
+    VkSamplerCreateInfo samplerCreateInfo = {};
+    samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+    samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+    samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerCreateInfo.maxLod = 0.0f;
+    if (vkCreateSampler(device, &samplerCreateInfo, nullptr, &m_sampler) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create the benchmark sampler.\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "CpuProfiler.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    void writeJsonString(std::ostream &stream, const std::string &value)
+    {
+        stream << '"';
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\')
+                stream << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                stream << ' ';
+            else
+                stream << c;
+        }
+        stream << '"';
+    }
+
+    // Microseconds since the start of the recording
+    double traceMicroseconds(uint64_t nanoseconds, uint64_t startNanoseconds)
+    {
+        return static_cast<double>(nanoseconds - startNanoseconds) / 1000.0;
+    }
+}
+
+thread_local CpuProfiler::ThreadBuffer *CpuProfiler::s_threadBuffer = nullptr;
+
+void CpuProfiler::start(uint32_t zonesPerThread)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Nobody writes while not recording
+    m_zonesPerThread = zonesPerThread;
+    for (auto &thread : m_threads)
+    {
+        thread->zones.resize(m_zonesPerThread);
+        thread->zoneCount.store(0, std::memory_order_relaxed);
+        thread->droppedCount.store(0, std::memory_order_relaxed);
+    }
+    m_startNanoseconds = now();
+    m_recording.store(true, std::memory_order_release);
+}
+
+void CpuProfiler::stop()
+{
+    m_recording.store(false, std::memory_order_release);
+}
+
+void CpuProfiler::setThreadName(const std::string &name)
+{
+    ThreadBuffer &buffer = threadBuffer();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    buffer.name = name;
+}
+
+void CpuProfiler::record(const char *name, uint64_t beginNanoseconds, uint64_t endNanoseconds)
+{
+    if (recording() == false)
+        return;
+
+    ThreadBuffer &buffer = threadBuffer();
+    const uint32_t zoneCount = buffer.zoneCount.load(std::memory_order_relaxed);
+    if (zoneCount >= buffer.zones.size())
+    {
+        buffer.droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.zones[zoneCount] = { name, beginNanoseconds, endNanoseconds };
+    buffer.zoneCount.store(zoneCount + 1, std::memory_order_release);
+}
+
+CpuProfiler::ThreadBuffer &CpuProfiler::threadBuffer()
+{
+    if (s_threadBuffer != nullptr)
+        return *s_threadBuffer;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threads.push_back(std::make_unique<ThreadBuffer>());
+    ThreadBuffer &buffer = *m_threads.back();
+    buffer.threadId = static_cast<uint32_t>(m_threads.size());
+    buffer.name = "Thread " + std::to_string(buffer.threadId);
+    // Threads named before the recording get their zones on start
+    if (recording())
+        buffer.zones.resize(m_zonesPerThread);
+    s_threadBuffer = &buffer;
+
+    return buffer;
+}
+
+bool CpuProfiler::exportChromeTrace(const std::string &filename,
+    const std::string &trackName,
+    const std::vector<CpuProfilerTrackEvent> &trackEvents) const
+{
+    std::ofstream file(filename);
+    if (file.is_open() == false)
+    {
+        std::cout << "Failed to open " << filename << " to write the CPU trace.\n";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Complete events ("X") - the viewer nests the zones of a thread by their time range
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"CPU\"}}";
+    file << std::fixed << std::setprecision(3);
+    for (const auto &thread : m_threads)
+    {
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->threadId << ",\"args\":{\"name\":";
+        writeJsonString(file, thread->name);
+        file << "}}";
+
+        const uint32_t zoneCount = thread->zoneCount.load(std::memory_order_acquire);
+        for (uint32_t zoneIndex = 0; zoneIndex < zoneCount; ++zoneIndex)
+        {
+            const Zone &zone = thread->zones[zoneIndex];
+            file << ",\n{\"name\":";
+            writeJsonString(file, zone.name);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->threadId
+                << ",\"ts\":" << traceMicroseconds(zone.beginNanoseconds, m_startNanoseconds)
+                << ",\"dur\":" << static_cast<double>(zone.endNanoseconds - zone.beginNanoseconds) / 1000.0 << "}";
+        }
+    }
+
+    if (trackEvents.empty() == false)
+    {
+        file << ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"tid\":0,\"args\":{\"name\":";
+        writeJsonString(file, trackName);
+        file << "}}";
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":1,\"args\":{\"name\":";
+        writeJsonString(file, trackName);
+        file << "}}";
+
+        for (const auto &event : trackEvents)
+        {
+            // Before the recording started
+            if (event.beginNanoseconds < m_startNanoseconds || event.endNanoseconds < event.beginNanoseconds)
+                continue;
+
+            file << ",\n{\"name\":";
+            writeJsonString(file, event.name);
+            file << ",\"ph\":\"X\",\"pid\":2,\"tid\":1"
+                << ",\"ts\":" << traceMicroseconds(event.beginNanoseconds, m_startNanoseconds)
+                << ",\"dur\":" << static_cast<double>(event.endNanoseconds - event.beginNanoseconds) / 1000.0 << "}";
+        }
+    }
+    file << "\n]}\n";
+
+    return file.good();
+}
+
+void CpuProfiler::printStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::cout << "\nCPU profiler: " << m_threads.size() << " threads\n";
+    for (const auto &thread : m_threads)
+    {
+        std::cout << "  " << thread->name << ": " << thread->zoneCount.load(std::memory_order_acquire) << " zones, "
+            << thread->droppedCount.load(std::memory_order_relaxed) << " dropped (buffer full)\n";
+    }
+}
\ No newline at end of file
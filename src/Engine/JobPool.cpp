@@ -0,0 +1,115 @@
+#include "JobPool.h"
+#include "CpuProfiler.h"
+
+#include <iostream>
+#include <system_error>
+
+bool JobPool::init(uint32_t workerCount)
+{
+    m_stop = false;
+
+    for (uint32_t workerIndex = 0; workerIndex < workerCount; ++workerIndex)
+    {
+        try
+        {
+            m_workers.emplace_back(&JobPool::workerLoop, this, workerIndex);
+        }
+        catch (const std::system_error &error)
+        {
+            std::cout << "Failed to start job pool worker thread: " << error.what() << "\n";
+            return false;
+        }
+    }
+
+    // Success
+    return true;
+}
+
+void JobPool::cleanup()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto &worker : m_workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    m_workers.clear();
+}
+
+void JobPool::parallelFor(uint32_t taskCount, const std::function<void(uint32_t)> &job)
+{
+    if (taskCount == 0)
+        return;
+
+    // Nothing to distribute
+    if (m_workers.empty() || taskCount == 1)
+    {
+        for (uint32_t taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+            job(taskIndex);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_taskCount = taskCount;
+        m_finishedTaskCount = 0;
+        m_nextTask = 0;
+        ++m_generation;
+    }
+    m_wakeCondition.notify_all();
+
+    // The calling thread works as well
+    const uint32_t finishedTaskCount = runTasks(job, taskCount);
+
+    // Wait for the tasks and for every worker to leave the loop, a late worker
+    // must not pick up a task index of the next loop with the job of this one
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finishedTaskCount += finishedTaskCount;
+    m_doneCondition.wait(lock, [this]() { return m_finishedTaskCount == m_taskCount && m_activeWorkerCount == 0; });
+    m_job = nullptr;
+}
+
+void JobPool::workerLoop(uint32_t workerIndex)
+{
+    CPU_PROFILE_THREAD("Job worker " + std::to_string(workerIndex));
+    uint64_t seenGeneration = 0;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_wakeCondition.wait(lock, [this, &seenGeneration]() { return m_stop || (m_job != nullptr && m_generation != seenGeneration); });
+        if (m_stop)
+            return;
+
+        seenGeneration = m_generation;
+        const std::function<void(uint32_t)> &job = *m_job;
+        const uint32_t taskCount = m_taskCount;
+        ++m_activeWorkerCount;
+
+        lock.unlock();
+        const uint32_t finishedTaskCount = runTasks(job, taskCount);
+        lock.lock();
+
+        m_finishedTaskCount += finishedTaskCount;
+        --m_activeWorkerCount;
+        if (m_finishedTaskCount == m_taskCount && m_activeWorkerCount == 0)
+            m_doneCondition.notify_all();
+    }
+}
+
+uint32_t JobPool::runTasks(const std::function<void(uint32_t)> &job, uint32_t taskCount)
+{
+    uint32_t finishedTaskCount = 0;
+    for (uint32_t taskIndex = m_nextTask.fetch_add(1); taskIndex < taskCount; taskIndex = m_nextTask.fetch_add(1))
+    {
+        job(taskIndex);
+        ++finishedTaskCount;
+    }
+    return finishedTaskCount;
+}
\ No newline at end of file
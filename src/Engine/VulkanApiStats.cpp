@@ -0,0 +1,183 @@
+#include "VulkanApiStats.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+namespace
+{
+    const char *const functionNames[] =
+    {
+#define VULKAN_API_NAME(function) #function,
+        VULKAN_API_FUNCTIONS(VULKAN_API_NAME)
+#undef VULKAN_API_NAME
+    };
+
+    VulkanApiCallStats difference(const VulkanApiCallStats &end, const VulkanApiCallStats &begin)
+    {
+        VulkanApiCallStats stats;
+        stats.callCount = end.callCount - begin.callCount;
+        stats.nanoseconds = end.nanoseconds - begin.nanoseconds;
+        return stats;
+    }
+
+    double milliseconds(uint64_t nanoseconds)
+    {
+        return static_cast<double>(nanoseconds) / 1e6;
+    }
+}
+
+thread_local VulkanApiStats::ThreadCounters *VulkanApiStats::s_threadCounters = nullptr;
+
+void VulkanApiStats::start(bool logFrames)
+{
+    // The counters keep growing - the stats start from their current sums
+    sumCounters(m_startTotals);
+    m_previousTotals = m_startTotals;
+    m_lastTotals = m_startTotals;
+    m_frameCount = 0;
+    m_logFrames = logFrames;
+    m_recording.store(true, std::memory_order_release);
+}
+
+void VulkanApiStats::stop()
+{
+    m_recording.store(false, std::memory_order_release);
+}
+
+void VulkanApiStats::endFrame()
+{
+    if (recording() == false)
+        return;
+
+    m_previousTotals.swap(m_lastTotals);
+    sumCounters(m_lastTotals);
+    ++m_frameCount;
+
+    if (m_logFrames == false)
+        return;
+
+    // Most called first - redundant state changes stand out
+    std::vector<uint32_t> order(FunctionCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return frameStats(static_cast<VulkanApiFunction>(a)).callCount > frameStats(static_cast<VulkanApiFunction>(b)).callCount;
+    });
+
+    // One line per frame - key=value pairs for the log collectors
+    const VulkanApiCallStats total = frameTotal();
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(3);
+    line << "vulkan_api frame=" << m_frameCount << " calls=" << total.callCount << " ms=" << milliseconds(total.nanoseconds);
+    for (uint32_t functionIndex : order)
+    {
+        const VulkanApiCallStats stats = frameStats(static_cast<VulkanApiFunction>(functionIndex));
+        if (stats.callCount == 0)
+            break;
+        line << " " << functionNames[functionIndex] << "=" << stats.callCount;
+    }
+    std::cout << line.str() << "\n";
+}
+
+void VulkanApiStats::record(VulkanApiFunction function, uint64_t nanoseconds)
+{
+    if (recording() == false)
+        return;
+
+    // Only this thread writes its counters - no read-modify-write needed
+    ThreadCounters &counters = threadCounters();
+    const uint32_t functionIndex = static_cast<uint32_t>(function);
+    counters.callCounts[functionIndex].store(counters.callCounts[functionIndex].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    counters.nanoseconds[functionIndex].store(counters.nanoseconds[functionIndex].load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+}
+
+VulkanApiCallStats VulkanApiStats::frameStats(VulkanApiFunction function) const
+{
+    const uint32_t functionIndex = static_cast<uint32_t>(function);
+    return difference(m_lastTotals[functionIndex], m_previousTotals[functionIndex]);
+}
+
+VulkanApiCallStats VulkanApiStats::totalStats(VulkanApiFunction function) const
+{
+    const uint32_t functionIndex = static_cast<uint32_t>(function);
+    return difference(m_lastTotals[functionIndex], m_startTotals[functionIndex]);
+}
+
+VulkanApiCallStats VulkanApiStats::frameTotal() const
+{
+    VulkanApiCallStats total;
+    for (uint32_t functionIndex = 0; functionIndex < FunctionCount; ++functionIndex)
+    {
+        const VulkanApiCallStats stats = frameStats(static_cast<VulkanApiFunction>(functionIndex));
+        total.callCount += stats.callCount;
+        total.nanoseconds += stats.nanoseconds;
+    }
+
+    return total;
+}
+
+const char *VulkanApiStats::functionName(VulkanApiFunction function)
+{
+    return functionNames[static_cast<uint32_t>(function)];
+}
+
+void VulkanApiStats::printStatistics() const
+{
+    std::vector<uint32_t> order(FunctionCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return totalStats(static_cast<VulkanApiFunction>(a)).nanoseconds > totalStats(static_cast<VulkanApiFunction>(b)).nanoseconds;
+    });
+
+    const double frameCount = static_cast<double>(std::max<uint64_t>(m_frameCount, 1));
+
+    std::cout << "\nVulkan API calls: " << m_frameCount << " frames\n";
+    std::cout << std::fixed << std::setprecision(3);
+    for (uint32_t functionIndex : order)
+    {
+        const VulkanApiCallStats stats = totalStats(static_cast<VulkanApiFunction>(functionIndex));
+        if (stats.callCount == 0)
+            continue;
+
+        std::cout << "  " << std::left << std::setw(44) << functionNames[functionIndex] << std::right
+            << std::setw(12) << stats.callCount << " calls"
+            << std::setw(12) << stats.callCount / frameCount << " per frame"
+            << std::setw(12) << milliseconds(stats.nanoseconds) << " ms"
+            << std::setw(12) << static_cast<double>(stats.nanoseconds) / stats.callCount << " ns per call\n";
+    }
+}
+
+VulkanApiStats::ThreadCounters &VulkanApiStats::threadCounters()
+{
+    if (s_threadCounters != nullptr)
+        return *s_threadCounters;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threads.push_back(std::make_unique<ThreadCounters>());
+    ThreadCounters &counters = *m_threads.back();
+    for (uint32_t functionIndex = 0; functionIndex < FunctionCount; ++functionIndex)
+    {
+        counters.callCounts[functionIndex].store(0, std::memory_order_relaxed);
+        counters.nanoseconds[functionIndex].store(0, std::memory_order_relaxed);
+    }
+    s_threadCounters = &counters;
+
+    return counters;
+}
+
+void VulkanApiStats::sumCounters(std::vector<VulkanApiCallStats> &totals) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    totals.assign(FunctionCount, VulkanApiCallStats());
+    for (const auto &thread : m_threads)
+    {
+        for (uint32_t functionIndex = 0; functionIndex < FunctionCount; ++functionIndex)
+        {
+            totals[functionIndex].callCount += thread->callCounts[functionIndex].load(std::memory_order_relaxed);
+            totals[functionIndex].nanoseconds += thread->nanoseconds[functionIndex].load(std::memory_order_relaxed);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "VulkanBarrierBatch.h"
+
+#include <assert.h>
+
+namespace
+{
+    // Accesses that modify memory - anything after them needs a barrier
+    const VkAccessFlags WriteAccessMask = VK_ACCESS_SHADER_WRITE_BIT |
+        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_TRANSFER_WRITE_BIT |
+        VK_ACCESS_HOST_WRITE_BIT |
+        VK_ACCESS_MEMORY_WRITE_BIT;
+
+    // Indexed by VulkanResourceUsage
+    const VulkanResourceAccess ResourceAccesses[] = {
+        // Undefined
+        { VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED },
+        // TransferSrc
+        { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL },
+        // TransferDst
+        { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL },
+        // VertexBuffer
+        { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED },
+        // IndexBuffer
+        { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED },
+        // IndirectBuffer
+        { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED },
+        // UniformBuffer
+        { VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED },
+        // GraphicsShaderRead
+        { VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+        // FragmentShaderRead
+        { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+        // ComputeShaderRead
+        { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+        // ComputeShaderWrite
+        { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL },
+        // ColorAttachment
+        { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+        // DepthStencilAttachment
+        { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL },
+        // DepthStencilRead
+        { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL },
+        // HostRead
+        { VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT, VK_IMAGE_LAYOUT_GENERAL },
+        // HostWrite
+        { VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL },
+        // Present - visibility is handled by the presentation engine
+        { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR },
+        // General
+        { VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL }
+    };
+    static_assert(sizeof(ResourceAccesses) / sizeof(ResourceAccesses[0]) == static_cast<size_t>(VulkanResourceUsage::General) + 1,
+        "Missing resource usage.");
+}
+
+const VulkanResourceAccess &resourceAccess(VulkanResourceUsage usage)
+{
+    return ResourceAccesses[static_cast<size_t>(usage)];
+}
+
+VulkanResourceState uploadedResourceState(VkImageLayout layout)
+{
+    // The last upload barrier makes the data visible to every stage of the graphics queue
+    VulkanResourceState state = {};
+    state.layout = layout;
+    state.readStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    state.readAccess = VK_ACCESS_MEMORY_READ_BIT;
+    return state;
+}
+
+bool VulkanBarrierBatch::image(VkImage image,
+    const VkImageSubresourceRange &range,
+    VulkanResourceState &state,
+    VulkanResourceUsage usage,
+    uint32_t queueFamily)
+{
+    assert(range.levelCount != VK_REMAINING_MIP_LEVELS && range.layerCount != VK_REMAINING_ARRAY_LAYERS && "Image barriers need explicit ranges.");
+
+    Dependency dependency = {};
+    if (resolve(state, usage, queueFamily, true, dependency) == false)
+        return false;
+
+    VkImageMemoryBarrier imageBarrier = {};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask = dependency.srcAccess;
+    imageBarrier.dstAccessMask = dependency.dstAccess;
+    imageBarrier.oldLayout = dependency.oldLayout;
+    imageBarrier.newLayout = dependency.newLayout;
+    imageBarrier.srcQueueFamilyIndex = dependency.srcQueueFamily;
+    imageBarrier.dstQueueFamilyIndex = dependency.dstQueueFamily;
+    imageBarrier.image = image;
+    imageBarrier.subresourceRange = range;
+
+    m_srcStages |= dependency.srcStages;
+    m_dstStages |= dependency.dstStages;
+    if (m_imageBarriers.empty() || merge(m_imageBarriers.back(), imageBarrier) == false)
+    {
+        m_imageBarriers.push_back(imageBarrier);
+    }
+    else
+    {
+        // The grown barrier may now cover the same mip levels as the previous layers - merge it into them
+        while (m_imageBarriers.size() > 1 && merge(m_imageBarriers[m_imageBarriers.size() - 2], m_imageBarriers.back()))
+            m_imageBarriers.pop_back();
+    }
+
+    return true;
+}
+
+bool VulkanBarrierBatch::buffer(VkBuffer buffer,
+    VkDeviceSize offset,
+    VkDeviceSize size,
+    VulkanResourceState &state,
+    VulkanResourceUsage usage,
+    uint32_t queueFamily)
+{
+    Dependency dependency = {};
+    if (resolve(state, usage, queueFamily, false, dependency) == false)
+        return false;
+
+    VkBufferMemoryBarrier bufferBarrier = {};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = dependency.srcAccess;
+    bufferBarrier.dstAccessMask = dependency.dstAccess;
+    bufferBarrier.srcQueueFamilyIndex = dependency.srcQueueFamily;
+    bufferBarrier.dstQueueFamilyIndex = dependency.dstQueueFamily;
+    bufferBarrier.buffer = buffer;
+    bufferBarrier.offset = offset;
+    bufferBarrier.size = size;
+
+    m_srcStages |= dependency.srcStages;
+    m_dstStages |= dependency.dstStages;
+    m_bufferBarriers.push_back(bufferBarrier);
+
+    return true;
+}
+
+void VulkanBarrierBatch::flush(VkCommandBuffer commandBuffer)
+{
+    if (empty())
+        return;
+
+    // One call for everything - the stages are the union of the stages of the barriers
+    vkCmdPipelineBarrier(commandBuffer,
+        m_srcStages, m_dstStages,
+        0, 0, nullptr,
+        static_cast<uint32_t>(m_bufferBarriers.size()), m_bufferBarriers.data(),
+        static_cast<uint32_t>(m_imageBarriers.size()), m_imageBarriers.data());
+
+    m_srcStages = 0;
+    m_dstStages = 0;
+    m_imageBarriers.clear();
+    m_bufferBarriers.clear();
+}
+
+bool VulkanBarrierBatch::resolve(VulkanResourceState &state, VulkanResourceUsage usage, uint32_t queueFamily, bool isImage, Dependency &dependency)
+{
+    const VulkanResourceAccess &next = resourceAccess(usage);
+
+    // Discarding the contents only forgets the layout, later accesses still wait for the previous ones
+    if (usage == VulkanResourceUsage::Undefined)
+    {
+        state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        return false;
+    }
+
+    const VkImageLayout newLayout = isImage ? next.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+    const bool layoutChange = isImage && newLayout != state.layout;
+    const bool ownershipChange = queueFamily != VK_QUEUE_FAMILY_IGNORED &&
+        state.queueFamily != VK_QUEUE_FAMILY_IGNORED &&
+        queueFamily != state.queueFamily;
+    const bool writes = (next.access & WriteAccessMask) != 0;
+
+    dependency.oldLayout = state.layout;
+    dependency.newLayout = newLayout;
+    dependency.srcQueueFamily = ownershipChange ? state.queueFamily : VK_QUEUE_FAMILY_IGNORED;
+    dependency.dstQueueFamily = ownershipChange ? queueFamily : VK_QUEUE_FAMILY_IGNORED;
+    dependency.dstStages = next.stages;
+    dependency.dstAccess = next.access;
+    if (queueFamily != VK_QUEUE_FAMILY_IGNORED)
+        state.queueFamily = queueFamily;
+
+    if (writes || layoutChange || ownershipChange)
+    {
+        // Wait for the last write and for every read after it
+        dependency.srcStages = state.writeStages | state.readStages;
+        dependency.srcAccess = state.writeAccess;
+
+        state.layout = newLayout;
+        if (writes)
+        {
+            state.writeStages = next.stages;
+            state.writeAccess = next.access & WriteAccessMask;
+            state.readStages = 0;
+            state.readAccess = 0;
+        }
+        else
+        {
+            // The layout transition happens before the reads
+            state.writeStages = next.stages;
+            state.writeAccess = 0;
+            state.readStages = next.stages;
+            state.readAccess = next.access;
+        }
+
+        // First access of the resource
+        if (dependency.srcStages == 0)
+        {
+            if (layoutChange == false && ownershipChange == false)
+                return false;
+            dependency.srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        }
+        return true;
+    }
+
+    // Read after read - only new readers need to see the last write
+    const bool alreadyVisible = (next.stages & ~state.readStages) == 0 && (next.access & ~state.readAccess) == 0;
+    state.readStages |= next.stages;
+    state.readAccess |= next.access;
+    if (alreadyVisible || state.writeStages == 0)
+        return false;
+
+    dependency.srcStages = state.writeStages;
+    dependency.srcAccess = state.writeAccess;
+    return true;
+}
+
+bool VulkanBarrierBatch::merge(VkImageMemoryBarrier &barrier, const VkImageMemoryBarrier &next)
+{
+    if (barrier.image != next.image ||
+        barrier.srcAccessMask != next.srcAccessMask ||
+        barrier.dstAccessMask != next.dstAccessMask ||
+        barrier.oldLayout != next.oldLayout ||
+        barrier.newLayout != next.newLayout ||
+        barrier.srcQueueFamilyIndex != next.srcQueueFamilyIndex ||
+        barrier.dstQueueFamilyIndex != next.dstQueueFamilyIndex ||
+        barrier.subresourceRange.aspectMask != next.subresourceRange.aspectMask)
+        return false;
+
+    VkImageSubresourceRange &range = barrier.subresourceRange;
+    const VkImageSubresourceRange &nextRange = next.subresourceRange;
+
+    // Next mip levels of the same layers
+    if (range.baseArrayLayer == nextRange.baseArrayLayer &&
+        range.layerCount == nextRange.layerCount &&
+        range.baseMipLevel + range.levelCount == nextRange.baseMipLevel)
+    {
+        range.levelCount += nextRange.levelCount;
+        return true;
+    }
+    // Next array layers with the same mip levels
+    if (range.baseMipLevel == nextRange.baseMipLevel &&
+        range.levelCount == nextRange.levelCount &&
+        range.baseArrayLayer + range.layerCount == nextRange.baseArrayLayer)
+    {
+        range.layerCount += nextRange.layerCount;
+        return true;
+    }
+
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,322 @@
+#include "VulkanBindlessHeap.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    const VkDescriptorType BindlessDescriptorTypes[] = {
+        VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,       // VulkanBindlessType::SampledImage
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,      // VulkanBindlessType::StorageBuffer
+        VK_DESCRIPTOR_TYPE_SAMPLER              // VulkanBindlessType::Sampler
+    };
+}
+
+bool VulkanBindlessHeap::init(VkDevice device,
+    const VulkanPhysicalDevice &physicalDevice,
+    VulkanLayoutCache &layoutCache,
+    VulkanTimeline &graphicsTimeline,
+    uint32_t maxSampledImages,
+    uint32_t maxStorageBuffers,
+    uint32_t maxSamplers)
+{
+    assert(physicalDevice.supportsDescriptorIndexing() && "The bindless heap needs descriptor indexing.");
+
+    m_device = device;
+    m_graphicsTimeline = &graphicsTimeline;
+
+    // Every array is read by every stage so the per stage limits apply to the whole array
+    const VkPhysicalDeviceDescriptorIndexingPropertiesEXT &limits = physicalDevice.getDescriptorIndexingProperties();
+    maxSampledImages = std::min({ maxSampledImages, limits.maxDescriptorSetUpdateAfterBindSampledImages, limits.maxPerStageDescriptorUpdateAfterBindSampledImages });
+    maxStorageBuffers = std::min({ maxStorageBuffers, limits.maxDescriptorSetUpdateAfterBindStorageBuffers, limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+    maxSamplers = std::min({ maxSamplers, limits.maxDescriptorSetUpdateAfterBindSamplers, limits.maxPerStageDescriptorUpdateAfterBindSamplers });
+    // Images and buffers share the per stage resource budget
+    const uint32_t resourceBudget = std::min(limits.maxPerStageUpdateAfterBindResources, limits.maxUpdateAfterBindDescriptorsInAllPools - maxSamplers);
+    if (maxSampledImages + maxStorageBuffers > resourceBudget)
+    {
+        maxSampledImages = std::min(maxSampledImages, resourceBudget / 2);
+        maxStorageBuffers = std::min(maxStorageBuffers, resourceBudget - maxSampledImages);
+    }
+    m_slots[static_cast<uint32_t>(VulkanBindlessType::SampledImage)].capacity = maxSampledImages;
+    m_slots[static_cast<uint32_t>(VulkanBindlessType::StorageBuffer)].capacity = maxStorageBuffers;
+    m_slots[static_cast<uint32_t>(VulkanBindlessType::Sampler)].capacity = maxSamplers;
+    if (maxSampledImages == 0 || maxStorageBuffers == 0 || maxSamplers == 0)
+    {
+        std::cout << "The device limits leave no room for the bindless heap.\n";
+        return false;
+    }
+
+    if (createSetLayout(device) == false) return false;
+    if (createDescriptorSet(device) == false) return false;
+
+    // One layout for every bindless pipeline - the push constants hold the indices of the draw
+    const VkPushConstantRange pushConstantRange = {
+        VK_SHADER_STAGE_ALL,                    // stageFlags
+        0,                                      // offset
+        PushConstantSize                        // size
+    };
+    m_pipelineLayout = layoutCache.getPipelineLayout({ m_setLayout }, { pushConstantRange });
+    if (m_pipelineLayout == VK_NULL_HANDLE)
+        return false;
+
+    if (createDefaultSampler(device) == false) return false;
+    if (registerSampler(m_defaultSampler) != DefaultSamplerIndex)
+        return false;
+
+    // Success
+    return true;
+}
+
+void VulkanBindlessHeap::cleanup(VkDevice device)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Destroying the pool frees the set
+    if (m_descriptorPool != VK_NULL_HANDLE)
+        vkDestroyDescriptorPool(device, m_descriptorPool, nullptr);
+    m_descriptorPool = VK_NULL_HANDLE;
+    m_descriptorSet = VK_NULL_HANDLE;
+    if (m_setLayout != VK_NULL_HANDLE)
+        vkDestroyDescriptorSetLayout(device, m_setLayout, nullptr);
+    m_setLayout = VK_NULL_HANDLE;
+    if (m_defaultSampler != VK_NULL_HANDLE)
+        vkDestroySampler(device, m_defaultSampler, nullptr);
+    m_defaultSampler = VK_NULL_HANDLE;
+    m_pipelineLayout = VK_NULL_HANDLE;
+
+    for (auto &slots : m_slots)
+        slots = Slots();
+    m_retiredIndices.clear();
+}
+
+uint32_t VulkanBindlessHeap::registerImage(VkImageView imageView, VkImageLayout imageLayout)
+{
+    const uint32_t index = acquireIndex(VulkanBindlessType::SampledImage);
+    if (index == InvalidIndex)
+        return InvalidIndex;
+
+    const VkDescriptorImageInfo imageInfo = {
+        VK_NULL_HANDLE,                         // sampler - comes from the sampler array
+        imageView,                              // imageView
+        imageLayout                             // imageLayout
+    };
+    writeDescriptor(VulkanBindlessType::SampledImage, index, &imageInfo, nullptr);
+    return index;
+}
+
+uint32_t VulkanBindlessHeap::registerBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    const uint32_t index = acquireIndex(VulkanBindlessType::StorageBuffer);
+    if (index == InvalidIndex)
+        return InvalidIndex;
+
+    const VkDescriptorBufferInfo bufferInfo = {
+        buffer,                                 // buffer
+        offset,                                 // offset
+        range                                   // range
+    };
+    writeDescriptor(VulkanBindlessType::StorageBuffer, index, nullptr, &bufferInfo);
+    return index;
+}
+
+uint32_t VulkanBindlessHeap::registerSampler(VkSampler sampler)
+{
+    const uint32_t index = acquireIndex(VulkanBindlessType::Sampler);
+    if (index == InvalidIndex)
+        return InvalidIndex;
+
+    const VkDescriptorImageInfo imageInfo = {
+        sampler,                                // sampler
+        VK_NULL_HANDLE,                         // imageView
+        VK_IMAGE_LAYOUT_UNDEFINED               // imageLayout
+    };
+    writeDescriptor(VulkanBindlessType::Sampler, index, &imageInfo, nullptr);
+    return index;
+}
+
+void VulkanBindlessHeap::release(VulkanBindlessType type, uint32_t index)
+{
+    if (index == InvalidIndex)
+        return;
+    assert(index < m_slots[static_cast<uint32_t>(type)].nextIndex && "Index not allocated by the bindless heap.");
+
+    // The stale descriptor is left in place - partially bound arrays only need the indices the shaders read
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_retiredIndices.push_back({ type, index, m_graphicsTimeline->lastSubmittedValue() });
+    --m_slots[static_cast<uint32_t>(type)].liveCount;
+}
+
+void VulkanBindlessHeap::collectGarbage()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto retired = std::remove_if(m_retiredIndices.begin(), m_retiredIndices.end(), [this](const RetiredIndex &retiredIndex) {
+        if (m_graphicsTimeline->hasCompleted(retiredIndex.retireValue) == false)
+            return false;
+        m_slots[static_cast<uint32_t>(retiredIndex.type)].freeIndices.push_back(retiredIndex.index);
+        return true;
+    });
+    m_retiredIndices.erase(retired, m_retiredIndices.end());
+}
+
+void VulkanBindlessHeap::bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint) const
+{
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, m_pipelineLayout, 0, 1, &m_descriptorSet, 0, nullptr);
+}
+
+void VulkanBindlessHeap::printStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const Slots &images = m_slots[static_cast<uint32_t>(VulkanBindlessType::SampledImage)];
+    const Slots &buffers = m_slots[static_cast<uint32_t>(VulkanBindlessType::StorageBuffer)];
+    const Slots &samplers = m_slots[static_cast<uint32_t>(VulkanBindlessType::Sampler)];
+    std::cout << "\nBindless heap: " << images.peakCount << "/" << images.capacity << " images, "
+        << buffers.peakCount << "/" << buffers.capacity << " buffers, "
+        << samplers.peakCount << "/" << samplers.capacity << " samplers at peak\n";
+}
+
+uint32_t VulkanBindlessHeap::acquireIndex(VulkanBindlessType type)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Slots &slots = m_slots[static_cast<uint32_t>(type)];
+    uint32_t index = InvalidIndex;
+    if (slots.freeIndices.empty() == false)
+    {
+        index = slots.freeIndices.back();
+        slots.freeIndices.pop_back();
+    }
+    else if (slots.nextIndex < slots.capacity)
+    {
+        index = slots.nextIndex++;
+    }
+    else
+    {
+        std::cout << "The bindless heap is full (binding " << static_cast<uint32_t>(type) << ").\n";
+        return InvalidIndex;
+    }
+
+    ++slots.liveCount;
+    slots.peakCount = std::max(slots.peakCount, slots.liveCount);
+    return index;
+}
+
+void VulkanBindlessHeap::writeDescriptor(VulkanBindlessType type, uint32_t index, const VkDescriptorImageInfo *imageInfo, const VkDescriptorBufferInfo *bufferInfo)
+{
+    // Update after bind - the element isn't used by the frames in flight so the set can be written while they run
+    const VkWriteDescriptorSet descriptorWrite = {
+        VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,                     // sType
+        nullptr,                                                    // pNext
+        m_descriptorSet,                                            // dstSet
+        static_cast<uint32_t>(type),                                // dstBinding
+        index,                                                      // dstArrayElement
+        1,                                                          // descriptorCount
+        BindlessDescriptorTypes[static_cast<uint32_t>(type)],       // descriptorType
+        imageInfo,                                                  // pImageInfo
+        bufferInfo,                                                 // pBufferInfo
+        nullptr                                                     // pTexelBufferView
+    };
+    vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+}
+
+bool VulkanBindlessHeap::createSetLayout(VkDevice device)
+{
+    // One array per type, visible to every stage
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+    std::vector<VkDescriptorBindingFlagsEXT> bindingFlags;
+    for (uint32_t type = 0; type < static_cast<uint32_t>(VulkanBindlessType::Count); ++type)
+    {
+        bindings.push_back({
+            type,                                   // binding
+            BindlessDescriptorTypes[type],          // descriptorType
+            m_slots[type].capacity,                 // descriptorCount
+            VK_SHADER_STAGE_ALL,                    // stageFlags
+            nullptr                                 // pImmutableSamplers
+        });
+        // Unregistered elements are never read, registered ones are written while the set is in use
+        bindingFlags.push_back(VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT);
+    }
+
+    const VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsCreateInfo = {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,     // sType
+        nullptr,                                                                    // pNext
+        static_cast<uint32_t>(bindingFlags.size()),                                 // bindingCount
+        bindingFlags.data()                                                         // pBindingFlags
+    };
+    const VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,        // sType
+        &bindingFlagsCreateInfo,                                    // pNext
+        VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT, // flags
+        static_cast<uint32_t>(bindings.size()),                     // bindingCount
+        bindings.data()                                             // pBindings
+    };
+    if (vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, nullptr, &m_setLayout) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create the bindless descriptor set layout.\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
+
+bool VulkanBindlessHeap::createDescriptorSet(VkDevice device)
+{
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    for (uint32_t type = 0; type < static_cast<uint32_t>(VulkanBindlessType::Count); ++type)
+        poolSizes.push_back({ BindlessDescriptorTypes[type], m_slots[type].capacity });
+
+    const VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,          // sType
+        nullptr,                                                // pNext
+        VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT,    // flags
+        1,                                                      // maxSets
+        static_cast<uint32_t>(poolSizes.size()),                // poolSizeCount
+        poolSizes.data()                                        // pPoolSizes
+    };
+    if (vkCreateDescriptorPool(device, &descriptorPoolCreateInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create the bindless descriptor pool.\n";
+        return false;
+    }
+
+    VkDescriptorSetAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = m_descriptorPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &m_setLayout;
+    if (vkAllocateDescriptorSets(device, &allocateInfo, &m_descriptorSet) != VK_SUCCESS)
+    {
+        std::cout << "Failed to allocate the bindless descriptor set.\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
+
+bool VulkanBindlessHeap::createDefaultSampler(VkDevice device)
+{
+    VkSamplerCreateInfo samplerCreateInfo = {};
+    samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+    samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+    samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerCreateInfo.minLod = 0.0f;
+    samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+    if (vkCreateSampler(device, &samplerCreateInfo, nullptr, &m_defaultSampler) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create the default sampler.\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
\ No newline at end of file
@@ -3,7 +3,7 @@
 #include <iostream>
 #include <assert.h>
 
-bool VulkanCommandBuffers::init(VkDevice device, VkCommandPool storageCommandPool, uint32_t bufferCount)
+bool VulkanCommandBuffers::init(VkDevice device, VkCommandPool storageCommandPool, uint32_t bufferCount, VkCommandBufferLevel level)
 {
     assert(bufferCount > 0 && "Invalid buffer count.");
 
@@ -11,7 +11,8 @@ bool VulkanCommandBuffers::init(VkDevice device, VkCommandPool storageCommandPoo
 
     VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
     commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    // Primary command buffers are submitted to queues, secondary ones are executed by primary ones
+    commandBufferAllocateInfo.level = level;
     commandBufferAllocateInfo.commandBufferCount = bufferCount;
     commandBufferAllocateInfo.commandPool = storageCommandPool;
 
@@ -26,15 +27,18 @@ bool VulkanCommandBuffers::init(VkDevice device, VkCommandPool storageCommandPoo
     return true;
 }
 
-bool VulkanCommandBuffers::beginCommandBuffer(uint32_t commandBufferIndex, VkCommandBufferUsageFlags flags)
+bool VulkanCommandBuffers::beginCommandBuffer(uint32_t commandBufferIndex, 
+    VkCommandBufferUsageFlags flags,
+    const VkCommandBufferInheritanceInfo *inheritanceInfo)
 {
     assert(commandBufferIndex < m_commandBuffers.size() && "Invalid command buffer index to start.\n");
 
     VkCommandBufferBeginInfo commandBufferBeginInfo = {};
     commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    commandBufferBeginInfo.pInheritanceInfo = nullptr;
-    // The command buffer can be submitted again while its execution is pending in another command buffer
-    commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    commandBufferBeginInfo.pInheritanceInfo = inheritanceInfo;
+    // VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT - the command buffer can be submitted again while its execution is pending
+    // VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT - the command buffer is re-recorded after every submission
+    commandBufferBeginInfo.flags = flags;
 
     if (vkBeginCommandBuffer(m_commandBuffers[commandBufferIndex], &commandBufferBeginInfo) != VK_SUCCESS)
     {
@@ -25,6 +25,19 @@ bool VulkanCommandPool::init(VkDevice device, int queueFamilyIndex, VkCommandPoo
     return true;
 }
     
+bool VulkanCommandPool::reset(VkDevice device, VkCommandPoolResetFlags flags)
+{
+    // None of the command buffers allocated from the pool can be pending execution
+    if (vkResetCommandPool(device, m_commandPool, flags) != VK_SUCCESS)
+    {
+        std::cout << "Failed to reset command pool.\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
+
 void VulkanCommandPool::cleanup(VkDevice device)
 {
     if (m_commandPool != VK_NULL_HANDLE)
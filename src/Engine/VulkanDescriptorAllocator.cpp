@@ -0,0 +1,183 @@
+#include "VulkanDescriptorAllocator.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    // Descriptors of each type per set in a pool - typical sets hold a few buffers and images
+    const struct
+    {
+        VkDescriptorType type;
+        float countPerSet;
+    } PoolRatios[] = {
+        { VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f },
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.0f },
+        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0.5f },
+        { VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 0.25f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 0.25f },
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f },
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 0.5f },
+        { VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.25f }
+    };
+}
+
+bool VulkanDescriptorAllocator::init(VkDevice device, VulkanLayoutCache &layoutCache, uint32_t framesInFlight, uint32_t setsPerPool)
+{
+    assert(framesInFlight != 0 && "Invalid frames in flight count.");
+    assert(setsPerPool != 0 && "Invalid pool size.");
+
+    m_device = device;
+    m_layoutCache = &layoutCache;
+    m_frameArenas.resize(framesInFlight);
+    m_currentFrame = 0;
+    m_nextPoolSetCount = std::min(setsPerPool, MaxSetsPerPool);
+
+    // Success
+    return true;
+}
+
+void VulkanDescriptorAllocator::cleanup(VkDevice device)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Destroying a pool frees its sets
+    for (auto pool : m_persistentArena.pools)
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    m_persistentArena.pools.clear();
+    for (auto &arena : m_frameArenas)
+    {
+        for (auto pool : arena.pools)
+            vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+    m_frameArenas.clear();
+    for (auto pool : m_freePools)
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    m_freePools.clear();
+}
+
+void VulkanDescriptorAllocator::beginFrame(uint32_t frameIndex)
+{
+    assert(frameIndex < m_frameArenas.size() && "Invalid frame index.");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_currentFrame = frameIndex;
+
+    // Free every set of the frame at once and hand the pools back
+    Arena &arena = m_frameArenas[frameIndex];
+    for (auto pool : arena.pools)
+    {
+        vkResetDescriptorPool(m_device, pool, 0);
+        m_freePools.push_back(pool);
+    }
+    arena.pools.clear();
+}
+
+bool VulkanDescriptorAllocator::allocate(VkDescriptorSetLayout setLayout, VkDescriptorSet &descriptorSet, VulkanDescriptorLifetime lifetime)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Arena &arena = (lifetime == VulkanDescriptorLifetime::Persistent) ? m_persistentArena : m_frameArenas[m_currentFrame];
+
+    // Try the current pool, chain a new one if it's out of memory
+    for (uint32_t attempt = 0; attempt < 2; ++attempt)
+    {
+        if (arena.pools.empty() || attempt != 0)
+        {
+            const VkDescriptorPool pool = acquirePool();
+            if (pool == VK_NULL_HANDLE)
+                return false;
+            arena.pools.push_back(pool);
+        }
+
+        VkDescriptorSetAllocateInfo allocateInfo = {};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = arena.pools.back();
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts = &setLayout;
+
+        const VkResult result = vkAllocateDescriptorSets(m_device, &allocateInfo, &descriptorSet);
+        if (result == VK_SUCCESS)
+        {
+            ++m_allocatedSetCount;
+            return true;
+        }
+        if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+            break;
+    }
+
+    std::cout << "Failed to allocate descriptor set.\n";
+    return false;
+}
+
+bool VulkanDescriptorAllocator::write(VkDescriptorSet descriptorSet, VkDescriptorSetLayout setLayout, const std::vector<VulkanDescriptorInfo> &descriptors)
+{
+    assert(descriptors.size() == m_layoutCache->descriptorCount(setLayout) && "Descriptor count doesn't match the set layout.");
+
+    const VkDescriptorUpdateTemplate updateTemplate = m_layoutCache->getUpdateTemplate(setLayout);
+    if (updateTemplate == VK_NULL_HANDLE)
+        return false;
+
+    // Every binding of the set in one call, no VkWriteDescriptorSet array to build
+    vkUpdateDescriptorSetWithTemplate(m_device, descriptorSet, updateTemplate, descriptors.data());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_writtenSetCount;
+
+    // Success
+    return true;
+}
+
+void VulkanDescriptorAllocator::printStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::cout << "\nDescriptor allocator: " << m_poolCount << " pools, " << m_allocatedSetCount << " sets allocated, "
+        << m_writtenSetCount << " sets written\n";
+}
+
+VkDescriptorPool VulkanDescriptorAllocator::acquirePool()
+{
+    // Reuse a reset pool first
+    if (m_freePools.empty() == false)
+    {
+        const VkDescriptorPool pool = m_freePools.back();
+        m_freePools.pop_back();
+        return pool;
+    }
+
+    const VkDescriptorPool pool = createPool(m_nextPoolSetCount);
+    m_nextPoolSetCount = std::min(m_nextPoolSetCount * 2, MaxSetsPerPool);
+    return pool;
+}
+
+VkDescriptorPool VulkanDescriptorAllocator::createPool(uint32_t setCount)
+{
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    for (const auto &ratio : PoolRatios)
+        poolSizes.push_back({ ratio.type, std::max(1u, static_cast<uint32_t>(ratio.countPerSet * setCount)) });
+
+    const VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,          // sType
+        nullptr,                                                // pNext
+        0,                                                      // flags - sets are only freed with the whole pool
+        setCount,                                               // maxSets
+        static_cast<uint32_t>(poolSizes.size()),                // poolSizeCount
+        poolSizes.data()                                        // pPoolSizes
+    };
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if (vkCreateDescriptorPool(m_device, &descriptorPoolCreateInfo, nullptr, &pool) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create descriptor pool.\n";
+        return VK_NULL_HANDLE;
+    }
+    ++m_poolCount;
+
+    return pool;
+}
\ No newline at end of file
@@ -26,33 +26,37 @@ bool VulkanDescriptorSets::init(VkDevice device, const VulkanDescriptorPool &des
     return true;
 }
 
-void VulkanDescriptorSets::setBuffer(VkDevice device, uint32_t descriptorSetIndex, uint32_t binding, uint32_t elementIndex, uint32_t descriptorCount)
+void VulkanDescriptorSets::setBuffer(uint32_t descriptorSetIndex, 
+    uint32_t binding, 
+    uint32_t elementIndex, 
+    VkDescriptorType descriptorType, 
+    const std::vector<VkDescriptorBufferInfo> &bufferInfos)
 {
     assert(descriptorSetIndex < m_descriptorSets.size());
-
-    VkDescriptorBufferInfo bufferInfo[] = {
-        //VkBuffer        buffer;
-        //VkDeviceSize    offset;
-        //VkDeviceSize    range;
-    };
-
-    std::vector<VkWriteDescriptorSet> writeSets = {
-        {
-            VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,         // sType
-            nullptr,                                        // pNext
-            m_descriptorSets[descriptorSetIndex],           // dstSet
-            binding,                                        // dstBinding
-            elementIndex,                                   // dstArrayElement
-            descriptorCount,                                // descriptorCount
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,              // descriptorType
-            nullptr,                                        // pImageInfo
-            bufferInfo,                                     // pBufferInfo
-            nullptr                                         // pTexelBufferView
-        }
-    };
+    assert(bufferInfos.size() > 0 && "Invalid buffer info count.");
+
+    m_bufferInfos.push_back(bufferInfos);
+
+    m_writeSets.push_back({
+        VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,                 // sType
+        nullptr,                                                // pNext
+        m_descriptorSets[descriptorSetIndex],                   // dstSet
+        binding,                                                // dstBinding
+        elementIndex,                                           // dstArrayElement
+        static_cast<uint32_t>(bufferInfos.size()),              // descriptorCount
+        descriptorType,                                         // descriptorType
+        nullptr,                                                // pImageInfo
+        m_bufferInfos.back().data(),                            // pBufferInfo
+        nullptr                                                 // pTexelBufferView
+    });
 }
 
 void VulkanDescriptorSets::updateDescriptorSets(VkDevice device)
 {
     vkUpdateDescriptorSets(device, m_writeSets.size(), m_writeSets.data(), m_copySets.size(), m_copySets.data());
+
+    // Pending updates were applied
+    m_writeSets.clear();
+    m_copySets.clear();
+    m_bufferInfos.clear();
 }
\ No newline at end of file
@@ -4,50 +4,284 @@
 
 #include <string>
 #include <limits>
+#include <atomic>
+#include <algorithm>
+#include <thread>
 
 bool VulkanEngine::initVulkan(const Window &window, const std::string &appName, unsigned int appMajorVersion, unsigned int appMinorVersion)
 {
-    bool res = true;
+    m_headless = false;
 
     // Instance
     if (m_instance.init(appName, m_engineVersionMinor, m_engineVersionMajor, appMajorVersion, appMinorVersion) == 0) return false;
      // Display
     if (m_display.createSurface(m_instance.get(), window.get()) == 0) return false;
-    // Physical device init
-    if (m_physicalDevice.init(m_instance.get(), VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, m_display.surface()) == 0) return false;
-    // Logical device
-    if (m_logicalDevice.init(m_physicalDevice.get(), m_physicalDevice.getGraphicsQueueFamilyIndex(), 1) == 0) return false;
-    // Graphics queue
-    m_graphicsQueue.init(m_logicalDevice.get(), m_physicalDevice.getGraphicsQueueFamilyIndex(), 0);
-    m_presentationQueue.init(m_logicalDevice.get(), m_physicalDevice.getPresentationQueueFamilyIndex(), 0);
+    // Devices, queues and the shared engine systems
+    if (initDevices() == false) return false;
     // Swap chain
     if (m_display.initSwapchain(m_physicalDevice, m_logicalDevice, window.width(), window.height()) == 0) return false;
-    // Create a render pass
-    if (m_renderPass.init(m_logicalDevice.get(), m_display.surfaceFormat().format) == 0) return false;
-    // Create framebuffers for each image view corresponding to each image in the swap chain
-    if (m_display.createFramebuffers(m_logicalDevice.get(), m_renderPass.get()) == 0) return false;
-    // Command pool
-    if (m_commandPool.init(m_logicalDevice.get(), m_physicalDevice.getGraphicsQueueFamilyIndex()) == 0) return false;
-    // Command buffers
-    if (m_commandBuffers.init(m_logicalDevice.get(), m_commandPool.get(), m_display.imageCount()) == 0) return false;
-    // Sync objects
-    if (m_swapChainSync.init(m_logicalDevice.get(), m_maxFramesInFlight, m_maxFramesInFlight, m_maxFramesInFlight) == 0) return false;
-    // Setup command buffers
-    //if (setupCommandBuffers() == 0) return false;
+    // Render graph, command buffers and synchronization
+    if (initFrames() == false) return false;
+
+    // Success
+    return true;
+}
+
+bool VulkanEngine::initVulkanHeadless(uint32_t width, uint32_t height, const std::string &appName, unsigned int appMajorVersion, unsigned int appMinorVersion)
+{
+    m_headless = true;
+
+    // Instance - no window system
+    if (m_instance.init(appName, m_engineVersionMinor, m_engineVersionMajor, appMajorVersion, appMinorVersion, true) == 0) return false;
+    // Devices, queues and the shared engine systems - any device will do, presentation isn't needed
+    if (initDevices() == false) return false;
+    // Offscreen color targets instead of the swap chain
+    if (createOffscreenTargets(width, height) == false) return false;
+    // Render graph, command buffers and synchronization
+    if (initFrames() == false) return false;
+
+    // Success
+    return true;
+}
+
+void VulkanEngine::addRenderable(const VulkanRenderableObject &object)
+{
+    m_renderableList.push_back(&object);
+    // Looked up by the recording jobs - never modified while recording
+    if (m_profileRenderables)
+        m_renderableScopes[&object] = m_gpuProfiler.registerScope(object.name() + " " + std::to_string(m_renderableList.size() - 1));
+}
+
+void VulkanEngine::enableFrameCapture(const std::string &outputPrefix, VulkanImageFileFormat fileFormat, uint32_t frameInterval)
+{
+    m_captureEnabled = true;
+    m_captureOutputPrefix = outputPrefix;
+    m_captureFileFormat = fileFormat;
+    m_captureFrameInterval = std::max(1u, frameInterval);
+}
+
+void VulkanEngine::enableTrace(const std::string &filename)
+{
+    m_traceFilename = filename;
+}
+
+void VulkanEngine::enableApiStats(bool logFrames)
+{
+#ifndef ENGINE_VULKAN_API_STATS
+    (void)logFrames;
+    std::cout << "Vulkan API stats are not compiled in - enable ENGINE_VULKAN_API_STATS.\n";
+#else
+    m_apiStatsEnabled = true;
+    m_apiStatsLogFrames = logFrames;
+#endif
+}
+
+void VulkanEngine::setUniformRingFrameSize(VkDeviceSize frameSize)
+{
+    m_uniformRingFrameSize = frameSize;
+}
+
+void VulkanEngine::enableRenderableProfiling(bool profileRenderables)
+{
+    m_profileRenderables = profileRenderables;
+}
+
+bool VulkanEngine::initDevices()
+{
+    // Physical device init - the surface is null when headless
+    if (m_physicalDevice.init(m_instance.get(), VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, m_display.surface()) == 0) return false;
+    // Logical device - one queue per used queue family
+    std::vector<uint32_t> queueFamilyIndices = {
+        (uint32_t)m_physicalDevice.getGraphicsQueueFamilyIndex()
+    };
+    if (m_headless == false)
+        queueFamilyIndices.push_back((uint32_t)m_physicalDevice.getPresentationQueueFamilyIndex());
+    if (m_physicalDevice.hasDedicatedTransferQueue())
+        queueFamilyIndices.push_back((uint32_t)m_physicalDevice.getTransferQueueFamilyIndex());
+    // Descriptor indexing is enabled for the bindless heap when the device has it
+    m_bindlessEnabled = m_useBindless && m_physicalDevice.supportsDescriptorIndexing();
+    if (m_logicalDevice.init(m_physicalDevice.get(), 
+        queueFamilyIndices, 
+        1, 
+        m_bindlessEnabled ? &m_physicalDevice.getDescriptorIndexingFeatures() : nullptr,
+        m_headless == false) == 0) return false;
+    // Device memory allocator
+    if (m_memoryAllocator.init(m_physicalDevice) == 0) return false;
+    // Pipeline cache from the previous runs
+    if (m_pipelineCache.init(m_logicalDevice.get(), m_physicalDevice, m_pipelineCacheFilename) == 0) return false;
+    // Per frame uniform data
+    if (m_uniformRing.init(m_logicalDevice.get(), m_memoryAllocator, m_physicalDevice, m_uniformRingFrameSize, m_maxFramesInFlight) == 0) return false;
+    // Graphics queue
+    if (m_graphicsQueue.init(m_logicalDevice.get(), m_physicalDevice.getGraphicsQueueFamilyIndex(), 0) == 0) return false;
+    if (m_headless == false)
+    {
+        if (m_presentationQueue.init(m_logicalDevice.get(), m_physicalDevice.getPresentationQueueFamilyIndex(), 0) == 0) return false;
+    }
+    // Shared descriptor set and pipeline layouts
+    if (m_layoutCache.init(m_logicalDevice.get()) == 0) return false;
+    // Descriptor sets from chained pools
+    if (m_descriptorAllocator.init(m_logicalDevice.get(), m_layoutCache, m_maxFramesInFlight) == 0) return false;
+    // Bindless resources - released indices are reused once the graphics queue is done with them
+    if (m_bindlessEnabled)
+    {
+        if (m_bindlessHeap.init(m_logicalDevice.get(), m_physicalDevice, m_layoutCache, m_graphicsQueue.timeline()) == 0) return false;
+    }
+    // Shared pipelines - destroyed once the graphics queue is done with them, new ones compile in the background
+    if (m_pipelineRegistry.init(m_logicalDevice.get(), m_graphicsQueue.timeline(), &m_pipelineCache, m_pipelineCompileThreads) == 0) return false;
+    // Transfer queue - the graphics queue is used if the device has no transfer only family
+    if (m_physicalDevice.hasDedicatedTransferQueue())
+    {
+        if (m_transferQueue.init(m_logicalDevice.get(), m_physicalDevice.getTransferQueueFamilyIndex(), 0) == 0) return false;
+    }
+    // Batched uploads - copies run on the transfer queue and are handed over to the graphics queue
+    if (m_uploadManager.init(m_logicalDevice.get(), 
+        m_memoryAllocator, 
+        m_physicalDevice.hasDedicatedTransferQueue() ? m_transferQueue : m_graphicsQueue, 
+        m_graphicsQueue) == 0) return false;
+
+    // Success
+    return true;
+}
+
+bool VulkanEngine::initFrames()
+{
+    // GPU profiler - one query pool per frame in flight, the engine keeps running without it
+    if (m_useGpuProfiler)
+    {
+        if (m_gpuProfiler.init(m_logicalDevice.get(), m_physicalDevice, m_maxFramesInFlight))
+            m_frameScope = m_gpuProfiler.registerScope("frame");
+        else
+            m_gpuProfiler.cleanup(m_logicalDevice.get());
+    }
+    // Render passes, depth buffer and barriers of a frame - framebuffers are created per color target
+    if (buildRenderGraph() == false) return false;
+    // Per frame command pools - command buffers are re-recorded every frame and the whole pool
+    // is reset at once so there is no need for individually resettable command buffers
+    // Job pool - the main thread records as well
+    const uint32_t recordingThreadCount = std::max(1u, std::min(m_maxRecordingThreads, std::thread::hardware_concurrency()));
+    if (m_jobPool.init(recordingThreadCount - 1) == 0) return false;
+    m_frames.resize(m_maxFramesInFlight);
+    for (auto &frame : m_frames)
+    {
+        if (frame.commandPool.init(m_logicalDevice.get(), m_physicalDevice.getGraphicsQueueFamilyIndex(), VK_COMMAND_POOL_CREATE_TRANSIENT_BIT) == 0) return false;
+        if (frame.commandBuffers.init(m_logicalDevice.get(), frame.commandPool.get(), 1) == 0) return false;
+
+        // Secondary command buffers - one per recording job
+        frame.secondaryCommandPools.resize(recordingThreadCount);
+        frame.secondaryCommandBuffers.resize(recordingThreadCount);
+        for (uint32_t jobIndex = 0; jobIndex < recordingThreadCount; ++jobIndex)
+        {
+            if (frame.secondaryCommandPools[jobIndex].init(m_logicalDevice.get(), m_physicalDevice.getGraphicsQueueFamilyIndex(), VK_COMMAND_POOL_CREATE_TRANSIENT_BIT) == 0) return false;
+            if (frame.secondaryCommandBuffers[jobIndex].init(m_logicalDevice.get(), frame.secondaryCommandPools[jobIndex].get(), 1, VK_COMMAND_BUFFER_LEVEL_SECONDARY) == 0) return false;
+        }
+    }
+    // Sync objects - offscreen frames are only ordered by the graphics timeline
+    if (m_headless == false)
+    {
+        if (m_swapChainSync.init(m_logicalDevice.get(), m_maxFramesInFlight, m_maxFramesInFlight) == 0) return false;
+    }
+    // Trace - CPU zones from now on, GPU scopes only if their timestamps can be moved to the CPU clock
+    if (m_traceFilename.empty() == false)
+    {
+        if (m_gpuProfiler.enabled() && m_gpuProfiler.calibrate(m_graphicsQueue, m_frames[0].commandPool.get()))
+            m_gpuProfiler.setEventRecording(true);
+        CpuProfiler::getInstance().start();
+    }
+    // Vulkan calls - the setup calls above aren't part of any frame
+    if (m_apiStatsEnabled)
+        VulkanApiStats::getInstance().start(m_apiStatsLogFrames);
+
+    // Success
+    return true;
+}
+
+bool VulkanEngine::createOffscreenTargets(uint32_t width, uint32_t height)
+{
+    // Rendered to, then copied out by whoever reads the frames back
+    m_offscreenFormat = m_physicalDevice.findSupportedFormat({ VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_B8G8R8A8_UNORM },
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT);
+    if (m_offscreenFormat == VK_FORMAT_UNDEFINED)
+    {
+        std::cout << "Failed to find a supported offscreen color format.\n";
+        return false;
+    }
+    m_offscreenExtent = { width, height };
+
+    // One per frame in flight, the same way there is a swap chain image per frame
+    m_offscreenTargets.resize(m_maxFramesInFlight);
+    for (auto &offscreenTarget : m_offscreenTargets)
+    {
+        if (offscreenTarget.init(m_memoryAllocator,
+            m_logicalDevice.get(),
+            VK_IMAGE_TYPE_2D,
+            m_offscreenFormat,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            width, height, 1,
+            1, 1,
+            VK_SAMPLE_COUNT_1_BIT,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == false)
+        {
+            std::cout << "Failed to create an offscreen color target.\n";
+            return false;
+        }
+        if (offscreenTarget.createView(m_logicalDevice.get(), VK_IMAGE_ASPECT_COLOR_BIT) == false)
+            return false;
+    }
 
     // Success
-    return res;
+    return true;
 }
 
 void VulkanEngine::beginRender()
 {
-    // Wait for the current fence frame to be signalled
-    if (vkWaitForFences(m_logicalDevice.get(), 1, &m_swapChainSync.fences[m_currentFrameIndex], VK_TRUE, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS)
-        std::cout << "Failed to wait for the current frame fence object to be signalled. \n";
-    if (vkResetFences(m_logicalDevice.get(), 1, &m_swapChainSync.fences[m_currentFrameIndex]) != VK_SUCCESS)
-        std::cout << "Failed to reset the current frame fence object. \n";
+    CPU_PROFILE_SCOPE("Begin render");
+    FrameData &currentFrame = m_frames[m_currentFrameIndex];
+
+    // Wait for the previous submit of the current frame to be executed
+    m_frameTimings = {};
+    {
+        CPU_PROFILE_SCOPE("Wait for frame");
+        const uint64_t waitStart = CpuProfiler::now();
+        if (m_graphicsQueue.timeline().wait(currentFrame.submissionValue) == false)
+            std::cout << "Failed to wait for the current frame to be executed. \n";
+        m_frameTimings.waitMilliseconds = (CpuProfiler::now() - waitStart) / 1000000.0;
+    }
+
+    // Its timestamps can be read without waiting
+    m_gpuProfiler.beginFrame(m_currentFrameIndex);
+
+    // Recycle the command buffers of the frame in one go
+    currentFrame.commandPool.reset(m_logicalDevice.get());
+    for (auto &secondaryCommandPool : currentFrame.secondaryCommandPools)
+        secondaryCommandPool.reset(m_logicalDevice.get());
+
+    // The GPU is done with this frame so its uniform slice can be rewritten
+    m_uniformRing.beginFrame(m_currentFrameIndex);
+    // and its descriptor sets freed
+    m_descriptorAllocator.beginFrame(m_currentFrameIndex);
+    // and the bindless indices released before it reused
+    if (m_bindlessEnabled)
+        m_bindlessHeap.collectGarbage();
+
+    // Destroy the pipelines released by the renderables that no frame in flight uses anymore
+    m_pipelineRegistry.collectGarbage();
+
+    // Hand the captured frames the GPU is done with to the encoder thread
+    if (m_captureEnabled)
+        m_frameCapture.poll();
+
+    // Offscreen - the target of the frame in flight, free since the frame wait above
+    if (m_headless)
+    {
+        m_availableImageIndex = m_currentFrameIndex;
+        return;
+    }
 
     // Acquire image from the swap chain - wait for the image to be released by the presentation
+    CPU_PROFILE_SCOPE("Acquire image");
+    const uint64_t acquireStart = CpuProfiler::now();
     if (vkAcquireNextImageKHR(m_logicalDevice.get(), 
         m_display.swapChain(), 
         std::numeric_limits<uint64_t>::max(),
@@ -57,14 +291,64 @@ void VulkanEngine::beginRender()
     {
         std::cout << "Failed to acquire swap chain image.\n";    
     }
+    m_frameTimings.acquireMilliseconds = (CpuProfiler::now() - acquireStart) / 1000000.0;
 }
     
 void VulkanEngine::endRender()
 {
-    // Prepare a list of command buffers to be executed - we should submit just the command buffer
-    // that binds the swap chain image that we just acquired. Execute command buffer 
-    // with the current image as attachment - wait for the acquire image
-    m_graphicsQueue.submitCommandBuffers(m_swapChainSync, m_currentFrameIndex, { m_commandBuffers.get()[m_availableImageIndex] });
+    CPU_PROFILE_SCOPE("End render");
+    FrameData &currentFrame = m_frames[m_currentFrameIndex];
+
+    // Record the commands for this frame now that the renderables have updated their per frame data
+    // (uniform offsets). Use the command buffer of the current frame in flight - its pool was reset in
+    // beginRender - and the swap chain image that we just acquired.
+    const uint64_t recordStart = CpuProfiler::now();
+    if (recordCommandBuffer(m_availableImageIndex) == false)
+        std::cout << "Failed to record the command buffer of the current frame.\n";
+    m_frameTimings.recordMilliseconds = (CpuProfiler::now() - recordStart) / 1000000.0;
+
+    // Submit the uploads recorded since the last frame. Their last submit goes to the graphics queue
+    // ahead of the frame commands and ends with a barrier, so the frame sees the uploaded data
+    // without waiting on the CPU.
+    {
+        CPU_PROFILE_SCOPE("Flush uploads");
+        if (m_uploadManager.flush() == false)
+            std::cout << "Failed to submit the pending uploads.\n";
+    }
+
+    // Offscreen - nothing to wait for or present, the graphics timeline orders the frames
+    if (m_headless)
+    {
+        {
+            CPU_PROFILE_SCOPE("Submit");
+            const uint64_t submitStart = CpuProfiler::now();
+            if (m_graphicsQueue.submitCommandBuffers(currentFrame.commandBuffers.get(), currentFrame.submissionValue) == false)
+                std::cout << "Failed to submit the command buffer of the current frame.\n";
+            m_frameTimings.submitMilliseconds = (CpuProfiler::now() - submitStart) / 1000000.0;
+        }
+        if (m_captureEnabled)
+            m_frameCapture.submitted(currentFrame.submissionValue);
+
+        VulkanApiStats::getInstance().endFrame();
+        m_frameNumber++;
+        m_currentFrameIndex = (m_currentFrameIndex + 1) % m_maxFramesInFlight;
+        return;
+    }
+
+    // Execute command buffer with the current image as attachment - wait for the acquire image
+    // Wait before writing color data to the attachment
+    {
+        CPU_PROFILE_SCOPE("Submit");
+        const uint64_t submitStart = CpuProfiler::now();
+        if (m_graphicsQueue.submitCommandBuffers(currentFrame.commandBuffers.get(),
+            currentFrame.submissionValue,
+            { { m_swapChainSync.waitForObjects[m_currentFrameIndex], 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT } },
+            { m_swapChainSync.signalObjects[m_currentFrameIndex] }) == false)
+            std::cout << "Failed to submit the command buffer of the current frame.\n";
+        m_frameTimings.submitMilliseconds = (CpuProfiler::now() - submitStart) / 1000000.0;
+    }
+    if (m_captureEnabled)
+        m_frameCapture.submitted(currentFrame.submissionValue);
 
     // Do the presentation
     VkPresentInfoKHR presentInfo = {};
@@ -79,85 +363,325 @@ void VulkanEngine::endRender()
     presentInfo.pImageIndices = &m_availableImageIndex;
     presentInfo.pResults = nullptr;
 
-    // Send presentation commands to the presentation queue
-    if (vkQueuePresentKHR(m_presentationQueue.queueHandle(), &presentInfo) != VK_SUCCESS)
+    // Send presentation commands to the presentation queue - blocks when the presentation engine is behind
     {
-        std::cout << "Failed to send the presentation request.\n";
+        CPU_PROFILE_SCOPE("Present");
+        const uint64_t presentStart = CpuProfiler::now();
+        if (vkQueuePresentKHR(m_presentationQueue.queueHandle(), &presentInfo) != VK_SUCCESS)
+        {
+            std::cout << "Failed to send the presentation request.\n";
+        }
+        m_frameTimings.presentMilliseconds = (CpuProfiler::now() - presentStart) / 1000000.0;
     }
 
+    VulkanApiStats::getInstance().endFrame();
+
     // Update current frame index
+    m_frameNumber++;
     m_currentFrameIndex = (m_currentFrameIndex + 1) % m_maxFramesInFlight;
 }
 
-bool VulkanEngine::setupCommandBuffers()
+bool VulkanEngine::buildRenderGraph()
 {
-    auto &commandBuffers = m_commandBuffers.get();
+    // The swap chain image is owned by the display and presented after the frame. Offscreen
+    // targets are owned by the engine and left ready to be copied out.
+    VulkanRenderGraphImageDesc backbufferDesc = {};
+    backbufferDesc.format = m_headless ? m_offscreenFormat : m_display.surfaceFormat().format;
+    backbufferDesc.extent = m_headless ? m_offscreenExtent : m_display.surfaceExtent();
+    m_backbuffer = m_renderGraph.importImage("backbuffer", backbufferDesc, m_headless ? VulkanResourceUsage::TransferSrc : VulkanResourceUsage::Present);
 
-    for (auto &currentCommandBuffer : commandBuffers)
+    // Depth buffer - only lives inside the main pass, so it is never stored and sits in lazily
+    // allocated memory where the device has some
+    m_depthFormat = m_physicalDevice.findDepthFormat();
+    if (m_depthFormat == VK_FORMAT_UNDEFINED)
     {
-        int currentCommandBufferIndex = &currentCommandBuffer - commandBuffers.data();
+        std::cout << "Failed to find a supported depth format.\n";
+        return false;
+    }
+    VulkanRenderGraphImageDesc depthBufferDesc = {};
+    depthBufferDesc.format = m_depthFormat;
+    depthBufferDesc.extent = backbufferDesc.extent;
+    m_depthBuffer = m_renderGraph.createImage("depth", depthBufferDesc);
 
-        // Begin current command buffer recording
-        if (m_commandBuffers.beginCommandBuffer(currentCommandBufferIndex) == false)
-            return false;
+    // Main pass - every renderable, cleared first
+    m_mainPass = m_renderGraph.addPass("main", [this](const VulkanRenderGraphContext &context) { recordMainPass(context); });
+    m_renderGraph.writeColor(m_mainPass, m_backbuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, m_clearColor.color);
+    m_renderGraph.writeDepthStencil(m_mainPass, m_depthBuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, m_clearDepthStencil);
 
-        beginRenderPass(currentCommandBuffer, m_display.framebuffer(currentCommandBufferIndex));
-        
-        for (auto &renderableObject : m_renderableList)
-        {
-            renderableObject->render(currentCommandBuffer);
-        }
-        endRenderPass(currentCommandBuffer);
+    // Capture pass - copies the finished frame into the readback ring
+    if (m_captureEnabled && m_headless == false && m_display.supportsTransferSrc() == false)
+    {
+        std::cout << "The swap chain images can't be copied. Frame capture disabled.\n";
+        m_captureEnabled = false;
+    }
+    if (m_captureEnabled)
+    {
+        if (m_frameCapture.init(m_logicalDevice.get(),
+            m_physicalDevice,
+            m_memoryAllocator,
+            m_graphicsQueue.timeline(),
+            backbufferDesc.format,
+            backbufferDesc.extent,
+            m_captureOutputPrefix,
+            m_captureFileFormat) == false) return false;
 
-        // End current command buffer recording
-        if (m_commandBuffers.endCommandBuffer(currentCommandBufferIndex) == false)
-            return false;
+        m_capturePass = m_renderGraph.addPass("capture", [this](const VulkanRenderGraphContext &context) {
+            if (m_frameNumber % m_captureFrameInterval == 0)
+                m_frameCapture.record(context.commandBuffer, m_renderGraph.image(m_backbuffer), m_frameNumber);
+        });
+        m_renderGraph.read(m_capturePass, m_backbuffer, VulkanResourceUsage::TransferSrc);
+        m_renderGraph.setSideEffects(m_capturePass);
+    }
+
+    if (m_renderGraph.compile(m_logicalDevice.get(), m_physicalDevice, m_memoryAllocator) == false)
+    {
+        std::cout << "Failed to compile the render graph.\n";
+        return false;
+    }
+    m_renderGraph.setProfiler(&m_gpuProfiler);
+
+    // The first transition of a swap chain image must wait for the acquire semaphore, which the
+    // frame submit waits for at the color attachment output stage
+    VulkanResourceState acquiredState = {};
+    acquiredState.writeStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    if (m_headless == false)
+        m_swapChainImageStates.assign(m_display.imageCount(), acquiredState);
+
+    // Success
+    return true;
+}
+
+void VulkanEngine::sortRenderables()
+{
+    CPU_PROFILE_SCOPE("Sort renderables");
+    m_drawList.clear();
+    if (m_sortRenderables == false)
+    {
+        m_drawList = m_renderableList;
+        return;
     }
 
+    sortDrawList(m_renderableList, m_sortKeys, m_drawList);
+}
+
+bool VulkanEngine::recordCommandBuffer(uint32_t imageIndex)
+{
+    CPU_PROFILE_SCOPE("Record frame");
+    VulkanCommandBuffers &commandBuffers = m_frames[m_currentFrameIndex].commandBuffers;
+    VkCommandBuffer currentCommandBuffer = commandBuffers.get()[0];
+
+    // Begin current command buffer recording
+    if (commandBuffers.beginCommandBuffer(0, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT) == false)
+        return false;
+
+    // Timestamp queries of the frame - reset outside of the render passes
+    m_gpuProfiler.resetQueries(currentCommandBuffer);
+    const uint32_t frameSlot = m_gpuProfiler.enabled() ? m_gpuProfiler.beginScope(currentCommandBuffer, m_frameScope) : VulkanGpuProfiler::InvalidSlot;
+
+    // Bindless resources stay bound for the whole command buffer
+    if (m_bindlessEnabled)
+        m_bindlessHeap.bind(currentCommandBuffer);
+
+    // Draw order of the frame
+    sortRenderables();
+
+    // Split the renderables between the recording jobs once there are enough of them
+    const uint32_t renderableCount = m_drawList.size();
+    m_mainPassJobCount = std::min<uint32_t>(m_jobPool.threadCount(), renderableCount / m_minRenderablesPerJob);
+    m_mainPassFailed = false;
+    m_renderGraph.setSubpassContents(m_mainPass, (m_mainPassJobCount > 1) ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+
+    // Render into the swap chain image we just acquired, or the offscreen target of the frame
+    if (m_headless)
+    {
+        VulkanImage &offscreenTarget = m_offscreenTargets[imageIndex];
+        m_renderGraph.bindImportedImage(m_backbuffer, offscreenTarget.get(), offscreenTarget.view(), offscreenTarget.state());
+    }
+    else
+    {
+        m_renderGraph.bindImportedImage(m_backbuffer, m_display.image(imageIndex), m_display.imageView(imageIndex), m_swapChainImageStates[imageIndex]);
+    }
+    if (m_renderGraph.execute(currentCommandBuffer) == false || m_mainPassFailed)
+        return false;
+
+    m_gpuProfiler.endScope(currentCommandBuffer, frameSlot);
+
+    // End current command buffer recording
+    if (commandBuffers.endCommandBuffer(0) == false)
+        return false;
+
     // Success
     return true;
 }
 
+void VulkanEngine::recordMainPass(const VulkanRenderGraphContext &context)
+{
+    if (m_mainPassJobCount > 1)
+    {
+        // The render pass content comes from the secondary command buffers recorded by the jobs
+        if (recordSecondaryCommandBuffers(m_mainPassJobCount, context) == false)
+        {
+            m_mainPassFailed = true;
+            return;
+        }
+
+        std::vector<VkCommandBuffer> secondaryCommandBuffers(m_mainPassJobCount);
+        for (uint32_t jobIndex = 0; jobIndex < m_mainPassJobCount; ++jobIndex)
+            secondaryCommandBuffers[jobIndex] = m_frames[m_currentFrameIndex].secondaryCommandBuffers[jobIndex].get()[0];
+        vkCmdExecuteCommands(context.commandBuffer, secondaryCommandBuffers.size(), secondaryCommandBuffers.data());
+    }
+    else
+    {
+        for (auto &renderableObject : m_drawList)
+        {
+            VulkanGpuScope renderableScope(m_profileRenderables ? &m_gpuProfiler : nullptr,
+                context.commandBuffer,
+                m_profileRenderables ? m_renderableScopes.at(renderableObject) : 0);
+            renderableObject->render(context.commandBuffer);
+        }
+    }
+}
+
+bool VulkanEngine::recordSecondaryCommandBuffers(uint32_t jobCount, const VulkanRenderGraphContext &context)
+{
+    FrameData &currentFrame = m_frames[m_currentFrameIndex];
+
+    // Secondary command buffers continue the render pass started by the primary one
+    VkCommandBufferInheritanceInfo inheritanceInfo = {};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = context.renderPass;
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = context.framebuffer;
+
+    const uint32_t renderableCount = m_drawList.size();
+    std::atomic<bool> recordingFailed { false };
+
+    // Every job records a contiguous slice of the renderables so the draw order is preserved
+    m_jobPool.parallelFor(jobCount, [&](uint32_t jobIndex)
+    {
+        CPU_PROFILE_SCOPE("Record job");
+        const uint32_t firstRenderable = (renderableCount * jobIndex) / jobCount;
+        const uint32_t lastRenderable = (renderableCount * (jobIndex + 1)) / jobCount;
+
+        VulkanCommandBuffers &commandBuffers = currentFrame.secondaryCommandBuffers[jobIndex];
+        if (commandBuffers.beginCommandBuffer(0, 
+            VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, 
+            &inheritanceInfo) == false)
+        {
+            recordingFailed = true;
+            return;
+        }
+
+        // Dynamic state isn't inherited - every renderable sets what it uses
+        VkCommandBuffer commandBuffer = commandBuffers.get()[0];
+        // Neither are the bound descriptor sets
+        if (m_bindlessEnabled)
+            m_bindlessHeap.bind(commandBuffer);
+        for (uint32_t renderableIndex = firstRenderable; renderableIndex < lastRenderable; ++renderableIndex)
+        {
+            const VulkanRenderableObject *renderableObject = m_drawList[renderableIndex];
+            VulkanGpuScope renderableScope(m_profileRenderables ? &m_gpuProfiler : nullptr,
+                commandBuffer,
+                m_profileRenderables ? m_renderableScopes.at(renderableObject) : 0);
+            renderableObject->render(commandBuffer);
+        }
+
+        if (commandBuffers.endCommandBuffer(0) == false)
+            recordingFailed = true;
+    });
+
+    return recordingFailed == false;
+}
+
 void VulkanEngine::cleanup()
 {
+    // Recording threads
+    m_jobPool.cleanup();
     // Semaphores
     m_swapChainSync.cleanup(m_logicalDevice.get());
-    // Command pool
-    m_commandPool.cleanup(m_logicalDevice.get());
-    // Render pass
-    m_renderPass.cleanup(m_logicalDevice.get());
+    // Per frame command pools
+    for (auto &frame : m_frames)
+    {
+        frame.commandPool.cleanup(m_logicalDevice.get());
+        for (auto &secondaryCommandPool : frame.secondaryCommandPools)
+            secondaryCommandPool.cleanup(m_logicalDevice.get());
+    }
+    m_frames.clear();
+    // GPU timings of the run - the device is idle so the last frames can be read too
+    m_gpuProfiler.flush();
+    if (m_gpuProfiler.enabled())
+    {
+        m_gpuProfiler.printStatistics();
+        if (m_gpuProfileFilename.empty() == false)
+            m_gpuProfiler.dump(m_gpuProfileFilename);
+    }
+    // Trace of the run - the recording threads are gone
+    if (m_traceFilename.empty() == false)
+    {
+        CpuProfiler &cpuProfiler = CpuProfiler::getInstance();
+        cpuProfiler.stop();
+        cpuProfiler.printStatistics();
+        cpuProfiler.exportChromeTrace(m_traceFilename, "GPU", m_gpuProfiler.traceEvents());
+    }
+    // Vulkan calls of the run - the teardown isn't counted
+    if (m_apiStatsEnabled)
+    {
+        VulkanApiStats &apiStats = VulkanApiStats::getInstance();
+        apiStats.stop();
+        apiStats.printStatistics();
+    }
+    m_gpuProfiler.cleanup(m_logicalDevice.get());
+    // Render passes, framebuffers and transient images
+    m_renderGraph.printStatistics();
+    m_renderGraph.cleanup(m_logicalDevice.get());
+    // Frame capture - writes the frames still in flight first
+    if (m_captureEnabled)
+    {
+        m_frameCapture.cleanup(m_logicalDevice.get());
+        m_frameCapture.printStatistics();
+    }
     // Display
     m_display.cleanup(m_logicalDevice.get(), m_instance.get());
+    // Offscreen color targets
+    for (auto &offscreenTarget : m_offscreenTargets)
+        offscreenTarget.cleanup(m_logicalDevice.get());
+    m_offscreenTargets.clear();
+    // Uniform ring
+    m_uniformRing.cleanup(m_logicalDevice.get());
+    // Uploads - waits for the batches still in flight
+    m_uploadManager.cleanup(m_logicalDevice.get());
+    // Queue timelines
+    m_graphicsQueue.cleanup(m_logicalDevice.get());
+    m_presentationQueue.cleanup(m_logicalDevice.get());
+    m_transferQueue.cleanup(m_logicalDevice.get());
+    // Shared pipelines - created through the pipeline cache
+    m_pipelineRegistry.printStatistics();
+    m_pipelineRegistry.cleanup(m_logicalDevice.get());
+    // Descriptor sets
+    m_descriptorAllocator.printStatistics();
+    m_descriptorAllocator.cleanup(m_logicalDevice.get());
+    // Bindless heap - its pipeline layout belongs to the layout cache
+    if (m_bindlessEnabled)
+    {
+        m_bindlessHeap.printStatistics();
+        m_bindlessHeap.cleanup(m_logicalDevice.get());
+    }
+    // Layouts used by the pipelines
+    m_layoutCache.printStatistics();
+    m_layoutCache.cleanup(m_logicalDevice.get());
+    // Pipeline cache - saved for the next run
+    m_pipelineCache.printStatistics();
+    m_pipelineCache.save(m_logicalDevice.get());
+    m_pipelineCache.cleanup(m_logicalDevice.get());
+    // Device memory
+    m_memoryAllocator.printStatistics();
+    m_memoryAllocator.cleanup(m_logicalDevice.get());
     // Logical device
     m_logicalDevice.cleanup();
     // Instance
     m_instance.cleanup();
 }
 
-void VulkanEngine::beginRenderPass(VkCommandBuffer currentCommandBuffer, VkFramebuffer currentFramebuffer)
-{
-    VkRenderPassBeginInfo renderPassBeginInfo = {};
-    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    // Render pass
-    renderPassBeginInfo.renderPass = m_renderPass.get();
-    // Color attachment
-    renderPassBeginInfo.framebuffer = currentFramebuffer;
-    // Size of the render area
-    renderPassBeginInfo.renderArea.extent = m_display.surfaceExtent();
-    renderPassBeginInfo.renderArea.offset = { 0, 0 };
-    // Defines the clear value used for the VK_ATTACHMENT_LOAD_OP_CLEAR operation
-    renderPassBeginInfo.pClearValues = &m_clearColor;
-    renderPassBeginInfo.clearValueCount = 1;
-
-    // Begin render pass
-    vkCmdBeginRenderPass(currentCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-}
-
-void VulkanEngine::endRenderPass(VkCommandBuffer currentCommandbuffer)
-{
-    vkCmdEndRenderPass(currentCommandbuffer);
-}
-
 RenderInstance::RenderInstance(VulkanEngine &engine)
     : m_vulkanEngine(engine)
 {
@@ -0,0 +1,387 @@
+#include "VulkanFrameCapture.h"
+#include "CpuProfiler.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+
+namespace
+{
+    // PNG chunk checksum
+    uint32_t crc32(const uint8_t *data, size_t size, uint32_t crc = 0)
+    {
+        static const std::array<uint32_t, 256> table = []() {
+            std::array<uint32_t, 256> entries = {};
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (uint32_t k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                entries[n] = c;
+            }
+            return entries;
+        }();
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    void appendBigEndian(std::vector<uint8_t> &bytes, uint32_t value)
+    {
+        bytes.push_back(static_cast<uint8_t>(value >> 24));
+        bytes.push_back(static_cast<uint8_t>(value >> 16));
+        bytes.push_back(static_cast<uint8_t>(value >> 8));
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    void appendChunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data)
+    {
+        appendBigEndian(png, static_cast<uint32_t>(data.size()));
+        const size_t typeOffset = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        appendBigEndian(png, crc32(png.data() + typeOffset, png.size() - typeOffset));
+    }
+
+    // Uncompressed PNG - stored deflate blocks, no filtering. Writing speed matters more than size.
+    void encodePNG(const std::vector<uint8_t> &rgb, uint32_t width, uint32_t height, std::vector<uint8_t> &png)
+    {
+        // Every scanline starts with its filter type
+        const size_t rowSize = static_cast<size_t>(width) * 3;
+        std::vector<uint8_t> scanlines;
+        scanlines.reserve((rowSize + 1) * height);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            scanlines.push_back(0);
+            scanlines.insert(scanlines.end(), rgb.begin() + y * rowSize, rgb.begin() + (y + 1) * rowSize);
+        }
+
+        // zlib stream - header, stored blocks of at most 65535 bytes, adler32
+        std::vector<uint8_t> zlib = { 0x78, 0x01 };
+        zlib.reserve(scanlines.size() + (scanlines.size() / 65535 + 1) * 5 + 6);
+        size_t offset = 0;
+        do
+        {
+            const uint16_t blockSize = static_cast<uint16_t>(std::min<size_t>(scanlines.size() - offset, 65535));
+            const uint16_t blockSizeComplement = static_cast<uint16_t>(~blockSize);
+            const bool lastBlock = (offset + blockSize == scanlines.size());
+            zlib.push_back(lastBlock ? 1 : 0);
+            zlib.push_back(static_cast<uint8_t>(blockSize));
+            zlib.push_back(static_cast<uint8_t>(blockSize >> 8));
+            zlib.push_back(static_cast<uint8_t>(blockSizeComplement));
+            zlib.push_back(static_cast<uint8_t>(blockSizeComplement >> 8));
+            zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+            offset += blockSize;
+        } while (offset < scanlines.size());
+
+        uint32_t a = 1, b = 0;
+        for (uint8_t byte : scanlines)
+        {
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+        appendBigEndian(zlib, (b << 16) | a);
+
+        // 8 bit RGB
+        std::vector<uint8_t> header;
+        appendBigEndian(header, width);
+        appendBigEndian(header, height);
+        header.insert(header.end(), { 8, 2, 0, 0, 0 });
+
+        const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        png.assign(signature, signature + sizeof(signature));
+        appendChunk(png, "IHDR", header);
+        appendChunk(png, "IDAT", zlib);
+        appendChunk(png, "IEND", {});
+    }
+
+    bool isBGRA(VkFormat format)
+    {
+        return format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+    }
+
+    bool isRGBA(VkFormat format)
+    {
+        return format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB;
+    }
+}
+
+bool VulkanFrameCapture::init(VkDevice device,
+    const VulkanPhysicalDevice &physicalDevice,
+    VulkanMemoryAllocator &allocator,
+    VulkanTimeline &graphicsTimeline,
+    VkFormat format,
+    VkExtent2D extent,
+    const std::string &outputPrefix,
+    VulkanImageFileFormat fileFormat,
+    uint32_t bufferCount)
+{
+    assert(bufferCount > 0 && "Invalid frame capture buffer count.");
+
+    if (isBGRA(format) == false && isRGBA(format) == false)
+    {
+        std::cout << "Failed to init the frame capture - only 8 bit RGBA and BGRA formats can be captured.\n";
+        return false;
+    }
+
+    m_allocator = &allocator;
+    m_graphicsTimeline = &graphicsTimeline;
+    m_format = format;
+    m_extent = extent;
+    m_frameSize = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+    m_outputPrefix = outputPrefix;
+    m_fileFormat = fileFormat;
+
+    // Read by the CPU - cached memory is much faster to read if the device has some
+    VkMemoryPropertyFlags memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    const VkPhysicalDeviceMemoryProperties &memoryProperties = physicalDevice.getMemoryProperties();
+    for (uint32_t memoryTypeIndex = 0; memoryTypeIndex < memoryProperties.memoryTypeCount; ++memoryTypeIndex)
+    {
+        const VkMemoryPropertyFlags cachedFlags = memoryPropertyFlags | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        if ((memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & cachedFlags) == cachedFlags)
+        {
+            memoryPropertyFlags = cachedFlags;
+            break;
+        }
+    }
+
+    for (uint32_t slotIndex = 0; slotIndex < bufferCount; ++slotIndex)
+    {
+        m_slots.push_back(std::make_unique<Slot>());
+        Slot &slot = *m_slots.back();
+
+        VkBufferCreateInfo bufferCreateInfo = {};
+        bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferCreateInfo.size = m_frameSize;
+        bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        bufferCreateInfo.flags = 0;
+        if (vkCreateBuffer(device, &bufferCreateInfo, nullptr, &slot.buffer) != VK_SUCCESS)
+        {
+            std::cout << "Failed to create frame capture buffer.\n";
+            return false;
+        }
+
+        // Host visible memory is persistently mapped by the allocator
+        if (m_allocator->allocateForBuffer(device, slot.buffer, memoryPropertyFlags, slot.memory) == false)
+        {
+            std::cout << "Failed to allocate frame capture memory.\n";
+            return false;
+        }
+        assert(slot.memory.mappedData != nullptr && "Frame capture memory is not mapped.");
+    }
+
+    m_stopEncoding = false;
+    try
+    {
+        m_encoderThread = std::thread(&VulkanFrameCapture::encoderThreadLoop, this);
+    }
+    catch (const std::system_error &error)
+    {
+        std::cout << "Failed to start frame capture encoder thread: " << error.what() << "\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
+
+void VulkanFrameCapture::cleanup(VkDevice device)
+{
+    // Copies never submitted are lost, the others are written
+    for (auto &slot : m_slots)
+    {
+        if (slot->status.load(std::memory_order_acquire) == SlotStatus::Recorded)
+            slot->status.store(SlotStatus::Free, std::memory_order_release);
+        else if (slot->status.load(std::memory_order_acquire) == SlotStatus::InFlight)
+            m_graphicsTimeline->wait(slot->submissionValue);
+    }
+    poll();
+
+    // Encoder thread - writes everything queued before leaving
+    stopEncoderThread();
+
+    for (auto &slot : m_slots)
+    {
+        if (slot->buffer != VK_NULL_HANDLE)
+            vkDestroyBuffer(device, slot->buffer, nullptr);
+        if (m_allocator != nullptr)
+            m_allocator->free(device, slot->memory);
+    }
+    m_slots.clear();
+    m_nextSlot = 0;
+}
+
+bool VulkanFrameCapture::record(VkCommandBuffer commandBuffer, VkImage image, uint64_t frameNumber)
+{
+    // Slots are given back in order, the next one is the oldest
+    Slot &slot = *m_slots[m_nextSlot];
+    if (slot.status.load(std::memory_order_acquire) != SlotStatus::Free)
+    {
+        ++m_droppedCount;
+        return false;
+    }
+    m_nextSlot = (m_nextSlot + 1) % m_slots.size();
+
+    // The host may still have been reading the buffer during the previous capture
+    m_barriers.buffer(slot.buffer, 0, m_frameSize, slot.state, VulkanResourceUsage::TransferDst);
+    m_barriers.flush(commandBuffer);
+
+    // Tightly packed rows
+    VkBufferImageCopy region = {};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageOffset = { 0, 0, 0 };
+    region.imageExtent = { m_extent.width, m_extent.height, 1 };
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &region);
+
+    // Visible to the host once the timeline reaches the submit
+    m_barriers.buffer(slot.buffer, 0, m_frameSize, slot.state, VulkanResourceUsage::HostRead);
+    m_barriers.flush(commandBuffer);
+
+    slot.frameNumber = frameNumber;
+    slot.status.store(SlotStatus::Recorded, std::memory_order_release);
+    ++m_recordedCount;
+
+    // Success
+    return true;
+}
+
+void VulkanFrameCapture::submitted(uint64_t submissionValue)
+{
+    for (auto &slot : m_slots)
+    {
+        if (slot->status.load(std::memory_order_acquire) != SlotStatus::Recorded)
+            continue;
+        slot->submissionValue = submissionValue;
+        slot->status.store(SlotStatus::InFlight, std::memory_order_release);
+    }
+}
+
+void VulkanFrameCapture::poll()
+{
+    bool queued = false;
+    for (uint32_t slotIndex = 0; slotIndex < m_slots.size(); ++slotIndex)
+    {
+        Slot &slot = *m_slots[slotIndex];
+        if (slot.status.load(std::memory_order_acquire) != SlotStatus::InFlight || m_graphicsTimeline->hasCompleted(slot.submissionValue) == false)
+            continue;
+
+        slot.status.store(SlotStatus::Encoding, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_encodeQueue.push_back(slotIndex);
+        queued = true;
+    }
+
+    if (queued)
+        m_encodeCondition.notify_one();
+}
+
+void VulkanFrameCapture::printStatistics() const
+{
+    std::cout << "\nFrame capture: " << m_recordedCount << " frames copied, "
+        << m_writtenCount.load() << " written, "
+        << m_failedCount.load() << " failed writes, "
+        << m_droppedCount << " dropped (no free buffer)\n";
+}
+
+void VulkanFrameCapture::encoderThreadLoop()
+{
+    CPU_PROFILE_THREAD("Frame capture encoder");
+    for (;;)
+    {
+        uint32_t slotIndex = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_encodeCondition.wait(lock, [this]() { return m_stopEncoding || m_encodeQueue.empty() == false; });
+            // Drain the queue before stopping
+            if (m_encodeQueue.empty())
+                return;
+
+            slotIndex = m_encodeQueue.front();
+            m_encodeQueue.pop_front();
+        }
+
+        CPU_PROFILE_SCOPE("Encode frame");
+        Slot &slot = *m_slots[slotIndex];
+        if (writeFile(slot))
+            ++m_writtenCount;
+        else
+            ++m_failedCount;
+
+        // Back to the ring
+        slot.status.store(SlotStatus::Free, std::memory_order_release);
+    }
+}
+
+void VulkanFrameCapture::stopEncoderThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopEncoding = true;
+    }
+    m_encodeCondition.notify_all();
+
+    if (m_encoderThread.joinable())
+        m_encoderThread.join();
+}
+
+bool VulkanFrameCapture::writeFile(const Slot &slot) const
+{
+    const uint8_t *texels = static_cast<const uint8_t*>(slot.memory.mappedData);
+    const size_t texelCount = static_cast<size_t>(m_extent.width) * m_extent.height;
+
+    std::ostringstream filename;
+    filename << m_outputPrefix << std::setw(6) << std::setfill('0') << slot.frameNumber;
+
+    std::vector<uint8_t> fileData;
+    if (m_fileFormat == VulkanImageFileFormat::Raw)
+    {
+        filename << ".raw";
+        fileData.assign(texels, texels + m_frameSize);
+    }
+    else
+    {
+        // Alpha is dropped - the color targets are opaque
+        const bool bgra = isBGRA(m_format);
+        std::vector<uint8_t> rgb(texelCount * 3);
+        for (size_t texel = 0; texel < texelCount; ++texel)
+        {
+            rgb[texel * 3 + 0] = texels[texel * 4 + (bgra ? 2 : 0)];
+            rgb[texel * 3 + 1] = texels[texel * 4 + 1];
+            rgb[texel * 3 + 2] = texels[texel * 4 + (bgra ? 0 : 2)];
+        }
+
+        if (m_fileFormat == VulkanImageFileFormat::PPM)
+        {
+            filename << ".ppm";
+            const std::string header = "P6\n" + std::to_string(m_extent.width) + " " + std::to_string(m_extent.height) + "\n255\n";
+            fileData.assign(header.begin(), header.end());
+            fileData.insert(fileData.end(), rgb.begin(), rgb.end());
+        }
+        else
+        {
+            filename << ".png";
+            encodePNG(rgb, m_extent.width, m_extent.height, fileData);
+        }
+    }
+
+    std::ofstream file(filename.str(), std::ios::binary);
+    if (file.is_open() == false)
+    {
+        std::cout << "Failed to open " << filename.str() << " to write a captured frame.\n";
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
+
+    return file.good();
+}
\ No newline at end of file
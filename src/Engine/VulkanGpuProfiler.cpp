@@ -0,0 +1,399 @@
+#include "VulkanGpuProfiler.h"
+#include "VulkanCommandBuffers.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+bool VulkanGpuProfiler::init(VkDevice device,
+    const VulkanPhysicalDevice &physicalDevice,
+    uint32_t framesInFlight,
+    uint32_t maxScopesPerFrame,
+    uint32_t historySize)
+{
+    assert(framesInFlight > 0 && maxScopesPerFrame > 0 && historySize > 0 && "Invalid GPU profiler size.");
+
+    m_device = device;
+    m_maxScopesPerFrame = maxScopesPerFrame;
+    m_historySize = historySize;
+
+    // Timestamps are only written if the graphics queue family has valid bits
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice.get(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice.get(), &queueFamilyCount, queueFamilyProperties.data());
+
+    const uint32_t timestampValidBits = queueFamilyProperties[physicalDevice.getGraphicsQueueFamilyIndex()].timestampValidBits;
+    if (timestampValidBits == 0)
+    {
+        std::cout << "Failed to init the GPU profiler - the graphics queue doesn't support timestamps.\n";
+        return false;
+    }
+    m_timestampMask = (timestampValidBits >= 64) ? ~0ull : ((1ull << timestampValidBits) - 1);
+    m_timestampPeriod = physicalDevice.getDeviceProperties().limits.timestampPeriod;
+
+    // Two queries per scope
+    m_frames.resize(framesInFlight);
+    for (auto &frame : m_frames)
+    {
+        VkQueryPoolCreateInfo queryPoolCreateInfo = {};
+        queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolCreateInfo.queryCount = maxScopesPerFrame * 2;
+        if (vkCreateQueryPool(device, &queryPoolCreateInfo, nullptr, &frame.queryPool) != VK_SUCCESS)
+        {
+            std::cout << "Failed to create the GPU profiler query pool.\n";
+            return false;
+        }
+
+        frame.slotScopes.resize(maxScopesPerFrame);
+        frame.slotCount = std::make_unique<std::atomic<uint32_t>>(0);
+    }
+    m_queryResults.resize(maxScopesPerFrame * 2);
+    m_enabled = true;
+
+    // Success
+    return true;
+}
+
+void VulkanGpuProfiler::cleanup(VkDevice device)
+{
+    for (auto &frame : m_frames)
+    {
+        if (frame.queryPool != VK_NULL_HANDLE)
+            vkDestroyQueryPool(device, frame.queryPool, nullptr);
+    }
+    m_frames.clear();
+    m_enabled = false;
+}
+
+uint32_t VulkanGpuProfiler::registerScope(const std::string &name)
+{
+    for (uint32_t scopeId = 0; scopeId < m_scopes.size(); ++scopeId)
+    {
+        if (m_scopes[scopeId].name == name)
+            return scopeId;
+    }
+
+    ScopeHistory scope;
+    scope.name = name;
+    scope.samples.resize(m_historySize);
+    m_scopes.push_back(scope);
+    m_frameMilliseconds.push_back(0.0);
+    m_frameTouched.push_back(false);
+
+    return static_cast<uint32_t>(m_scopes.size() - 1);
+}
+
+void VulkanGpuProfiler::beginFrame(uint32_t frameIndex)
+{
+    if (m_enabled == false)
+        return;
+
+    m_currentFrame = frameIndex;
+    FrameQueries &frame = m_frames[frameIndex];
+    if (frame.recorded)
+        collectResults(frame);
+
+    frame.slotCount->store(0, std::memory_order_relaxed);
+    frame.recorded = false;
+}
+
+void VulkanGpuProfiler::flush()
+{
+    if (m_enabled == false)
+        return;
+
+    // Oldest first - the current frame was begun last
+    for (uint32_t frameOffset = 1; frameOffset <= m_frames.size(); ++frameOffset)
+    {
+        FrameQueries &frame = m_frames[(m_currentFrame + frameOffset) % m_frames.size()];
+        if (frame.recorded)
+            collectResults(frame);
+        frame.slotCount->store(0, std::memory_order_relaxed);
+        frame.recorded = false;
+    }
+}
+
+void VulkanGpuProfiler::resetQueries(VkCommandBuffer commandBuffer)
+{
+    if (m_enabled == false)
+        return;
+
+    FrameQueries &frame = m_frames[m_currentFrame];
+    vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, m_maxScopesPerFrame * 2);
+    frame.recorded = true;
+}
+
+uint32_t VulkanGpuProfiler::beginScope(VkCommandBuffer commandBuffer, uint32_t scopeId)
+{
+    assert(scopeId < m_scopes.size() && "Unregistered GPU profiler scope.");
+
+    FrameQueries &frame = m_frames[m_currentFrame];
+    const uint32_t slot = frame.slotCount->fetch_add(1, std::memory_order_relaxed);
+    if (slot >= m_maxScopesPerFrame)
+        return InvalidSlot;
+
+    frame.slotScopes[slot] = scopeId;
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, slot * 2);
+    return slot;
+}
+
+void VulkanGpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t slot)
+{
+    if (slot == InvalidSlot)
+        return;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_frames[m_currentFrame].queryPool, slot * 2 + 1);
+}
+
+bool VulkanGpuProfiler::statistics(const std::string &name, VulkanGpuScopeStatistics &scopeStatistics) const
+{
+    for (const auto &scope : m_scopes)
+    {
+        if (scope.name != name)
+            continue;
+        scopeStatistics = computeStatistics(scope);
+        return true;
+    }
+
+    return false;
+}
+
+std::vector<VulkanGpuScopeStatistics> VulkanGpuProfiler::statistics() const
+{
+    std::vector<VulkanGpuScopeStatistics> scopeStatistics;
+    for (const auto &scope : m_scopes)
+        scopeStatistics.push_back(computeStatistics(scope));
+
+    return scopeStatistics;
+}
+
+bool VulkanGpuProfiler::dump(const std::string &filename) const
+{
+    std::ofstream file(filename);
+    if (file.is_open() == false)
+    {
+        std::cout << "Failed to open " << filename << " to write the GPU profile.\n";
+        return false;
+    }
+
+    file << "scope,samples,min_ms,avg_ms,p99_ms,last_ms\n";
+    file << std::fixed << std::setprecision(4);
+    for (const auto &scopeStatistics : statistics())
+    {
+        file << scopeStatistics.name << "," << scopeStatistics.sampleCount << ","
+            << scopeStatistics.minMilliseconds << "," << scopeStatistics.avgMilliseconds << ","
+            << scopeStatistics.p99Milliseconds << "," << scopeStatistics.lastMilliseconds << "\n";
+    }
+
+    return file.good();
+}
+
+void VulkanGpuProfiler::printStatistics() const
+{
+    std::cout << "\nGPU profiler: last " << m_historySize << " frames, "
+        << m_droppedScopeCount << " scopes over the per frame limit, "
+        << m_unavailableFrameCount << " frames without results\n";
+    if (m_recordEvents)
+        std::cout << "  " << m_events.size() << " trace events, " << m_droppedEventCount << " dropped\n";
+    const std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(3);
+    for (const auto &scopeStatistics : statistics())
+    {
+        if (scopeStatistics.sampleCount == 0)
+            continue;
+        std::cout << "  " << scopeStatistics.name << ": min " << scopeStatistics.minMilliseconds
+            << " ms, avg " << scopeStatistics.avgMilliseconds
+            << " ms, p99 " << scopeStatistics.p99Milliseconds << " ms\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(precision);
+}
+
+bool VulkanGpuProfiler::calibrate(VulkanQueue &queue, VkCommandPool commandPool)
+{
+    if (m_enabled == false)
+        return false;
+
+    const uint32_t attemptCount = 8;
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo = {};
+    queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolCreateInfo.queryCount = attemptCount;
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    if (vkCreateQueryPool(m_device, &queryPoolCreateInfo, nullptr, &queryPool) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create the GPU profiler calibration query pool.\n";
+        return false;
+    }
+
+    // One command buffer per attempt - the pool may not allow resetting them one by one
+    VulkanCommandBuffers commandBuffers;
+    if (commandBuffers.init(m_device, commandPool, attemptCount) == false)
+    {
+        vkDestroyQueryPool(m_device, queryPool, nullptr);
+        return false;
+    }
+
+    // The timestamp is written somewhere between the submit and the end of the wait - the
+    // shortest round trip bounds the error best
+    uint64_t bestRoundTrip = ~0ull;
+    for (uint32_t attempt = 0; attempt < attemptCount; ++attempt)
+    {
+        VkCommandBuffer commandBuffer = commandBuffers.get()[attempt];
+        if (commandBuffers.beginCommandBuffer(attempt, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT) == false)
+            break;
+        vkCmdResetQueryPool(commandBuffer, queryPool, attempt, 1);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, attempt);
+        if (commandBuffers.endCommandBuffer(attempt) == false)
+            break;
+
+        const uint64_t submitNanoseconds = CpuProfiler::now();
+        if (queue.submitCommandBuffersAndWait({ commandBuffer }) == false)
+            break;
+        const uint64_t doneNanoseconds = CpuProfiler::now();
+
+        uint64_t ticks = 0;
+        if (vkGetQueryPoolResults(m_device, queryPool, attempt, 1, sizeof(ticks), &ticks, sizeof(ticks), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+            continue;
+
+        if (doneNanoseconds - submitNanoseconds < bestRoundTrip)
+        {
+            bestRoundTrip = doneNanoseconds - submitNanoseconds;
+            m_calibrationTicks = ticks & m_timestampMask;
+            m_calibrationNanoseconds = submitNanoseconds + bestRoundTrip / 2;
+            m_calibrated = true;
+        }
+    }
+
+    vkFreeCommandBuffers(m_device, commandPool, attemptCount, commandBuffers.get().data());
+    vkDestroyQueryPool(m_device, queryPool, nullptr);
+
+    if (m_calibrated == false)
+        std::cout << "Failed to calibrate the GPU timestamps.\n";
+
+    return m_calibrated;
+}
+
+void VulkanGpuProfiler::setEventRecording(bool recordEvents, uint32_t maxEvents)
+{
+    m_recordEvents = recordEvents;
+    m_maxEvents = maxEvents;
+    m_events.clear();
+    m_droppedEventCount = 0;
+}
+
+std::vector<CpuProfilerTrackEvent> VulkanGpuProfiler::traceEvents() const
+{
+    std::vector<CpuProfilerTrackEvent> trackEvents;
+    if (m_calibrated == false)
+        return trackEvents;
+
+    trackEvents.reserve(m_events.size());
+    for (const auto &event : m_events)
+    {
+        CpuProfilerTrackEvent trackEvent;
+        trackEvent.name = m_scopes[event.scopeId].name;
+        trackEvent.beginNanoseconds = toCpuNanoseconds(event.beginTicks);
+        trackEvent.endNanoseconds = toCpuNanoseconds(event.endTicks);
+        trackEvents.push_back(trackEvent);
+    }
+
+    return trackEvents;
+}
+
+void VulkanGpuProfiler::collectResults(FrameQueries &frame)
+{
+    const uint32_t recordedSlots = frame.slotCount->load(std::memory_order_relaxed);
+    const uint32_t slotCount = std::min(recordedSlots, m_maxScopesPerFrame);
+    m_droppedScopeCount += recordedSlots - slotCount;
+    if (slotCount == 0)
+        return;
+
+    // The frame is done so the results are there - never wait for them
+    const VkResult res = vkGetQueryPoolResults(m_device,
+        frame.queryPool,
+        0, slotCount * 2,
+        slotCount * 2 * sizeof(uint64_t), m_queryResults.data(),
+        sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT);
+    if (res != VK_SUCCESS)
+    {
+        ++m_unavailableFrameCount;
+        return;
+    }
+    ++m_collectedFrameCount;
+
+    // Scopes recorded several times in a frame add up
+    for (uint32_t slot = 0; slot < slotCount; ++slot)
+    {
+        const uint64_t begin = m_queryResults[slot * 2] & m_timestampMask;
+        const uint64_t end = m_queryResults[slot * 2 + 1] & m_timestampMask;
+        const uint32_t scopeId = frame.slotScopes[slot];
+        m_frameMilliseconds[scopeId] += static_cast<double>((end - begin) & m_timestampMask) * m_timestampPeriod / 1000000.0;
+        m_frameTouched[scopeId] = true;
+
+        if (m_recordEvents)
+        {
+            if (m_events.size() < m_maxEvents)
+                m_events.push_back({ scopeId, begin, end });
+            else
+                ++m_droppedEventCount;
+        }
+    }
+
+    for (uint32_t scopeId = 0; scopeId < m_scopes.size(); ++scopeId)
+    {
+        if (m_frameTouched[scopeId] == false)
+            continue;
+
+        ScopeHistory &scope = m_scopes[scopeId];
+        scope.samples[scope.head] = static_cast<float>(m_frameMilliseconds[scopeId]);
+        scope.head = (scope.head + 1) % m_historySize;
+        scope.sampleCount = std::min(scope.sampleCount + 1, m_historySize);
+        scope.lastMilliseconds = m_frameMilliseconds[scopeId];
+
+        m_frameMilliseconds[scopeId] = 0.0;
+        m_frameTouched[scopeId] = false;
+    }
+}
+
+VulkanGpuScopeStatistics VulkanGpuProfiler::computeStatistics(const ScopeHistory &scope) const
+{
+    VulkanGpuScopeStatistics scopeStatistics;
+    scopeStatistics.name = scope.name;
+    scopeStatistics.sampleCount = scope.sampleCount;
+    scopeStatistics.lastMilliseconds = scope.lastMilliseconds;
+    if (scope.sampleCount == 0)
+        return scopeStatistics;
+
+    std::vector<float> samples(scope.samples.begin(), scope.samples.begin() + scope.sampleCount);
+    std::sort(samples.begin(), samples.end());
+
+    double total = 0.0;
+    for (float sample : samples)
+        total += sample;
+
+    const size_t p99Index = static_cast<size_t>(std::ceil(samples.size() * 0.99)) - 1;
+    scopeStatistics.minMilliseconds = samples.front();
+    scopeStatistics.avgMilliseconds = total / samples.size();
+    scopeStatistics.p99Milliseconds = samples[p99Index];
+
+    return scopeStatistics;
+}
+
+uint64_t VulkanGpuProfiler::toCpuNanoseconds(uint64_t ticks) const
+{
+    // Signed distance to the calibration point - the timestamps can wrap below 64 valid bits
+    uint64_t deltaTicks = (ticks - m_calibrationTicks) & m_timestampMask;
+    double signedTicks = static_cast<double>(deltaTicks);
+    if (deltaTicks > (m_timestampMask >> 1))
+        signedTicks -= static_cast<double>(m_timestampMask) + 1.0;
+
+    const double nanoseconds = static_cast<double>(m_calibrationNanoseconds) + signedTicks * m_timestampPeriod;
+    return nanoseconds > 0.0 ? static_cast<uint64_t>(nanoseconds) : 0;
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "VulkanGraphicsPipeline.h"
 
 #include <iostream>
+#include <chrono>
 
 bool VulkanGraphicsPipeline::init(VkDevice device, 
     uint32_t width, uint32_t height,
@@ -11,7 +12,8 @@ bool VulkanGraphicsPipeline::init(VkDevice device,
     const std::vector<VkDynamicState> &dynamicStates,
     VkSampleCountFlagBits sampleCount,
     VkPipelineLayout pipelineLayout,
-    VkRenderPass &renderPass)
+    VkRenderPass &renderPass,
+    VulkanPipelineCache *pipelineCache)
 {
     // Vertex input
     VkPipelineVertexInputStateCreateInfo vertexInputStateInfo = {
@@ -149,12 +151,17 @@ bool VulkanGraphicsPipeline::init(VkDevice device,
         VK_NULL_HANDLE,                                             // basePipelineHandle
         -1                                                          // basePipelineIndex
     };
-    // Create graphics pipeline
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS)
+    // Create graphics pipeline - the cache skips the compilation of pipelines built by previous runs
+    const auto creationStart = std::chrono::steady_clock::now();
+    if (vkCreateGraphicsPipelines(device, 
+        (pipelineCache != nullptr) ? pipelineCache->get() : VK_NULL_HANDLE, 
+        1, &pipelineCreateInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS)
     {
         std::cout << "Failed to create the graphics pipeline. \n";
         return false;
     }
+    if (pipelineCache != nullptr)
+        pipelineCache->addPipelineCreation(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - creationStart).count());
 
     // Success
     return true;
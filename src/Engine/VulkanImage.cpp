@@ -2,8 +2,9 @@
 
 #include <assert.h>
 #include <iostream>
+#include <algorithm>
 
-bool VulkanImage::init(const VulkanPhysicalDevice &physicalDevice,
+bool VulkanImage::init(VulkanMemoryAllocator &allocator,
     VkDevice device, 
     VkImageType imageType, 
     VkFormat format,
@@ -20,6 +21,8 @@ bool VulkanImage::init(const VulkanPhysicalDevice &physicalDevice,
     assert(width > 0 && "Invalid image width.");
     assert(height > 0 && "Invalid image height.");
 
+    m_allocator = &allocator;
+
     // Store image information
     m_imageInfo.type = imageType;
     m_imageInfo.format = format;
@@ -29,23 +32,19 @@ bool VulkanImage::init(const VulkanPhysicalDevice &physicalDevice,
     m_imageInfo.levelCount = levelCount;
     m_imageInfo.samples = sampleCount;
 
-    // Initialze initial layout
-    m_currentLayout = initialLayout;
+    // Every subresource starts in the initial layout, untouched by the GPU
+    m_aspectMask = formatAspectMask(format);
+    VulkanResourceState initialState = {};
+    initialState.layout = initialLayout;
+    m_subresourceStates.assign(mipCount * levelCount, initialState);
 
     // Create vulkan image
     if (createImage(device) == false)
         return false;
 
-    // Allocate memory for the created image
-    if (allocateImageMemory(physicalDevice, device, memoryPropertyFlags) == false)
-        return false;
-
-    // Bind the allocated memory to our image handle
-    if (vkBindImageMemory(device, m_image, m_imageMemory, 0) != VK_SUCCESS)
-    {
-        std::cout << "Failed to bind memory to our image handle. \n";
+    // Allocate memory for the created image and bind it to our image handle
+    if (allocateImageMemory(device, memoryPropertyFlags) == false)
         return false;
-    }
 
     // Success
     return true;
@@ -53,18 +52,97 @@ bool VulkanImage::init(const VulkanPhysicalDevice &physicalDevice,
     
 void VulkanImage::cleanup(VkDevice device)
 {
+    // Index is reused once the frames in flight are done with it
+    if (m_bindlessHeap != nullptr)
+        m_bindlessHeap->release(VulkanBindlessType::SampledImage, m_bindlessIndex);
+    m_bindlessHeap = nullptr;
+    m_bindlessIndex = VulkanBindlessHeap::InvalidIndex;
+
     if (m_image != VK_NULL_HANDLE)
         vkDestroyImage(device, m_image, nullptr);
     if (m_imageView != VK_NULL_HANDLE)
         vkDestroyImageView(device, m_imageView, nullptr);
+    if (m_allocator != nullptr)
+        m_allocator->free(device, m_imageMemory);
 }
 
-void VulkanImage::transitionLayoutTo(VkImageLayout newLayout)
+bool VulkanImage::registerBindless(VulkanBindlessHeap &bindlessHeap, VkImageLayout imageLayout)
 {
-    m_oldLayout = m_currentLayout;
-    m_currentLayout = newLayout;
+    assert(m_imageView != VK_NULL_HANDLE && "The image needs a view to be registered.");
+    assert(m_bindlessHeap == nullptr && "Image already registered.");
 
-    // TODO do layout transition
+    m_bindlessIndex = bindlessHeap.registerImage(m_imageView, imageLayout);
+    if (m_bindlessIndex == VulkanBindlessHeap::InvalidIndex)
+        return false;
+    m_bindlessHeap = &bindlessHeap;
+
+    // Success
+    return true;
+}
+
+void VulkanImage::transition(VulkanBarrierBatch &barriers,
+    VulkanResourceUsage usage,
+    uint32_t baseMipLevel,
+    uint32_t mipLevelCount,
+    uint32_t baseArrayLayer,
+    uint32_t arrayLayerCount,
+    uint32_t queueFamily)
+{
+    if (mipLevelCount == VK_REMAINING_MIP_LEVELS)
+        mipLevelCount = m_imageInfo.mipCount - baseMipLevel;
+    if (arrayLayerCount == VK_REMAINING_ARRAY_LAYERS)
+        arrayLayerCount = m_imageInfo.levelCount - baseArrayLayer;
+    assert(baseMipLevel + mipLevelCount <= m_imageInfo.mipCount && "Mip levels out of range.");
+    assert(baseArrayLayer + arrayLayerCount <= m_imageInfo.levelCount && "Array layers out of range.");
+
+    // Subresources can be in different states - the batch merges the barriers that turn out identical
+    for (uint32_t arrayLayer = baseArrayLayer; arrayLayer < baseArrayLayer + arrayLayerCount; ++arrayLayer)
+    {
+        for (uint32_t mipLevel = baseMipLevel; mipLevel < baseMipLevel + mipLevelCount; ++mipLevel)
+        {
+            const VkImageSubresourceRange range = {
+                m_aspectMask,       // aspectMask
+                mipLevel,           // baseMipLevel
+                1,                  // levelCount
+                arrayLayer,         // baseArrayLayer
+                1                   // layerCount
+            };
+            barriers.image(m_image, range, m_subresourceStates[subresourceIndex(mipLevel, arrayLayer)], usage, queueFamily);
+        }
+    }
+}
+
+void VulkanImage::transitionLayoutTo(VkCommandBuffer commandBuffer, VulkanResourceUsage usage)
+{
+    VulkanBarrierBatch barriers;
+    transition(barriers, usage);
+    barriers.flush(commandBuffer);
+}
+
+bool VulkanImage::upload(VulkanUploadManager &uploadManager,
+    VkImageAspectFlags imageAspect,
+    const void *data,
+    VkDeviceSize dataSize,
+    VkImageLayout finalLayout,
+    VulkanUploadToken &token)
+{
+    // The upload batch does the layout transitions
+    if (uploadManager.uploadImage(m_image,
+        imageAspect,
+        { m_imageInfo.extent.width, m_imageInfo.extent.height, (m_imageInfo.type == VK_IMAGE_TYPE_3D) ? m_imageInfo.extent.depth : 1 },
+        m_imageInfo.levelCount,
+        data,
+        dataSize,
+        finalLayout,
+        token) == false)
+        return false;
+
+    // Mip 0 of every layer was written and moved to the final layout by the upload batch
+    for (uint32_t arrayLayer = 0; arrayLayer < m_imageInfo.levelCount; ++arrayLayer)
+        m_subresourceStates[subresourceIndex(0, arrayLayer)] = uploadedResourceState(finalLayout);
+
+    // Success
+    return true;
 }
 
 bool VulkanImage::createView(VkDevice device,
@@ -162,7 +240,7 @@ bool VulkanImage::createImage(VkDevice device)
     imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     imageCreateInfo.queueFamilyIndexCount = 0;
     imageCreateInfo.pQueueFamilyIndices = nullptr;
-    imageCreateInfo.initialLayout = m_currentLayout;
+    imageCreateInfo.initialLayout = m_subresourceStates[0].layout;
 
     // Create image
     if (vkCreateImage(device, &imageCreateInfo, nullptr, &m_image) != VK_SUCCESS)
@@ -175,44 +253,14 @@ bool VulkanImage::createImage(VkDevice device)
     return true;
 }
 
-bool VulkanImage::allocateImageMemory(const VulkanPhysicalDevice &physicalDevice, VkDevice device, VkMemoryPropertyFlags memoryPropertyFlags)
+bool VulkanImage::allocateImageMemory(VkDevice device, VkMemoryPropertyFlags memoryPropertyFlags)
 {
-    // Get image memory requirements
-
-    // Size, alignment, memory types allowed
-    VkMemoryRequirements imageMemRequirements = {};
-    vkGetImageMemoryRequirements(device, m_image, &imageMemRequirements);
-
-    auto &supportedMemoryTypes = physicalDevice.getMemoryProperties();
-    for (uint32_t i = 0; i < supportedMemoryTypes.memoryTypeCount; ++i)
-    {
-        bool memTypeSupported = imageMemRequirements.memoryTypeBits & (1 << i);
-        bool memTypeHasRequiredProperties = supportedMemoryTypes.memoryTypes[i].propertyFlags & memoryPropertyFlags;
-        if (memTypeSupported && memTypeHasRequiredProperties)
-        {
-            // We found a suitable memory type
-            
-            // Fill the memory allocate information
-            VkMemoryAllocateInfo memoryAllocateInfo = {};
-            memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            memoryAllocateInfo.memoryTypeIndex = i;
-            memoryAllocateInfo.allocationSize = imageMemRequirements.size;
-
-            // Allocate image memory
-            if (vkAllocateMemory(device, &memoryAllocateInfo, nullptr, &m_imageMemory) != VK_SUCCESS)
-            {
-                std::cout << "Failed to allocate image memory.\n";
-                return false;
-            }
-            else
-                break;
-        }
-    }
-
-    // Check if we managed to allocate some image memory, if not stop
-    if (m_imageMemory == VK_NULL_HANDLE)
+    // The allocator queries the image memory requirements (size, alignment, memory types allowed),
+    // picks a suitable memory type and binds the image at an offset inside one of its memory blocks.
+    // Images are always created with optimal tiling.
+    if (m_allocator->allocateForImage(device, m_image, VK_IMAGE_TILING_OPTIMAL, memoryPropertyFlags, m_imageMemory) == false)
     {
-        std::cout << "Failed to find a suitable memory type to use as the image memory.\n";
+        std::cout << "Failed to allocate image memory.\n";
         return false;
     }
 
@@ -6,7 +6,8 @@ VulkanInstance::~VulkanInstance() {}
 
 bool VulkanInstance::init(const std::string &appName, 
     unsigned int engineMajor, unsigned int engineMinor,
-    unsigned int appMajor, unsigned int appMinor)
+    unsigned int appMajor, unsigned int appMinor,
+    bool headless)
 {
     VkResult res = VK_SUCCESS;
 
@@ -16,16 +17,17 @@ bool VulkanInstance::init(const std::string &appName,
         validationLayers = { "VK_LAYER_LUNARG_standard_validation" };
     if (m_enableValidationLayers)
     {
+        // Render farm and CI hosts usually only have the driver installed
         if (checkValidationLayerSupport(validationLayers) == false)
         {
-            std::cout << "Failed to find all the requested validation layers.\n";
-            return false;
+            std::cout << "Failed to find all the requested validation layers. Continuing without them.\n";
+            m_enableValidationLayers = false;
         }
     }
 
-    // Get a list of required extensions by GLFW3
+    // Get a list of required extensions by GLFW3 - GLFW isn't initialized without a window
     uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    const char** glfwExtensions = headless ? nullptr : glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
     
     // Build a list of required extensions
     std::vector<const char*> requestedExtensions;
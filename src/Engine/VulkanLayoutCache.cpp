@@ -0,0 +1,265 @@
+#include "VulkanLayoutCache.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <iostream>
+
+bool VulkanLayoutCache::init(VkDevice device)
+{
+    m_device = device;
+
+    // Success
+    return true;
+}
+
+void VulkanLayoutCache::cleanup(VkDevice device)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto &updateTemplate : m_updateTemplates)
+        vkDestroyDescriptorUpdateTemplate(device, updateTemplate.second, nullptr);
+    m_updateTemplates.clear();
+    m_setLayoutBindings.clear();
+
+    for (auto &pipelineLayout : m_pipelineLayouts)
+        vkDestroyPipelineLayout(device, pipelineLayout.second, nullptr);
+    m_pipelineLayouts.clear();
+
+    for (auto &descriptorSetLayout : m_descriptorSetLayouts)
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout.second, nullptr);
+    m_descriptorSetLayouts.clear();
+}
+
+bool VulkanLayoutCache::getPipelineLayout(const std::vector<const VulkanShaderReflection*> &stages,
+    VkPipelineLayout &pipelineLayout,
+    std::vector<VkDescriptorSetLayout> &setLayouts,
+    std::vector<VkPushConstantRange> &pushConstantRanges,
+    VkDescriptorType uniformBufferType)
+{
+    // Merge the bindings of the stages - a resource used by several stages is visible to all of them
+    std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> sets;
+    pushConstantRanges.clear();
+    for (const VulkanShaderReflection *stage : stages)
+    {
+        for (const auto &set : stage->descriptorSets())
+        {
+            auto &mergedSet = sets[set.first];
+            for (VkDescriptorSetLayoutBinding binding : set.second)
+            {
+                if (binding.descriptorCount == 0)
+                {
+                    std::cout << "Runtime sized descriptor arrays are not supported (set " << set.first << ", binding " << binding.binding << ").\n";
+                    return false;
+                }
+                if (binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+                    binding.descriptorType = uniformBufferType;
+
+                auto mergedBinding = mergedSet.find(binding.binding);
+                if (mergedBinding == mergedSet.end())
+                {
+                    mergedSet[binding.binding] = binding;
+                    continue;
+                }
+                if (mergedBinding->second.descriptorType != binding.descriptorType)
+                {
+                    std::cout << "Shader stages disagree on the type of set " << set.first << ", binding " << binding.binding << ".\n";
+                    return false;
+                }
+                mergedBinding->second.stageFlags |= binding.stageFlags;
+                mergedBinding->second.descriptorCount = std::max(mergedBinding->second.descriptorCount, binding.descriptorCount);
+            }
+        }
+
+        // Ranges declared identically by several stages are shared
+        for (const auto &range : stage->pushConstantRanges())
+        {
+            auto mergedRange = std::find_if(pushConstantRanges.begin(), pushConstantRanges.end(),
+                [&range](const VkPushConstantRange &other) { return other.offset == range.offset && other.size == range.size; });
+            if (mergedRange != pushConstantRanges.end())
+                mergedRange->stageFlags |= range.stageFlags;
+            else
+                pushConstantRanges.push_back(range);
+        }
+    }
+
+    // Set indices are positions in the pipeline layout - unused sets get an empty layout
+    setLayouts.clear();
+    const uint32_t setCount = sets.empty() ? 0 : sets.rbegin()->first + 1;
+    for (uint32_t setIndex = 0; setIndex < setCount; ++setIndex)
+    {
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+        auto set = sets.find(setIndex);
+        if (set != sets.end())
+        {
+            for (const auto &binding : set->second)
+                bindings.push_back(binding.second);
+        }
+
+        const VkDescriptorSetLayout setLayout = getDescriptorSetLayout(bindings);
+        if (setLayout == VK_NULL_HANDLE)
+            return false;
+        setLayouts.push_back(setLayout);
+    }
+
+    pipelineLayout = getPipelineLayout(setLayouts, pushConstantRanges);
+    return pipelineLayout != VK_NULL_HANDLE;
+}
+
+VkDescriptorSetLayout VulkanLayoutCache::getDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings)
+{
+    std::vector<uint64_t> key;
+    key.reserve(bindings.size() * 5);
+    for (const auto &binding : bindings)
+    {
+        key.push_back(binding.binding);
+        key.push_back(binding.descriptorType);
+        key.push_back(binding.descriptorCount);
+        key.push_back(binding.stageFlags);
+        key.push_back(reinterpret_cast<uintptr_t>(binding.pImmutableSamplers));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_descriptorSetLayoutRequests;
+
+    auto cached = m_descriptorSetLayouts.find(key);
+    if (cached != m_descriptorSetLayouts.end())
+        return cached->second;
+
+    // Descriptor set layout - defines the types and number of descriptors in a descriptor set
+    const VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,        // sType
+        nullptr,                                                    // pNext
+        0,                                                          // flags
+        static_cast<uint32_t>(bindings.size()),                     // bindingCount
+        bindings.data()                                             // pBindings
+    };
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    if (vkCreateDescriptorSetLayout(m_device, &descriptorSetLayoutCreateInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create descriptor set layout.\n";
+        return VK_NULL_HANDLE;
+    }
+
+    m_descriptorSetLayouts[key] = descriptorSetLayout;
+    m_setLayoutBindings[descriptorSetLayout] = bindings;
+    return descriptorSetLayout;
+}
+
+VkPipelineLayout VulkanLayoutCache::getPipelineLayout(const std::vector<VkDescriptorSetLayout> &setLayouts, const std::vector<VkPushConstantRange> &pushConstantRanges)
+{
+    // Set layouts come from the cache, so equal layouts have equal handles
+    std::vector<uint64_t> key;
+    key.reserve(1 + setLayouts.size() + pushConstantRanges.size() * 3);
+    key.push_back(setLayouts.size());
+    for (const auto &setLayout : setLayouts)
+        key.push_back((uint64_t)setLayout);
+    for (const auto &range : pushConstantRanges)
+    {
+        key.push_back(range.stageFlags);
+        key.push_back(range.offset);
+        key.push_back(range.size);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_pipelineLayoutRequests;
+
+    auto cached = m_pipelineLayouts.find(key);
+    if (cached != m_pipelineLayouts.end())
+        return cached->second;
+
+    // Pipeline layout - the sequence of descriptor set layouts and push constant ranges
+    // determines the interface between the shader stages and shader resources
+    const VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+        VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,              // sType
+        nullptr,                                                    // pNext
+        0,                                                          // flags
+        static_cast<uint32_t>(setLayouts.size()),                   // setLayoutCount
+        setLayouts.data(),                                          // pSetLayouts
+        static_cast<uint32_t>(pushConstantRanges.size()),           // pushConstantRangeCount
+        pushConstantRanges.data()                                   // pPushConstantRanges
+    };
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    if (vkCreatePipelineLayout(m_device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create pipeline layout.\n";
+        return VK_NULL_HANDLE;
+    }
+
+    m_pipelineLayouts[key] = pipelineLayout;
+    return pipelineLayout;
+}
+
+VkDescriptorUpdateTemplate VulkanLayoutCache::getUpdateTemplate(VkDescriptorSetLayout setLayout)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto cached = m_updateTemplates.find(setLayout);
+    if (cached != m_updateTemplates.end())
+        return cached->second;
+
+    auto bindings = m_setLayoutBindings.find(setLayout);
+    assert(bindings != m_setLayoutBindings.end() && "Descriptor set layout not created by the layout cache.");
+    if (bindings == m_setLayoutBindings.end())
+        return VK_NULL_HANDLE;
+
+    // One entry per binding - the descriptors of a binding are consecutive VulkanDescriptorInfo
+    std::vector<VkDescriptorUpdateTemplateEntry> entries;
+    size_t offset = 0;
+    for (const auto &binding : bindings->second)
+    {
+        entries.push_back({
+            binding.binding,                    // dstBinding
+            0,                                  // dstArrayElement
+            binding.descriptorCount,            // descriptorCount
+            binding.descriptorType,             // descriptorType
+            offset,                             // offset
+            sizeof(VulkanDescriptorInfo)        // stride
+        });
+        offset += binding.descriptorCount * sizeof(VulkanDescriptorInfo);
+    }
+
+    const VkDescriptorUpdateTemplateCreateInfo updateTemplateCreateInfo = {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,      // sType
+        nullptr,                                                        // pNext
+        0,                                                              // flags
+        static_cast<uint32_t>(entries.size()),                          // descriptorUpdateEntryCount
+        entries.data(),                                                 // pDescriptorUpdateEntries
+        VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,              // templateType
+        setLayout,                                                      // descriptorSetLayout
+        VK_PIPELINE_BIND_POINT_GRAPHICS,                                // pipelineBindPoint - push descriptors only
+        VK_NULL_HANDLE,                                                 // pipelineLayout - push descriptors only
+        0                                                               // set - push descriptors only
+    };
+    VkDescriptorUpdateTemplate updateTemplate = VK_NULL_HANDLE;
+    if (vkCreateDescriptorUpdateTemplate(m_device, &updateTemplateCreateInfo, nullptr, &updateTemplate) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create descriptor update template.\n";
+        return VK_NULL_HANDLE;
+    }
+
+    m_updateTemplates[setLayout] = updateTemplate;
+    return updateTemplate;
+}
+
+uint32_t VulkanLayoutCache::descriptorCount(VkDescriptorSetLayout setLayout) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto bindings = m_setLayoutBindings.find(setLayout);
+    if (bindings == m_setLayoutBindings.end())
+        return 0;
+
+    uint32_t count = 0;
+    for (const auto &binding : bindings->second)
+        count += binding.descriptorCount;
+    return count;
+}
+
+void VulkanLayoutCache::printStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::cout << "\nLayout cache: " << m_descriptorSetLayouts.size() << " descriptor set layouts for "
+        << m_descriptorSetLayoutRequests << " requests, " << m_pipelineLayouts.size() << " pipeline layouts for "
+        << m_pipelineLayoutRequests << " requests\n";
+}
\ No newline at end of file
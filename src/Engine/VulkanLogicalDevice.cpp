@@ -7,33 +7,65 @@
 #include <stdio.h>
 
 bool VulkanLogicalDevice::init(VkPhysicalDevice physicalDevice,
-    uint32_t queueFamilyIndex, 
-    uint32_t queueCount)
+    const std::vector<uint32_t> &queueFamilyIndices, 
+    uint32_t queueCount,
+    const VkPhysicalDeviceDescriptorIndexingFeaturesEXT *descriptorIndexingFeatures,
+    bool presentation)
 {
     VkResult res = VK_SUCCESS;
 
-    assert(queueFamilyIndex != -1 && "Invalid queue family index. \n");
+    assert(queueFamilyIndices.empty() == false && "No queue family to create queues from. \n");
     assert(queueCount != 0 && "Invalid queue count. Queue count needs to be >= 1. \n");
 
-    // Device queue
-    VkDeviceQueueCreateInfo queueCreateInfo = {};
-    queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueCreateInfo.queueFamilyIndex = queueFamilyIndex;
-    queueCreateInfo.queueCount = queueCount;
-    queueCreateInfo.flags = 0;
     // Equal queue priorities
     std::vector<float> queuePriorities;
     for (int i = 0; i < queueCount; i++)
         queuePriorities.push_back(1.0f);
-    queueCreateInfo.pQueuePriorities = queuePriorities.data();
+
+    // Device queues - one create info per unique queue family
+    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+    for (auto queueFamilyIndex : queueFamilyIndices)
+    {
+        assert(queueFamilyIndex != -1 && "Invalid queue family index. \n");
+
+        bool alreadyAdded = false;
+        for (auto &queueCreateInfo : queueCreateInfos)
+            alreadyAdded |= (queueCreateInfo.queueFamilyIndex == queueFamilyIndex);
+        if (alreadyAdded)
+            continue;
+
+        VkDeviceQueueCreateInfo queueCreateInfo = {};
+        queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueCreateInfo.queueFamilyIndex = queueFamilyIndex;
+        queueCreateInfo.queueCount = queueCount;
+        queueCreateInfo.flags = 0;
+        queueCreateInfo.pQueuePriorities = queuePriorities.data();
+        queueCreateInfos.push_back(queueCreateInfo);
+    }
+
+    // Timeline semaphores - used to track the submissions of every queue
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {};
+    timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    timelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+
+    // Descriptor indexing - chained after the timeline semaphore features
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT enabledDescriptorIndexingFeatures = {};
+    if (descriptorIndexingFeatures != nullptr)
+    {
+        enabledDescriptorIndexingFeatures = *descriptorIndexingFeatures;
+        enabledDescriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        enabledDescriptorIndexingFeatures.pNext = nullptr;
+        timelineSemaphoreFeatures.pNext = &enabledDescriptorIndexingFeatures;
+    }
 
     // Logical device
     VkPhysicalDeviceFeatures requiredDeviceFeatures = {};
     VkDeviceCreateInfo deviceCreateInfo = {};
     deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceCreateInfo.pNext = &timelineSemaphoreFeatures;
     deviceCreateInfo.pEnabledFeatures = &requiredDeviceFeatures;
-    deviceCreateInfo.queueCreateInfoCount = 1;
-    deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
+    deviceCreateInfo.queueCreateInfoCount = queueCreateInfos.size();
+    deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
     
     // Get device extensions
     uint32_t extensionCount = 0;
@@ -62,7 +94,14 @@ bool VulkanLogicalDevice::init(VkPhysicalDevice physicalDevice,
 
     // Check device specific extensions
     std::vector<const char*> requiredDeviceExtensions;
-    requiredDeviceExtensions = { "VK_KHR_swapchain" };
+    requiredDeviceExtensions = { "VK_KHR_timeline_semaphore" };
+    if (presentation)
+        requiredDeviceExtensions.push_back("VK_KHR_swapchain");
+    if (descriptorIndexingFeatures != nullptr)
+    {
+        requiredDeviceExtensions.push_back("VK_KHR_maintenance3");
+        requiredDeviceExtensions.push_back("VK_EXT_descriptor_indexing");
+    }
     if (checkDeviceExtensionSupport(requiredDeviceExtensions) == false)
     {
         std::cout << "Failed to find all the required device extensions. \n";
@@ -0,0 +1,433 @@
+#include "VulkanMemoryAllocator.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    inline VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Check if the last byte of resource A and the first byte of resource B are on the same "page"
+    inline bool onSamePage(VkDeviceSize offsetA, VkDeviceSize sizeA, VkDeviceSize offsetB, VkDeviceSize pageSize)
+    {
+        const VkDeviceSize endPageA = (offsetA + sizeA - 1) & ~(pageSize - 1);
+        const VkDeviceSize startPageB = offsetB & ~(pageSize - 1);
+        return endPageA == startPageB;
+    }
+
+    inline bool hasGranularityConflict(VulkanResourceType typeA, VulkanResourceType typeB)
+    {
+        if (typeA == VulkanResourceType::Free || typeB == VulkanResourceType::Free)
+            return false;
+        return typeA != typeB;
+    }
+}
+
+bool VulkanMemoryAllocator::init(const VulkanPhysicalDevice &physicalDevice, VkDeviceSize preferredBlockSize)
+{
+    assert(preferredBlockSize > 0 && "Invalid memory block size.");
+
+    m_memoryProperties = physicalDevice.getMemoryProperties();
+    m_bufferImageGranularity = std::max<VkDeviceSize>(physicalDevice.getDeviceProperties().limits.bufferImageGranularity, 1);
+    m_preferredBlockSize = preferredBlockSize;
+    m_driverAllocationCount = 0;
+
+    m_memoryTypes.clear();
+    m_memoryTypes.resize(m_memoryProperties.memoryTypeCount);
+
+    // Success
+    return true;
+}
+
+void VulkanMemoryAllocator::cleanup(VkDevice device)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto &memoryType : m_memoryTypes)
+    {
+        for (auto &block : memoryType.blocks)
+        {
+            if (block->allocationCount != 0)
+                std::cout << "Memory block released with " << block->allocationCount << " live allocations.\n";
+            freeDeviceMemory(device, block->memory, block->mappedData);
+        }
+        memoryType.blocks.clear();
+
+        for (auto &dedicatedAllocation : memoryType.dedicatedAllocations)
+            freeDeviceMemory(device, dedicatedAllocation.memory, dedicatedAllocation.mappedData);
+        memoryType.dedicatedAllocations.clear();
+    }
+}
+
+bool VulkanMemoryAllocator::allocate(VkDevice device,
+    const VkMemoryRequirements &memoryRequirements,
+    VkMemoryPropertyFlags memoryPropertyFlags,
+    VulkanResourceType resourceType,
+    VulkanMemoryAllocation &allocation)
+{
+    assert(memoryRequirements.size != 0 && "Invalid allocation size.");
+    assert(resourceType != VulkanResourceType::Free && "Invalid resource type.");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Try every memory type that is allowed for the resource and has all the required properties.
+    // If the heap of the first one is exhausted we fall back to the next one.
+    for (uint32_t memoryTypeIndex = 0; memoryTypeIndex < m_memoryProperties.memoryTypeCount; ++memoryTypeIndex)
+    {
+        bool memTypeSupported = memoryRequirements.memoryTypeBits & (1 << memoryTypeIndex);
+        bool memTypeHasRequiredProperties =
+            (m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & memoryPropertyFlags) == memoryPropertyFlags;
+        if (memTypeSupported && memTypeHasRequiredProperties)
+        {
+            if (allocateFromType(device, memoryTypeIndex, memoryRequirements, resourceType, allocation))
+                return true;
+        }
+    }
+
+    // Fail
+    std::cout << "Failed to find a memory type that can satisfy the allocation request.\n";
+    return false;
+}
+
+void VulkanMemoryAllocator::free(VkDevice device, VulkanMemoryAllocation &allocation)
+{
+    if (allocation.memory == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto &memoryType = m_memoryTypes[allocation.memoryTypeIndex];
+    if (allocation.block == nullptr)
+    {
+        // Dedicated allocation
+        auto dedicatedIt = std::find_if(memoryType.dedicatedAllocations.begin(), memoryType.dedicatedAllocations.end(),
+            [&allocation](const VulkanMemoryAllocation &dedicated) { return dedicated.memory == allocation.memory; });
+        assert(dedicatedIt != memoryType.dedicatedAllocations.end() && "Unknown dedicated allocation.");
+
+        freeDeviceMemory(device, dedicatedIt->memory, dedicatedIt->mappedData);
+        memoryType.dedicatedAllocations.erase(dedicatedIt);
+    }
+    else
+    {
+        VulkanMemoryBlock &block = *allocation.block;
+        freeFromBlock(block, allocation.offset);
+
+        // Release empty blocks but always keep one around so we don't thrash the driver
+        if (block.allocationCount == 0 && memoryType.blocks.size() > 1)
+        {
+            auto blockIt = std::find_if(memoryType.blocks.begin(), memoryType.blocks.end(),
+                [&block](const std::unique_ptr<VulkanMemoryBlock> &current) { return current.get() == &block; });
+            assert(blockIt != memoryType.blocks.end() && "Unknown memory block.");
+
+            freeDeviceMemory(device, block.memory, block.mappedData);
+            memoryType.blocks.erase(blockIt);
+        }
+    }
+
+    allocation = {};
+}
+
+bool VulkanMemoryAllocator::allocateForBuffer(VkDevice device, VkBuffer buffer, VkMemoryPropertyFlags memoryPropertyFlags, VulkanMemoryAllocation &allocation)
+{
+    VkMemoryRequirements memoryRequirements = {};
+    vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
+
+    if (allocate(device, memoryRequirements, memoryPropertyFlags, VulkanResourceType::Linear, allocation) == false)
+        return false;
+
+    // Bind the buffer at its offset inside the memory block
+    if (vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset) != VK_SUCCESS)
+    {
+        std::cout << "Failed to bind allocated memory to buffer.\n";
+        free(device, allocation);
+        return false;
+    }
+
+    // Success
+    return true;
+}
+
+bool VulkanMemoryAllocator::allocateForImage(VkDevice device, VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags memoryPropertyFlags, VulkanMemoryAllocation &allocation)
+{
+    VkMemoryRequirements memoryRequirements = {};
+    vkGetImageMemoryRequirements(device, image, &memoryRequirements);
+
+    const VulkanResourceType resourceType = (tiling == VK_IMAGE_TILING_OPTIMAL) ? VulkanResourceType::Optimal : VulkanResourceType::Linear;
+    if (allocate(device, memoryRequirements, memoryPropertyFlags, resourceType, allocation) == false)
+        return false;
+
+    // Bind the image at its offset inside the memory block
+    if (vkBindImageMemory(device, image, allocation.memory, allocation.offset) != VK_SUCCESS)
+    {
+        std::cout << "Failed to bind allocated memory to image.\n";
+        free(device, allocation);
+        return false;
+    }
+
+    // Success
+    return true;
+}
+
+std::vector<VulkanHeapStatistics> VulkanMemoryAllocator::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<VulkanHeapStatistics> heapStatistics(m_memoryProperties.memoryHeapCount);
+    for (uint32_t heapIndex = 0; heapIndex < m_memoryProperties.memoryHeapCount; ++heapIndex)
+        heapStatistics[heapIndex].heapSize = m_memoryProperties.memoryHeaps[heapIndex].size;
+
+    for (uint32_t memoryTypeIndex = 0; memoryTypeIndex < m_memoryTypes.size(); ++memoryTypeIndex)
+    {
+        auto &memoryType = m_memoryTypes[memoryTypeIndex];
+        auto &stats = heapStatistics[m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex];
+
+        for (auto &block : memoryType.blocks)
+        {
+            stats.reservedBytes += block->size;
+            stats.usedBytes += block->usedBytes;
+            stats.allocationCount += block->allocationCount;
+            stats.blockCount++;
+        }
+        for (auto &dedicatedAllocation : memoryType.dedicatedAllocations)
+        {
+            stats.reservedBytes += dedicatedAllocation.size;
+            stats.usedBytes += dedicatedAllocation.size;
+            stats.allocationCount++;
+            stats.dedicatedAllocationCount++;
+        }
+    }
+
+    return heapStatistics;
+}
+
+void VulkanMemoryAllocator::printStatistics() const
+{
+    auto heapStatistics = getStatistics();
+
+    std::cout << "\nDevice memory statistics (" << driverAllocationCount() << " driver allocations): \n";
+    for (auto &stats : heapStatistics)
+    {
+        size_t heapIndex = &stats - heapStatistics.data();
+        std::cout << "Heap " << heapIndex << ": "
+            << stats.usedBytes / 1024 << " KB used / "
+            << stats.reservedBytes / 1024 << " KB reserved / "
+            << stats.heapSize / (1024 * 1024) << " MB total, "
+            << stats.blockCount << " blocks, "
+            << stats.dedicatedAllocationCount << " dedicated, "
+            << stats.allocationCount << " allocations\n";
+    }
+}
+
+bool VulkanMemoryAllocator::allocateFromType(VkDevice device,
+    uint32_t memoryTypeIndex,
+    const VkMemoryRequirements &memoryRequirements,
+    VulkanResourceType resourceType,
+    VulkanMemoryAllocation &allocation)
+{
+    auto &memoryType = m_memoryTypes[memoryTypeIndex];
+    const VkDeviceSize blockSize = blockSizeForType(memoryTypeIndex);
+
+    allocation.memoryTypeIndex = memoryTypeIndex;
+    allocation.size = memoryRequirements.size;
+
+    // Big resources get their own memory object, sub-allocating them would just waste block space
+    if (memoryRequirements.size > blockSize / 2)
+    {
+        allocation.offset = 0;
+        allocation.block = nullptr;
+        if (allocateDeviceMemory(device, memoryTypeIndex, memoryRequirements.size, allocation.memory, &allocation.mappedData) == false)
+            return false;
+
+        memoryType.dedicatedAllocations.push_back(allocation);
+
+        // Success
+        return true;
+    }
+
+    // First fit in the existing blocks
+    VkDeviceSize offset = 0;
+    for (auto &block : memoryType.blocks)
+    {
+        if (block->size - block->usedBytes < memoryRequirements.size)
+            continue;
+
+        if (allocateFromBlock(*block, memoryRequirements.size, memoryRequirements.alignment, resourceType, offset))
+        {
+            allocation.memory = block->memory;
+            allocation.offset = offset;
+            allocation.block = block.get();
+            allocation.mappedData = (block->mappedData != nullptr) ? static_cast<char*>(block->mappedData) + offset : nullptr;
+
+            // Success
+            return true;
+        }
+    }
+
+    // No room left - allocate a new block. If the driver refuses, retry with smaller blocks.
+    std::unique_ptr<VulkanMemoryBlock> newBlock = std::make_unique<VulkanMemoryBlock>();
+    VkDeviceSize newBlockSize = blockSize;
+    while (allocateDeviceMemory(device, memoryTypeIndex, newBlockSize, newBlock->memory, &newBlock->mappedData) == false)
+    {
+        newBlockSize /= 2;
+        if (newBlockSize < memoryRequirements.size)
+            return false;
+    }
+    newBlock->size = newBlockSize;
+    newBlock->suballocations.push_back({ 0, newBlockSize, VulkanResourceType::Free });
+
+    if (allocateFromBlock(*newBlock, memoryRequirements.size, memoryRequirements.alignment, resourceType, offset) == false)
+    {
+        freeDeviceMemory(device, newBlock->memory, newBlock->mappedData);
+        return false;
+    }
+
+    allocation.memory = newBlock->memory;
+    allocation.offset = offset;
+    allocation.block = newBlock.get();
+    allocation.mappedData = (newBlock->mappedData != nullptr) ? static_cast<char*>(newBlock->mappedData) + offset : nullptr;
+    memoryType.blocks.push_back(std::move(newBlock));
+
+    // Success
+    return true;
+}
+
+bool VulkanMemoryAllocator::allocateDeviceMemory(VkDevice device, uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory &memory, void **mappedData)
+{
+    VkMemoryAllocateInfo memAllocInfo = {};
+    memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAllocInfo.memoryTypeIndex = memoryTypeIndex;
+    memAllocInfo.allocationSize = size;
+    if (vkAllocateMemory(device, &memAllocInfo, nullptr, &memory) != VK_SUCCESS)
+        return false;
+    m_driverAllocationCount++;
+
+    // Host visible memory is mapped once and stays mapped until the memory is released
+    *mappedData = nullptr;
+    if (m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mappedData) != VK_SUCCESS)
+        {
+            std::cout << "Failed to map host visible memory block.\n";
+            freeDeviceMemory(device, memory, nullptr);
+            memory = VK_NULL_HANDLE;
+            return false;
+        }
+    }
+
+    // Success
+    return true;
+}
+
+void VulkanMemoryAllocator::freeDeviceMemory(VkDevice device, VkDeviceMemory memory, void *mappedData)
+{
+    if (memory == VK_NULL_HANDLE)
+        return;
+
+    if (mappedData != nullptr)
+        vkUnmapMemory(device, memory);
+    vkFreeMemory(device, memory, nullptr);
+    m_driverAllocationCount--;
+}
+
+bool VulkanMemoryAllocator::allocateFromBlock(VulkanMemoryBlock &block,
+    VkDeviceSize size,
+    VkDeviceSize alignment,
+    VulkanResourceType resourceType,
+    VkDeviceSize &offset)
+{
+    alignment = std::max<VkDeviceSize>(alignment, 1);
+
+    for (auto it = block.suballocations.begin(); it != block.suballocations.end(); ++it)
+    {
+        if (it->type != VulkanResourceType::Free || it->size < size)
+            continue;
+
+        VkDeviceSize allocOffset = alignUp(it->offset, alignment);
+
+        // Previous neighbour - a linear and an optimal resource can't share a granularity page
+        if (m_bufferImageGranularity > 1 && it != block.suballocations.begin())
+        {
+            auto prevIt = std::prev(it);
+            if (hasGranularityConflict(prevIt->type, resourceType) &&
+                onSamePage(prevIt->offset, prevIt->size, allocOffset, m_bufferImageGranularity))
+                allocOffset = alignUp(allocOffset, m_bufferImageGranularity);
+        }
+
+        // Check if the aligned allocation still fits in the free range
+        if (allocOffset + size > it->offset + it->size)
+            continue;
+
+        // Next neighbour
+        auto nextIt = std::next(it);
+        if (m_bufferImageGranularity > 1 && nextIt != block.suballocations.end())
+        {
+            if (hasGranularityConflict(resourceType, nextIt->type) &&
+                onSamePage(allocOffset, size, nextIt->offset, m_bufferImageGranularity))
+                continue;
+        }
+
+        // Split the free range into [padding][allocation][remainder]
+        const VkDeviceSize padding = allocOffset - it->offset;
+        const VkDeviceSize remainder = (it->offset + it->size) - (allocOffset + size);
+
+        if (padding > 0)
+            block.suballocations.insert(it, { it->offset, padding, VulkanResourceType::Free });
+        if (remainder > 0)
+            block.suballocations.insert(nextIt, { allocOffset + size, remainder, VulkanResourceType::Free });
+
+        it->offset = allocOffset;
+        it->size = size;
+        it->type = resourceType;
+
+        block.usedBytes += size;
+        block.allocationCount++;
+        offset = allocOffset;
+
+        // Success
+        return true;
+    }
+
+    return false;
+}
+
+void VulkanMemoryAllocator::freeFromBlock(VulkanMemoryBlock &block, VkDeviceSize offset)
+{
+    auto it = std::find_if(block.suballocations.begin(), block.suballocations.end(),
+        [offset](const VulkanSuballocation &suballocation) { return suballocation.offset == offset && suballocation.type != VulkanResourceType::Free; });
+    assert(it != block.suballocations.end() && "Freeing an unknown suballocation.");
+
+    block.usedBytes -= it->size;
+    block.allocationCount--;
+    it->type = VulkanResourceType::Free;
+
+    // Merge with the next free range
+    auto nextIt = std::next(it);
+    if (nextIt != block.suballocations.end() && nextIt->type == VulkanResourceType::Free)
+    {
+        it->size += nextIt->size;
+        block.suballocations.erase(nextIt);
+    }
+
+    // Merge with the previous free range
+    if (it != block.suballocations.begin())
+    {
+        auto prevIt = std::prev(it);
+        if (prevIt->type == VulkanResourceType::Free)
+        {
+            prevIt->size += it->size;
+            block.suballocations.erase(it);
+        }
+    }
+}
+
+VkDeviceSize VulkanMemoryAllocator::blockSizeForType(uint32_t memoryTypeIndex) const
+{
+    // Don't let a single block take up a big chunk of small heaps
+    const uint32_t heapIndex = m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    const VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[heapIndex].size;
+    return std::min(m_preferredBlockSize, std::max<VkDeviceSize>(heapSize / 8, 1));
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <string.h>
 
 bool VulkanPhysicalDevice::init(VkInstance instance, 
     VkQueueFlags requiredQueueFamilyFlags, 
@@ -61,6 +62,14 @@ bool VulkanPhysicalDevice::init(VkInstance instance,
             std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
             vkGetPhysicalDeviceQueueFamilyProperties(currentDevice, &queueFamilyCount, queueFamilyProperties.data());
 
+            // Headless - any device will do
+            if (surface == VK_NULL_HANDLE)
+            {
+                currenDeviceRank.physicalDevice = currentDevice;
+                physicalDeviceRanks.push_back(currenDeviceRank);
+                continue;
+            }
+
             // Only add devices that have presentation support
             for (auto &queueFamilyProperty : queueFamilyProperties)
             {
@@ -109,6 +118,10 @@ bool VulkanPhysicalDevice::init(VkInstance instance,
 
     // Get the memory properties supported by the chosen physical device
     vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+    // Get the properties and limits of the chosen physical device
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &m_deviceProperties);
+    // Optional features
+    queryDescriptorIndexingSupport();
 
     // Initialize queue family indices
     if (!findQueueFamilies(requiredQueueFamilyFlags, surface))
@@ -122,7 +135,38 @@ bool VulkanPhysicalDevice::hasRequiredFeatures(VkPhysicalDevice &physicalDevice,
     VkPhysicalDeviceFeatures &deviceFeatures,
     uint16_t &deviceScore)
 {
-    // Add specific features to be tested here
+    // Features2 is a Vulkan 1.1 entry point
+    if (VK_VERSION_MAJOR(deviceProperties.apiVersion) == 1 && VK_VERSION_MINOR(deviceProperties.apiVersion) < 1)
+        return false;
+
+    // Timeline semaphores - every queue tracks its submissions with one
+    uint32_t extensionCount = 0;
+    if (vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr) != VK_SUCCESS)
+        return false;
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    if (vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data()) != VK_SUCCESS)
+        return false;
+
+    const bool timelineExtensionFound = std::any_of(extensions.begin(), extensions.end(), [](const VkExtensionProperties &extension) {
+        return strcmp(extension.extensionName, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0;
+    });
+    if (timelineExtensionFound == false)
+    {
+        std::cout << deviceProperties.deviceName << " has no timeline semaphore support. \n";
+        return false;
+    }
+
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {};
+    timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    VkPhysicalDeviceFeatures2 features = {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &timelineSemaphoreFeatures;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+    if (timelineSemaphoreFeatures.timelineSemaphore == VK_FALSE)
+    {
+        std::cout << deviceProperties.deviceName << " has no timeline semaphore support. \n";
+        return false;
+    }
 
     // Calculate score
     if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
@@ -174,7 +218,7 @@ bool VulkanPhysicalDevice::findQueueFamilies(VkQueueFlags requiredQueueFamilyFla
             int queueFamilyIndex = &queueFamilyProp - &queueFamilyProperties[0];
 
             // Check if the current queue family has presentation support
-            if (m_presentationQueueFamilyIndex == -1)
+            if (m_presentationQueueFamilyIndex == -1 && surface != VK_NULL_HANDLE)
             {
                 VkBool32 presentationSupport = VK_FALSE;
                 VkResult res = vkGetPhysicalDeviceSurfaceSupportKHR(m_physicalDevice, queueFamilyIndex, surface, &presentationSupport);
@@ -202,22 +246,111 @@ bool VulkanPhysicalDevice::findQueueFamilies(VkQueueFlags requiredQueueFamilyFla
                 m_graphicsQueueFamilyIndex = &queueFamilyProp - &queueFamilyProperties[0];
             }
 
-            if (m_presentationQueueFamilyIndex != -1 &&
+            if ((m_presentationQueueFamilyIndex != -1 || surface == VK_NULL_HANDLE) &&
                 m_graphicsQueueFamilyIndex != -1)
                 break;
         }
     }
 
+    // Transfer only queue family - usually backed by the DMA engines so copies can run next to rendering
+    for (auto &queueFamilyProp : queueFamilyProperties)
+    {
+        if (queueFamilyProp.queueCount > 0 &&
+            (queueFamilyProp.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+            (queueFamilyProp.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0)
+        {
+            m_transferQueueFamilyIndex = &queueFamilyProp - &queueFamilyProperties[0];
+            break;
+        }
+    }
+
     if (m_graphicsQueueFamilyIndex == -1)
     {
         std::cout << "Failed to find a queue family that satisfies all the requirements. \n";
         return false;
     }
-    if (m_presentationQueueFamilyIndex == -1)
+    if (m_presentationQueueFamilyIndex == -1 && surface != VK_NULL_HANDLE)
     {
         std::cout << "Failed to find a queue family that has presentation support. \n";
         return false;
     }
 
     return true;
+}
+
+void VulkanPhysicalDevice::queryDescriptorIndexingSupport()
+{
+    m_descriptorIndexingSupported = false;
+
+    uint32_t extensionCount = 0;
+    if (vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, nullptr) != VK_SUCCESS)
+        return;
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    if (vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, extensions.data()) != VK_SUCCESS)
+        return;
+
+    const bool extensionFound = std::any_of(extensions.begin(), extensions.end(), [](const VkExtensionProperties &extension) {
+        return strcmp(extension.extensionName, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) == 0;
+    });
+    if (extensionFound == false)
+        return;
+
+    // Features and limits of the extension - Vulkan 1.1 entry points
+    m_descriptorIndexingFeatures = {};
+    m_descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    VkPhysicalDeviceFeatures2 features = {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &m_descriptorIndexingFeatures;
+    vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+
+    m_descriptorIndexingProperties = {};
+    m_descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2 properties = {};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &m_descriptorIndexingProperties;
+    vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+    m_descriptorIndexingFeatures.pNext = nullptr;
+    m_descriptorIndexingProperties.pNext = nullptr;
+
+    // Large arrays indexed from the shaders, written while the frames in flight use other elements
+    m_descriptorIndexingSupported = m_descriptorIndexingFeatures.runtimeDescriptorArray &&
+        m_descriptorIndexingFeatures.descriptorBindingPartiallyBound &&
+        m_descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending &&
+        m_descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+        m_descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind;
+}
+
+VkFormat VulkanPhysicalDevice::findSupportedFormat(const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const
+{
+    for (VkFormat format : candidates)
+    {
+        VkFormatProperties formatProperties = {};
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProperties);
+
+        const VkFormatFeatureFlags tilingFeatures = (tiling == VK_IMAGE_TILING_LINEAR) ? formatProperties.linearTilingFeatures : formatProperties.optimalTilingFeatures;
+        if ((tilingFeatures & features) == features)
+            return format;
+    }
+
+    return VK_FORMAT_UNDEFINED;
+}
+
+VkFormat VulkanPhysicalDevice::findDepthFormat(bool needsStencil) const
+{
+    // D32 is always precise enough, the packed formats are only picked if it isn't there (or a stencil is needed)
+    const std::vector<VkFormat> depthFormats = {
+        VK_FORMAT_D32_SFLOAT,
+        VK_FORMAT_D32_SFLOAT_S8_UINT,
+        VK_FORMAT_D24_UNORM_S8_UINT,
+        VK_FORMAT_D16_UNORM
+    };
+    const std::vector<VkFormat> depthStencilFormats = {
+        VK_FORMAT_D24_UNORM_S8_UINT,
+        VK_FORMAT_D32_SFLOAT_S8_UINT,
+        VK_FORMAT_D16_UNORM_S8_UINT
+    };
+
+    return findSupportedFormat(needsStencil ? depthStencilFormats : depthFormats, 
+        VK_IMAGE_TILING_OPTIMAL, 
+        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 }
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "VulkanPipelineCache.h"
+
+#include <assert.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+bool VulkanPipelineCache::init(VkDevice device, const VulkanPhysicalDevice &physicalDevice, const std::string &filename)
+{
+    assert(filename.length() != 0 && "Invalid pipeline cache file path.");
+
+    const auto loadStart = std::chrono::steady_clock::now();
+
+    m_filename = filename;
+
+    // Only hand data written by the same device and driver to the driver
+    std::vector<char> cacheData = readFile(filename);
+    if (cacheData.empty())
+    {
+        m_state = VulkanPipelineCacheState::Cold;
+    }
+    else if (isCompatible(cacheData, physicalDevice) == false)
+    {
+        m_state = VulkanPipelineCacheState::Invalidated;
+        cacheData.clear();
+    }
+    else
+    {
+        m_state = VulkanPipelineCacheState::Warm;
+    }
+    m_loadedBytes = cacheData.size();
+
+    VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
+    pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    pipelineCacheCreateInfo.flags = 0;
+    pipelineCacheCreateInfo.initialDataSize = cacheData.size();
+    pipelineCacheCreateInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+
+    if (vkCreatePipelineCache(device, &pipelineCacheCreateInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create pipeline cache.\n";
+        return false;
+    }
+
+    m_loadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+    // Success
+    return true;
+}
+
+bool VulkanPipelineCache::save(VkDevice device)
+{
+    if (m_pipelineCache == VK_NULL_HANDLE)
+        return false;
+
+    // Get cache size
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(device, m_pipelineCache, &dataSize, nullptr) != VK_SUCCESS)
+    {
+        std::cout << "Failed to get the pipeline cache size.\n";
+        return false;
+    }
+
+    // Get cache data
+    std::vector<char> cacheData(dataSize);
+    if (vkGetPipelineCacheData(device, m_pipelineCache, &dataSize, cacheData.data()) != VK_SUCCESS)
+    {
+        std::cout << "Failed to get the pipeline cache data.\n";
+        return false;
+    }
+    cacheData.resize(dataSize);
+
+    return writeFile(m_filename, cacheData);
+}
+
+void VulkanPipelineCache::cleanup(VkDevice device)
+{
+    if (m_pipelineCache != VK_NULL_HANDLE)
+        vkDestroyPipelineCache(device, m_pipelineCache, nullptr);
+    m_pipelineCache = VK_NULL_HANDLE;
+}
+
+void VulkanPipelineCache::addPipelineCreation(double milliseconds)
+{
+    m_pipelineCount += 1;
+    m_creationMicroseconds += static_cast<uint64_t>(milliseconds * 1000.0);
+}
+
+void VulkanPipelineCache::printStatistics() const
+{
+    static const char *stateNames[] = { "cold", "invalidated", "warm" };
+
+    std::cout << "\nPipeline cache: " << stateNames[static_cast<int>(m_state)] 
+        << ", " << m_loadedBytes << " bytes loaded in " << m_loadMilliseconds << " ms\n";
+    std::cout << "Pipelines created: " << m_pipelineCount 
+        << " in " << (m_creationMicroseconds / 1000.0) << " ms\n";
+}
+
+bool VulkanPipelineCache::isCompatible(const std::vector<char> &cacheData, const VulkanPhysicalDevice &physicalDevice) const
+{
+    // Header written by the driver at the beginning of the cache data
+    //  - uint32_t header size
+    //  - uint32_t VkPipelineCacheHeaderVersion
+    //  - uint32_t vendor id
+    //  - uint32_t device id
+    //  - uint8_t[VK_UUID_SIZE] pipeline cache UUID - changes with the driver version
+    const size_t headerSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+    if (cacheData.size() < headerSize)
+        return false;
+
+    uint32_t header[4] = {};
+    memcpy(header, cacheData.data(), sizeof(header));
+
+    const VkPhysicalDeviceProperties &deviceProperties = physicalDevice.getDeviceProperties();
+    if (header[0] < headerSize ||
+        header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        header[2] != deviceProperties.vendorID ||
+        header[3] != deviceProperties.deviceID)
+        return false;
+
+    return memcmp(cacheData.data() + 4 * sizeof(uint32_t), deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+std::vector<char> VulkanPipelineCache::readFile(const std::string &filename) const
+{
+    std::vector<char> data;
+
+    // A missing file is a cold start
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (file.is_open() == false)
+        return data;
+
+    size_t fileSize = (size_t)file.tellg();
+    data.resize(fileSize);
+    file.seekg(0);
+    file.read(data.data(), fileSize);
+    if (file.good() == false)
+        data.clear();
+
+    return data;
+}
+
+bool VulkanPipelineCache::writeFile(const std::string &filename, const std::vector<char> &data) const
+{
+    // Write next to the cache and swap, a crash while saving must not leave a truncated cache behind
+    const std::string tempFilename = filename + ".tmp";
+    {
+        std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+        if (file.is_open() == false)
+        {
+            std::cout << "Unable to open file: " << tempFilename << "\n";
+            return false;
+        }
+        file.write(data.data(), data.size());
+        if (file.good() == false)
+        {
+            std::cout << "Failed to write the pipeline cache.\n";
+            return false;
+        }
+    }
+
+    // POSIX rename replaces the old cache atomically. Windows refuses to rename over an existing
+    // file, the old one is only removed there and only after the rename failed.
+    bool renamed = std::rename(tempFilename.c_str(), filename.c_str()) == 0;
+#ifdef _WIN32
+    if (renamed == false)
+    {
+        std::remove(filename.c_str());
+        renamed = std::rename(tempFilename.c_str(), filename.c_str()) == 0;
+    }
+#endif
+    if (renamed == false)
+    {
+        std::cout << "Failed to replace the pipeline cache file.\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,477 @@
+#include "VulkanPipelineRegistry.h"
+#include "CpuProfiler.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <system_error>
+
+namespace
+{
+    template <typename T>
+    void appendValue(std::vector<uint8_t> &key, const T &value)
+    {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t*>(&value);
+        key.insert(key.end(), bytes, bytes + sizeof(T));
+    }
+
+    void appendBytes(std::vector<uint8_t> &key, const void *data, size_t size)
+    {
+        appendValue(key, static_cast<uint64_t>(size));
+        const uint8_t *bytes = reinterpret_cast<const uint8_t*>(data);
+        key.insert(key.end(), bytes, bytes + size);
+    }
+
+    void appendStencilOpState(std::vector<uint8_t> &key, const VkStencilOpState &state)
+    {
+        appendValue(key, state.failOp);
+        appendValue(key, state.passOp);
+        appendValue(key, state.depthFailOp);
+        appendValue(key, state.compareOp);
+        appendValue(key, state.compareMask);
+        appendValue(key, state.writeMask);
+        appendValue(key, state.reference);
+    }
+}
+
+VkPipeline VulkanPipelineHandle::get() const
+{
+    if (m_entry != nullptr && status() == VulkanPipelineStatus::Ready)
+        return m_entry->pipeline.get();
+
+    // Drawn without the real pipeline
+    if (m_registry != nullptr)
+    {
+        if (m_fallback != VK_NULL_HANDLE)
+            m_registry->m_fallbackDrawCount.fetch_add(1, std::memory_order_relaxed);
+        else
+            m_registry->m_skippedDrawCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return m_fallback;
+}
+
+bool VulkanPipelineRegistry::init(VkDevice device, VulkanTimeline &graphicsTimeline, VulkanPipelineCache *pipelineCache, uint32_t compileThreadCount)
+{
+    m_device = device;
+    m_graphicsTimeline = &graphicsTimeline;
+    m_pipelineCache = pipelineCache;
+    m_stopCompiling = false;
+
+    for (uint32_t threadIndex = 0; threadIndex < compileThreadCount; ++threadIndex)
+    {
+        try
+        {
+            m_compileThreads.emplace_back(&VulkanPipelineRegistry::compileThreadLoop, this);
+        }
+        catch (const std::system_error &error)
+        {
+            std::cout << "Failed to start pipeline compile thread: " << error.what() << "\n";
+            return false;
+        }
+    }
+
+    // Success
+    return true;
+}
+
+void VulkanPipelineRegistry::cleanup(VkDevice device)
+{
+    // Compile threads - finish the compilation in progress
+    stopCompileThreads();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto &entry : m_compileQueue)
+        entry->status.store(VulkanPipelineStatus::Failed, std::memory_order_release);
+    m_compileQueue.clear();
+    m_readyCondition.notify_all();
+
+    for (auto &bucket : m_entries)
+    {
+        for (auto &entry : bucket.second)
+        {
+            if (entry->refCount != 0)
+                std::cout << "Pipeline destroyed with " << entry->refCount << " references left.\n";
+            entry->pipeline.cleanup(device);
+        }
+    }
+    m_entries.clear();
+    m_entryCount = 0;
+    m_retiredCount = 0;
+}
+
+VulkanPipelineHandle VulkanPipelineRegistry::acquire(const VulkanPipelineDesc &desc)
+{
+    bool created = false;
+    VulkanPipelineHandle handle = acquireEntry(desc, created);
+
+    // New state - compiled on the calling thread rather than behind the compile queue
+    if (created)
+        compile(*handle.m_entry, false);
+
+    if (wait(handle) == false)
+        release(handle);
+    return handle;
+}
+
+VulkanPipelineHandle VulkanPipelineRegistry::acquireAsync(const VulkanPipelineDesc &desc, VkPipeline fallback)
+{
+    bool created = false;
+    VulkanPipelineHandle handle = acquireEntry(desc, created);
+    handle.m_fallback = fallback;
+
+    if (created)
+    {
+        if (m_compileThreads.empty())
+        {
+            compile(*handle.m_entry, false);
+        }
+        else
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_compileQueue.push_back(handle.m_entry);
+            }
+            m_compileCondition.notify_one();
+        }
+    }
+
+    return handle;
+}
+
+bool VulkanPipelineRegistry::wait(const VulkanPipelineHandle &handle)
+{
+    if (handle.valid() == false)
+        return false;
+    if (handle.status() != VulkanPipelineStatus::Pending)
+        return handle.status() == VulkanPipelineStatus::Ready;
+
+    // The caller stalls until a compile thread is done
+    const auto waitStart = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_readyCondition.wait(lock, [&handle]() { return handle.status() != VulkanPipelineStatus::Pending; });
+    ++m_blockingWaitCount;
+    m_blockingWaitMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+
+    return handle.status() == VulkanPipelineStatus::Ready;
+}
+
+void VulkanPipelineRegistry::release(VulkanPipelineHandle &handle)
+{
+    if (handle.valid() == false)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        VulkanPipelineEntry &entry = *handle.m_entry;
+        assert(entry.refCount != 0 && "Pipeline released too many times.");
+        if (--entry.refCount == 0)
+        {
+            // Frames submitted so far may still bind it
+            entry.retireValue = m_graphicsTimeline->lastSubmittedValue();
+            ++m_retiredCount;
+        }
+    }
+
+    handle = VulkanPipelineHandle();
+}
+
+void VulkanPipelineRegistry::collectGarbage()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_retiredCount == 0)
+        return;
+
+    for (auto bucketIt = m_entries.begin(); bucketIt != m_entries.end();)
+    {
+        auto &bucket = bucketIt->second;
+        for (auto entryIt = bucket.begin(); entryIt != bucket.end();)
+        {
+            VulkanPipelineEntry &entry = **entryIt;
+            // Pipelines still compiling are destroyed once they are done
+            if (entry.refCount != 0 || 
+                entry.status.load(std::memory_order_acquire) == VulkanPipelineStatus::Pending ||
+                m_graphicsTimeline->hasCompleted(entry.retireValue) == false)
+            {
+                ++entryIt;
+                continue;
+            }
+
+            entry.pipeline.cleanup(m_device);
+            entryIt = bucket.erase(entryIt);
+            --m_entryCount;
+            --m_retiredCount;
+            ++m_destroyedCount;
+        }
+
+        if (bucket.empty())
+            bucketIt = m_entries.erase(bucketIt);
+        else
+            ++bucketIt;
+    }
+}
+
+void VulkanPipelineRegistry::printStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::cout << "\nPipeline registry: " << m_entryCount << " pipelines alive, "
+        << m_destroyedCount << " destroyed\n";
+    std::cout << "Pipeline requests: " << m_hitCount << " hits, " << m_missCount << " misses\n";
+    std::cout << "Background compilations: " << m_asyncCompileCount;
+    if (m_asyncCompileCount != 0)
+    {
+        std::cout << ", ready after " << (m_totalReadyMilliseconds / m_asyncCompileCount) 
+            << " ms on average, " << m_maxReadyMilliseconds << " ms max";
+    }
+    std::cout << "\n";
+    std::cout << "Pipeline hitches: " << m_blockingWaitCount << " blocking waits (" << m_blockingWaitMilliseconds << " ms), "
+        << m_fallbackDrawCount << " fallback draws, " << m_skippedDrawCount << " skipped draws\n";
+}
+
+VulkanPipelineHandle VulkanPipelineRegistry::acquireEntry(const VulkanPipelineDesc &desc, bool &created)
+{
+    std::vector<uint8_t> key;
+    buildKey(desc, key);
+    const uint64_t hash = hashKey(key);
+
+    VulkanPipelineHandle handle;
+    handle.m_registry = this;
+    created = false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Hit - the same state was requested before, it may still be compiling
+    auto &bucket = m_entries[hash];
+    for (auto &entry : bucket)
+    {
+        if (entry->key != key)
+            continue;
+
+        // Revive a pipeline waiting to be destroyed
+        if (entry->refCount == 0)
+            --m_retiredCount;
+        ++entry->refCount;
+        ++m_hitCount;
+        handle.m_entry = entry;
+        return handle;
+    }
+
+    // Miss - the caller compiles it
+    std::shared_ptr<VulkanPipelineEntry> entry = std::make_shared<VulkanPipelineEntry>();
+    copyDesc(desc, *entry);
+    entry->key = std::move(key);
+    entry->hash = hash;
+    entry->refCount = 1;
+    entry->requestTime = std::chrono::steady_clock::now();
+    bucket.push_back(entry);
+    ++m_entryCount;
+    ++m_missCount;
+    created = true;
+
+    handle.m_entry = entry;
+    return handle;
+}
+
+bool VulkanPipelineRegistry::compile(VulkanPipelineEntry &entry, bool async)
+{
+    VkRenderPass renderPass = entry.desc.renderPass;
+    const bool compiled = entry.pipeline.init(m_device,
+        entry.desc.width, entry.desc.height,
+        entry.desc.vertexInputState,
+        entry.desc.depthStencilState,
+        entry.desc.shaderStagesInfo,
+        entry.desc.colorBlendStates,
+        entry.desc.dynamicStates,
+        entry.desc.sampleCount,
+        entry.desc.pipelineLayout,
+        renderPass,
+        m_pipelineCache);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Time the requester went without the pipeline, including the time spent in the queue
+        if (async)
+        {
+            const double readyMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - entry.requestTime).count();
+            ++m_asyncCompileCount;
+            m_totalReadyMilliseconds += readyMilliseconds;
+            m_maxReadyMilliseconds = std::max(m_maxReadyMilliseconds, readyMilliseconds);
+        }
+
+        entry.status.store(compiled ? VulkanPipelineStatus::Ready : VulkanPipelineStatus::Failed, std::memory_order_release);
+    }
+    m_readyCondition.notify_all();
+
+    return compiled;
+}
+
+void VulkanPipelineRegistry::compileThreadLoop()
+{
+    CPU_PROFILE_THREAD("Pipeline compile");
+    for (;;)
+    {
+        std::shared_ptr<VulkanPipelineEntry> entry;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_compileCondition.wait(lock, [this]() { return m_stopCompiling || m_compileQueue.empty() == false; });
+            if (m_stopCompiling)
+                return;
+
+            entry = m_compileQueue.front();
+            m_compileQueue.pop_front();
+        }
+
+        // The pipeline cache is internally synchronized - all the threads share it
+        CPU_PROFILE_SCOPE("Compile pipeline");
+        compile(*entry, true);
+    }
+}
+
+void VulkanPipelineRegistry::stopCompileThreads()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopCompiling = true;
+    }
+    m_compileCondition.notify_all();
+
+    for (auto &compileThread : m_compileThreads)
+    {
+        if (compileThread.joinable())
+            compileThread.join();
+    }
+    m_compileThreads.clear();
+}
+
+void VulkanPipelineRegistry::copyDesc(const VulkanPipelineDesc &desc, VulkanPipelineEntry &entry)
+{
+    entry.desc = desc;
+
+    // Own everything the shader stages point to, the request may be compiled after the caller returns
+    const size_t stageCount = desc.shaderStagesInfo.size();
+    entry.entryPointNames.reserve(stageCount);
+    entry.specializationInfos.reserve(stageCount);
+    entry.specializationMapEntries.reserve(stageCount);
+    entry.specializationData.reserve(stageCount);
+    for (const auto &stage : desc.shaderStagesInfo)
+    {
+        entry.entryPointNames.push_back((stage.pName != nullptr) ? stage.pName : "");
+
+        const VkSpecializationInfo *specialization = stage.pSpecializationInfo;
+        if (specialization == nullptr)
+            continue;
+        entry.specializationMapEntries.emplace_back(specialization->pMapEntries, specialization->pMapEntries + specialization->mapEntryCount);
+        const uint8_t *data = reinterpret_cast<const uint8_t*>(specialization->pData);
+        entry.specializationData.emplace_back(data, data + specialization->dataSize);
+        entry.specializationInfos.push_back({
+            specialization->mapEntryCount,                  // mapEntryCount
+            entry.specializationMapEntries.back().data(),   // pMapEntries
+            specialization->dataSize,                       // dataSize
+            entry.specializationData.back().data()          // pData
+        });
+    }
+
+    // The vectors were reserved so the addresses are stable
+    size_t specializationIndex = 0;
+    for (size_t stageIndex = 0; stageIndex < stageCount; ++stageIndex)
+    {
+        VkPipelineShaderStageCreateInfo &stage = entry.desc.shaderStagesInfo[stageIndex];
+        stage.pName = entry.entryPointNames[stageIndex].c_str();
+        if (stage.pSpecializationInfo != nullptr)
+            stage.pSpecializationInfo = &entry.specializationInfos[specializationIndex++];
+    }
+}
+
+void VulkanPipelineRegistry::buildKey(const VulkanPipelineDesc &desc, std::vector<uint8_t> &key)
+{
+    // Every field is appended on its own so struct padding never ends up in the key
+    appendValue(key, desc.width);
+    appendValue(key, desc.height);
+
+    // Vertex layout
+    appendValue(key, static_cast<uint32_t>(desc.vertexInputState.vertexBindingDescriptions.size()));
+    for (const auto &binding : desc.vertexInputState.vertexBindingDescriptions)
+    {
+        appendValue(key, binding.binding);
+        appendValue(key, binding.stride);
+        appendValue(key, binding.inputRate);
+    }
+    appendValue(key, static_cast<uint32_t>(desc.vertexInputState.vertexAttributeDescriptions.size()));
+    for (const auto &attribute : desc.vertexInputState.vertexAttributeDescriptions)
+    {
+        appendValue(key, attribute.location);
+        appendValue(key, attribute.binding);
+        appendValue(key, attribute.format);
+        appendValue(key, attribute.offset);
+    }
+
+    // Depth stencil
+    appendValue(key, static_cast<uint8_t>(desc.depthStencilState.depthTestEnabled));
+    appendValue(key, static_cast<uint8_t>(desc.depthStencilState.depthWriteEnabled));
+    appendValue(key, desc.depthStencilState.depthCompareOp);
+    appendValue(key, static_cast<uint8_t>(desc.depthStencilState.stencilTestEnabled));
+    appendStencilOpState(key, desc.depthStencilState.stencilFrontOpState);
+    appendStencilOpState(key, desc.depthStencilState.stencilBackOpState);
+
+    // Shader stages
+    appendValue(key, static_cast<uint32_t>(desc.shaderStagesInfo.size()));
+    for (const auto &stage : desc.shaderStagesInfo)
+    {
+        appendValue(key, stage.flags);
+        appendValue(key, stage.stage);
+        appendValue(key, stage.module);
+        appendBytes(key, stage.pName, (stage.pName != nullptr) ? std::strlen(stage.pName) : 0);
+        const VkSpecializationInfo *specialization = stage.pSpecializationInfo;
+        appendValue(key, static_cast<uint32_t>((specialization != nullptr) ? specialization->mapEntryCount : 0));
+        if (specialization != nullptr)
+        {
+            for (uint32_t entryIndex = 0; entryIndex < specialization->mapEntryCount; ++entryIndex)
+            {
+                appendValue(key, specialization->pMapEntries[entryIndex].constantID);
+                appendValue(key, specialization->pMapEntries[entryIndex].offset);
+                appendValue(key, static_cast<uint64_t>(specialization->pMapEntries[entryIndex].size));
+            }
+            appendBytes(key, specialization->pData, specialization->dataSize);
+        }
+    }
+
+    // Blend states
+    appendValue(key, static_cast<uint32_t>(desc.colorBlendStates.size()));
+    for (const auto &blendState : desc.colorBlendStates)
+    {
+        appendValue(key, blendState.blendEnable);
+        appendValue(key, blendState.srcColorBlendFactor);
+        appendValue(key, blendState.dstColorBlendFactor);
+        appendValue(key, blendState.colorBlendOp);
+        appendValue(key, blendState.srcAlphaBlendFactor);
+        appendValue(key, blendState.dstAlphaBlendFactor);
+        appendValue(key, blendState.alphaBlendOp);
+        appendValue(key, blendState.colorWriteMask);
+    }
+
+    // Dynamic states
+    appendValue(key, static_cast<uint32_t>(desc.dynamicStates.size()));
+    for (const auto &dynamicState : desc.dynamicStates)
+        appendValue(key, dynamicState);
+
+    appendValue(key, desc.sampleCount);
+    appendValue(key, desc.pipelineLayout);
+    appendValue(key, desc.renderPassCompatibilityKey);
+}
+
+uint64_t VulkanPipelineRegistry::hashKey(const std::vector<uint8_t> &key)
+{
+    // FNV-1a - stable between runs and platforms
+    uint64_t hash = 14695981039346656037ull;
+    for (const uint8_t byte : key)
+    {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
\ No newline at end of file
@@ -3,18 +3,15 @@
 #include <assert.h>
 #include <vector>
 #include <iostream>
-#include <limits>
 
-bool VulkanSynchronizationObject::init(VkDevice device, uint32_t waitForObjectCount, uint32_t signalObjectCount, uint32_t fencesCount)
+bool VulkanSynchronizationObject::init(VkDevice device, uint32_t waitForObjectCount, uint32_t signalObjectCount)
 {
-    assert((waitForObjectCount != 0 || signalObjectCount != 0 || fencesCount != 0) && "Invalid parameters. At least one count needs to be non-zero.");
+    assert((waitForObjectCount != 0 || signalObjectCount != 0) && "Invalid parameters. At least one count needs to be non-zero.");
 
     if (waitForObjectCount != 0)
         waitForObjects.resize(waitForObjectCount);
     if (signalObjectCount != 0)
         signalObjects.resize(signalObjectCount);
-    if (fencesCount != 0)
-        fences.resize(fencesCount);
 
     // Semaphores
     VkSemaphoreCreateInfo semaphoreCreateInfo = {};
@@ -40,19 +37,6 @@ bool VulkanSynchronizationObject::init(VkDevice device, uint32_t waitForObjectCo
         }
     }
 
-    // Fence objects
-    VkFenceCreateInfo fenceCreateInfo = {};
-    fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    for (auto fenceObjectIndex = 0; fenceObjectIndex < fencesCount; ++fenceObjectIndex)
-    {
-        if (vkCreateFence(device, &fenceCreateInfo, nullptr, &fences[fenceObjectIndex]) != VK_SUCCESS)
-        {
-            std::cout << "Failed to create fence object. \n";
-            return false;
-        }
-    }
-
     // Success
     return true;
 }
@@ -72,97 +56,82 @@ void VulkanSynchronizationObject::cleanup(VkDevice device)
         if (signalObject != VK_NULL_HANDLE)
             vkDestroySemaphore(device, signalObject, nullptr);
     }
-
-    // Fence object
-    for (auto &fenceObject : fences)
-    {
-        if (fenceObject != VK_NULL_HANDLE)
-            vkDestroyFence(device, fenceObject, nullptr);
-    }
 }
 
-void VulkanQueue::init(VkDevice logicalDevice, uint32_t queueFamilyIndex, uint32_t queueIndex)
+bool VulkanQueue::init(VkDevice logicalDevice, uint32_t queueFamilyIndex, uint32_t queueIndex)
 {
     assert(queueFamilyIndex != -1 && "\nInvalid queue family index.");
     assert(queueFamilyIndex >= 0 && "\nInvalid queue index.");
 
-    m_device = &logicalDevice;
+    m_queueFamilyIndex = queueFamilyIndex;
     vkGetDeviceQueue(logicalDevice, queueFamilyIndex, queueIndex, &m_queueHandle);
-}
 
-bool VulkanQueue::submitCommandBuffers(VkDevice logicalDevice, const std::vector<VkCommandBuffer> &commandBuffers) const
-{
-    // Submit info
-    VkSubmitInfo submitInfo = {};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    // Timeline signalled by every submit to this queue
+    if (m_timeline.init(logicalDevice) == false)
+        return false;
 
-    // No sync objects to wait for or signal
-    submitInfo.waitSemaphoreCount = 0;
-    submitInfo.pWaitSemaphores = nullptr;
-    submitInfo.signalSemaphoreCount = 0;
-    submitInfo.pSignalSemaphores = nullptr;
+    // Success
+    return true;
+}
 
-    // Command buffers
-    submitInfo.commandBufferCount = commandBuffers.size();
-    submitInfo.pCommandBuffers = commandBuffers.data();
+void VulkanQueue::cleanup(VkDevice logicalDevice)
+{
+    m_timeline.cleanup(logicalDevice);
+}
 
-    // Fence object
-    VkFence signalFence = VK_NULL_HANDLE;
-    VkFenceCreateInfo fenceCreateInfo = {};
-    fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceCreateInfo.flags = 0;
-    if (vkCreateFence(logicalDevice, &fenceCreateInfo, nullptr, &signalFence) != VK_SUCCESS)
+bool VulkanQueue::submitCommandBuffers(const std::vector<VkCommandBuffer> &commandBuffers,
+    uint64_t &submissionValue,
+    const std::vector<VulkanSemaphoreWait> &waitSemaphores,
+    const std::vector<VkSemaphore> &signalSemaphores)
+{
+    // Wait semaphores
+    std::vector<VkSemaphore> waitHandles;
+    std::vector<uint64_t> waitValues;
+    std::vector<VkPipelineStageFlags> waitStages;
+    for (auto &waitSemaphore : waitSemaphores)
     {
-        std::cout << "Failed to create fence object. \n";
-        return false;
+        waitHandles.push_back(waitSemaphore.semaphore);
+        waitValues.push_back(waitSemaphore.value);
+        waitStages.push_back(waitSemaphore.stage);
     }
 
-    // Submit command buffers to queue
-    // Pass in fence object to be signalled once the command buffer finishes the work
-    if (vkQueueSubmit(m_queueHandle, 1, &submitInfo, signalFence) != VK_SUCCESS)
-    {
-        std::cout << "Failed to submit command buffers to queue.\n";
-        return false;
-    }
+    // Signal semaphores - the queue timeline is always the last one
+    std::vector<VkSemaphore> signalHandles = signalSemaphores;
+    std::vector<uint64_t> signalValues(signalSemaphores.size(), 0);
+    signalHandles.push_back(m_timeline.get());
 
-    // Wait for the command buffer to finish executing
-    if (vkWaitForFences(logicalDevice, 1, &signalFence, VK_TRUE, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS)
-    {
-        std::cout << "Failed to wait for the fence submit command buffer to be signalled.\n";
-        return false;
-    }
+    std::lock_guard<std::mutex> lock(m_submitMutex);
 
-    // Success
-    return true;
-}
+    // Values have to reach the queue in increasing order so they are reserved under the lock
+    submissionValue = m_timeline.nextValue();
+    signalValues.push_back(submissionValue);
 
-bool VulkanQueue::submitCommandBuffers(const VulkanSynchronizationObject &syncObject, 
-    uint32_t currentFrameIndex, 
-    const std::vector<VkCommandBuffer> &commandBuffers) const
-{
-    assert(currentFrameIndex != -1 && "Invalid current frame index");
+    // Timeline values - ignored for the binary semaphores
+    VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo = {};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timelineSubmitInfo.waitSemaphoreValueCount = waitValues.size();
+    timelineSubmitInfo.pWaitSemaphoreValues = waitValues.data();
+    timelineSubmitInfo.signalSemaphoreValueCount = signalValues.size();
+    timelineSubmitInfo.pSignalSemaphoreValues = signalValues.data();
 
     // Submit info
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineSubmitInfo;
 
     // Sync objects
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = &syncObject.waitForObjects[currentFrameIndex];
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &syncObject.signalObjects[currentFrameIndex];
-
-    // Wait before writing color data to the attachment
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submitInfo.pWaitDstStageMask = waitStages;
+    submitInfo.waitSemaphoreCount = waitHandles.size();
+    submitInfo.pWaitSemaphores = waitHandles.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
+    submitInfo.signalSemaphoreCount = signalHandles.size();
+    submitInfo.pSignalSemaphores = signalHandles.data();
 
     // Command buffers
     submitInfo.commandBufferCount = commandBuffers.size();
     submitInfo.pCommandBuffers = commandBuffers.data();
-    
+
     // Submit command buffers to queue
-    // Pass in fence object to be signalled once the command buffer finishes the work
-    if (vkQueueSubmit(m_queueHandle, 1, &submitInfo, syncObject.fences[currentFrameIndex]) != VK_SUCCESS)
+    if (vkQueueSubmit(m_queueHandle, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
     {
         std::cout << "Failed to submit command buffers to queue.\n";
         return false;
@@ -170,4 +139,14 @@ bool VulkanQueue::submitCommandBuffers(const VulkanSynchronizationObject &syncOb
 
     // Success
     return true;
+}
+
+bool VulkanQueue::submitCommandBuffersAndWait(const std::vector<VkCommandBuffer> &commandBuffers)
+{
+    uint64_t submissionValue = 0;
+    if (submitCommandBuffers(commandBuffers, submissionValue) == false)
+        return false;
+
+    // Wait for the command buffers to finish executing
+    return m_timeline.wait(submissionValue);
 }
\ No newline at end of file
@@ -0,0 +1,641 @@
+#include "VulkanRenderGraph.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    // Image usage flag a resource usage needs
+    VkImageUsageFlags imageUsageFlags(VulkanResourceUsage usage)
+    {
+        switch (usage)
+        {
+            case VulkanResourceUsage::TransferSrc:
+                return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            case VulkanResourceUsage::TransferDst:
+                return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            case VulkanResourceUsage::GraphicsShaderRead:
+            case VulkanResourceUsage::FragmentShaderRead:
+            case VulkanResourceUsage::ComputeShaderRead:
+                return VK_IMAGE_USAGE_SAMPLED_BIT;
+            case VulkanResourceUsage::ComputeShaderWrite:
+                return VK_IMAGE_USAGE_STORAGE_BIT;
+            case VulkanResourceUsage::ColorAttachment:
+                return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+            case VulkanResourceUsage::DepthStencilAttachment:
+                return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            case VulkanResourceUsage::DepthStencilRead:
+                return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+            default:
+                return 0;
+        }
+    }
+
+    // The pass needs the previous contents
+    bool readsContents(VulkanResourceUsage usage, bool attachment, VkAttachmentLoadOp loadOp)
+    {
+        if (attachment)
+            return loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+        return usage != VulkanResourceUsage::TransferDst && usage != VulkanResourceUsage::ComputeShaderWrite;
+    }
+
+    // The pass changes the contents
+    bool writesContents(VulkanResourceUsage usage, bool attachment)
+    {
+        if (attachment)
+            return usage != VulkanResourceUsage::DepthStencilRead;
+        return usage == VulkanResourceUsage::TransferDst || usage == VulkanResourceUsage::ComputeShaderWrite;
+    }
+
+    const VkImageUsageFlags AttachmentUsageMask = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+}
+
+VulkanRenderGraphResource VulkanRenderGraph::createImage(const std::string &name, const VulkanRenderGraphImageDesc &desc)
+{
+    assert(m_compiled == false && "The render graph is already compiled.");
+
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    m_resources.push_back(resource);
+
+    VulkanRenderGraphResource handle;
+    handle.index = static_cast<uint32_t>(m_resources.size() - 1);
+    return handle;
+}
+
+VulkanRenderGraphResource VulkanRenderGraph::importImage(const std::string &name, const VulkanRenderGraphImageDesc &desc, VulkanResourceUsage finalUsage)
+{
+    VulkanRenderGraphResource handle = createImage(name, desc);
+    m_resources[handle.index].imported = true;
+    m_resources[handle.index].finalUsage = finalUsage;
+    return handle;
+}
+
+VulkanRenderGraphPass VulkanRenderGraph::addPass(const std::string &name, ExecuteCallback execute)
+{
+    assert(m_compiled == false && "The render graph is already compiled.");
+
+    Pass pass;
+    pass.name = name;
+    pass.execute = execute;
+    m_passes.push_back(pass);
+
+    VulkanRenderGraphPass handle;
+    handle.index = static_cast<uint32_t>(m_passes.size() - 1);
+    return handle;
+}
+
+void VulkanRenderGraph::writeColor(VulkanRenderGraphPass pass, VulkanRenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearColorValue clearValue)
+{
+    VkClearValue value = {};
+    value.color = clearValue;
+    addAccess(pass, resource, VulkanResourceUsage::ColorAttachment, true, loadOp, value);
+}
+
+void VulkanRenderGraph::writeDepthStencil(VulkanRenderGraphPass pass, VulkanRenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearDepthStencilValue clearValue)
+{
+    VkClearValue value = {};
+    value.depthStencil = clearValue;
+    addAccess(pass, resource, VulkanResourceUsage::DepthStencilAttachment, true, loadOp, value);
+}
+
+void VulkanRenderGraph::readDepthStencil(VulkanRenderGraphPass pass, VulkanRenderGraphResource resource)
+{
+    addAccess(pass, resource, VulkanResourceUsage::DepthStencilRead, true, VK_ATTACHMENT_LOAD_OP_LOAD, {});
+}
+
+void VulkanRenderGraph::read(VulkanRenderGraphPass pass, VulkanRenderGraphResource resource, VulkanResourceUsage usage)
+{
+    addAccess(pass, resource, usage, false, VK_ATTACHMENT_LOAD_OP_LOAD, {});
+}
+
+void VulkanRenderGraph::setSideEffects(VulkanRenderGraphPass pass)
+{
+    assert(m_compiled == false && "The render graph is already compiled.");
+    m_passes[pass.index].sideEffects = true;
+}
+
+void VulkanRenderGraph::setSubpassContents(VulkanRenderGraphPass pass, VkSubpassContents subpassContents)
+{
+    m_passes[pass.index].subpassContents = subpassContents;
+}
+
+bool VulkanRenderGraph::compile(VkDevice device, const VulkanPhysicalDevice &physicalDevice, VulkanMemoryAllocator &allocator)
+{
+    assert(m_compiled == false && "The render graph is already compiled.");
+
+    m_device = device;
+    m_allocator = &allocator;
+
+    cullPasses();
+    computeLifetimes();
+
+    for (uint32_t passIndex = 0; passIndex < m_passes.size(); ++passIndex)
+    {
+        if (m_passes[passIndex].culled == false && createRenderPass(device, passIndex) == false)
+            return false;
+    }
+
+    if (createTransientImages(device, physicalDevice, allocator) == false)
+        return false;
+
+    // The resource list doesn't change anymore
+    for (auto &resource : m_resources)
+    {
+        if (resource.imported == false)
+            resource.state = &resource.ownState;
+    }
+    m_compiled = true;
+
+    // Success
+    return true;
+}
+
+void VulkanRenderGraph::cleanup(VkDevice device)
+{
+    for (auto &framebuffer : m_framebuffers)
+        vkDestroyFramebuffer(device, framebuffer.second, nullptr);
+    m_framebuffers.clear();
+
+    for (auto &pass : m_passes)
+        pass.renderPass.cleanup(device);
+    m_passes.clear();
+
+    for (auto &resource : m_resources)
+    {
+        if (resource.imported)
+            continue;
+        if (resource.imageView != VK_NULL_HANDLE)
+            vkDestroyImageView(device, resource.imageView, nullptr);
+        if (resource.image != VK_NULL_HANDLE)
+            vkDestroyImage(device, resource.image, nullptr);
+    }
+    m_resources.clear();
+
+    for (auto &aliasGroup : m_aliasGroups)
+        m_allocator->free(device, aliasGroup.memory);
+    m_aliasGroups.clear();
+
+    m_compiled = false;
+}
+
+void VulkanRenderGraph::setProfiler(VulkanGpuProfiler *profiler)
+{
+    m_profiler = profiler;
+    if (m_profiler == nullptr || m_profiler->enabled() == false)
+        return;
+
+    for (auto &pass : m_passes)
+        pass.profilerScope = m_profiler->registerScope("pass " + pass.name);
+}
+
+void VulkanRenderGraph::bindImportedImage(VulkanRenderGraphResource resource, VkImage image, VkImageView imageView, VulkanResourceState &state)
+{
+    Resource &importedResource = m_resources[resource.index];
+    assert(importedResource.imported && "Only imported images can be bound.");
+
+    importedResource.image = image;
+    importedResource.imageView = imageView;
+    importedResource.state = &state;
+}
+
+bool VulkanRenderGraph::execute(VkCommandBuffer commandBuffer)
+{
+    assert(m_compiled && "The render graph isn't compiled.");
+
+    for (uint32_t passIndex = 0; passIndex < m_passes.size(); ++passIndex)
+    {
+        Pass &pass = m_passes[passIndex];
+        if (pass.culled)
+            continue;
+
+        // Move every resource of the pass to its usage - one barrier call for the whole pass
+        for (const Access &access : pass.accesses)
+        {
+            Resource &resource = m_resources[access.resource];
+            assert(resource.state != nullptr && "Imported image not bound.");
+
+            // The memory was used by another image - wait for it and start from undefined contents
+            if (resource.firstPass == passIndex && resource.aliasPredecessor != -1)
+            {
+                const VulkanResourceState &previousState = *m_resources[resource.aliasPredecessor].state;
+                VulkanResourceState &state = *resource.state;
+                state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                state.writeStages = previousState.writeStages | previousState.readStages;
+                state.writeAccess = previousState.writeAccess;
+                state.readStages = 0;
+                state.readAccess = 0;
+            }
+
+            const VkImageSubresourceRange range = {
+                formatAspectMask(resource.desc.format),     // aspectMask
+                0,                                          // baseMipLevel
+                1,                                          // levelCount
+                0,                                          // baseArrayLayer
+                1                                           // layerCount
+            };
+            // Cleared attachments don't need the previous contents
+            if (access.attachment && access.loadOp != VK_ATTACHMENT_LOAD_OP_LOAD)
+                m_barriers.image(resource.image, range, *resource.state, VulkanResourceUsage::Undefined);
+            m_barriers.image(resource.image, range, *resource.state, access.usage);
+        }
+        m_barriers.flush(commandBuffer);
+
+        // Render pass and everything recorded by the pass
+        VulkanGpuScope gpuScope(m_profiler, commandBuffer, pass.profilerScope);
+
+        VulkanRenderGraphContext context = {
+            commandBuffer,                  // commandBuffer
+            VK_NULL_HANDLE,                 // renderPass
+            VK_NULL_HANDLE,                 // framebuffer
+            pass.extent                     // extent
+        };
+        if (pass.attachmentAccesses.empty())
+        {
+            pass.execute(context);
+            continue;
+        }
+
+        context.renderPass = pass.renderPass.get();
+        context.framebuffer = getFramebuffer(passIndex);
+        if (context.framebuffer == VK_NULL_HANDLE)
+            return false;
+
+        VkRenderPassBeginInfo renderPassBeginInfo = {};
+        renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassBeginInfo.renderPass = context.renderPass;
+        renderPassBeginInfo.framebuffer = context.framebuffer;
+        renderPassBeginInfo.renderArea.offset = { 0, 0 };
+        renderPassBeginInfo.renderArea.extent = pass.extent;
+        // One per attachment, only read for the cleared ones
+        renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(pass.clearValues.size());
+        renderPassBeginInfo.pClearValues = pass.clearValues.data();
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, pass.subpassContents);
+        pass.execute(context);
+        vkCmdEndRenderPass(commandBuffer);
+    }
+
+    // Leave the imported images the way their owner expects them
+    for (auto &resource : m_resources)
+    {
+        if (resource.imported == false || resource.finalUsage == VulkanResourceUsage::Undefined || resource.state == nullptr)
+            continue;
+
+        const VkImageSubresourceRange range = { formatAspectMask(resource.desc.format), 0, 1, 0, 1 };
+        m_barriers.image(resource.image, range, *resource.state, resource.finalUsage);
+    }
+    m_barriers.flush(commandBuffer);
+
+    // Success
+    return true;
+}
+
+void VulkanRenderGraph::printStatistics() const
+{
+    const uint32_t culledPassCount = std::count_if(m_passes.begin(), m_passes.end(), [](const Pass &pass) { return pass.culled; });
+
+    std::cout << "\nRender graph: " << m_passes.size() << " passes (" << culledPassCount << " culled), "
+        << m_aliasGroups.size() << " memory ranges for the transient images, "
+        << m_aliasedBytes << " bytes instead of " << m_transientBytes << "\n";
+}
+
+void VulkanRenderGraph::addAccess(VulkanRenderGraphPass pass, VulkanRenderGraphResource resource, VulkanResourceUsage usage, bool attachment, VkAttachmentLoadOp loadOp, VkClearValue clearValue)
+{
+    assert(m_compiled == false && "The render graph is already compiled.");
+    assert(pass.valid() && resource.valid() && "Invalid render graph handle.");
+
+    Access access = {};
+    access.resource = resource.index;
+    access.usage = usage;
+    access.attachment = attachment;
+    access.loadOp = loadOp;
+    access.clearValue = clearValue;
+    m_passes[pass.index].accesses.push_back(access);
+
+    // Transient images are created with the union of their usages
+    m_resources[resource.index].usage |= attachment ? imageUsageFlags(usage) & AttachmentUsageMask : imageUsageFlags(usage);
+}
+
+void VulkanRenderGraph::cullPasses()
+{
+    // Walk back from the imported images. A pass is kept if it writes a resource that a kept pass
+    // (or the owner of an imported image) reads later. Overwriting a resource ends the need for it.
+    std::vector<bool> neededResources(m_resources.size());
+    for (uint32_t resourceIndex = 0; resourceIndex < m_resources.size(); ++resourceIndex)
+        neededResources[resourceIndex] = m_resources[resourceIndex].imported;
+
+    for (auto pass = m_passes.rbegin(); pass != m_passes.rend(); ++pass)
+    {
+        bool alive = pass->sideEffects;
+        for (const Access &access : pass->accesses)
+            alive |= writesContents(access.usage, access.attachment) && neededResources[access.resource];
+        pass->culled = (alive == false);
+        if (pass->culled)
+            continue;
+
+        for (const Access &access : pass->accesses)
+        {
+            if (writesContents(access.usage, access.attachment) && readsContents(access.usage, access.attachment, access.loadOp) == false)
+                neededResources[access.resource] = false;
+        }
+        for (const Access &access : pass->accesses)
+        {
+            if (readsContents(access.usage, access.attachment, access.loadOp))
+                neededResources[access.resource] = true;
+        }
+    }
+}
+
+void VulkanRenderGraph::computeLifetimes()
+{
+    for (uint32_t passIndex = 0; passIndex < m_passes.size(); ++passIndex)
+    {
+        if (m_passes[passIndex].culled)
+            continue;
+
+        for (const Access &access : m_passes[passIndex].accesses)
+        {
+            Resource &resource = m_resources[access.resource];
+            resource.firstPass = std::min(resource.firstPass, passIndex);
+            resource.lastPass = std::max(resource.lastPass, passIndex);
+        }
+    }
+}
+
+bool VulkanRenderGraph::createRenderPass(VkDevice device, uint32_t passIndex)
+{
+    Pass &pass = m_passes[passIndex];
+
+    std::vector<VkAttachmentDescription> colorAttachments;
+    VkAttachmentDescription depthStencilAttachment = {};
+    bool hasDepthStencil = false;
+    std::vector<uint32_t> colorAccesses;
+    uint32_t depthStencilAccess = 0;
+
+    for (uint32_t accessIndex = 0; accessIndex < pass.accesses.size(); ++accessIndex)
+    {
+        const Access &access = pass.accesses[accessIndex];
+        if (access.attachment == false)
+            continue;
+
+        const Resource &resource = m_resources[access.resource];
+        const VkImageAspectFlags aspectMask = formatAspectMask(resource.desc.format);
+        // Only keep the contents if a later pass or the owner of the image reads them
+        const VkAttachmentStoreOp storeOp = isReadLater(access.resource, passIndex) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        const VkImageLayout layout = resourceAccess(access.usage).layout;
+
+        VkAttachmentDescription attachment = {};
+        attachment.format = resource.desc.format;
+        attachment.samples = resource.desc.samples;
+        attachment.loadOp = (aspectMask & (VK_IMAGE_ASPECT_COLOR_BIT | VK_IMAGE_ASPECT_DEPTH_BIT)) ? access.loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachment.storeOp = (aspectMask & (VK_IMAGE_ASPECT_COLOR_BIT | VK_IMAGE_ASPECT_DEPTH_BIT)) ? storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachment.stencilLoadOp = (aspectMask & VK_IMAGE_ASPECT_STENCIL_BIT) ? access.loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachment.stencilStoreOp = (aspectMask & VK_IMAGE_ASPECT_STENCIL_BIT) ? storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        // The barriers before the pass already moved the image to its subpass layout
+        attachment.initialLayout = layout;
+        attachment.finalLayout = layout;
+
+        if (access.usage == VulkanResourceUsage::ColorAttachment)
+        {
+            colorAttachments.push_back(attachment);
+            colorAccesses.push_back(accessIndex);
+        }
+        else
+        {
+            assert(hasDepthStencil == false && "A pass can only have one depth stencil attachment.");
+            depthStencilAttachment = attachment;
+            depthStencilAccess = accessIndex;
+            hasDepthStencil = true;
+        }
+
+        if (pass.attachmentAccesses.empty())
+            pass.extent = resource.desc.extent;
+        assert(pass.extent.width == resource.desc.extent.width && pass.extent.height == resource.desc.extent.height &&
+            "The attachments of a pass must have the same size.");
+        pass.attachmentAccesses.push_back(accessIndex);
+    }
+
+    // Passes without attachments record outside of a render pass
+    if (pass.attachmentAccesses.empty())
+        return true;
+
+    // Framebuffer attachment order
+    pass.attachmentAccesses = colorAccesses;
+    if (hasDepthStencil)
+        pass.attachmentAccesses.push_back(depthStencilAccess);
+    for (uint32_t accessIndex : pass.attachmentAccesses)
+        pass.clearValues.push_back(pass.accesses[accessIndex].clearValue);
+
+    if (pass.renderPass.init(device, colorAttachments, hasDepthStencil ? &depthStencilAttachment : nullptr) == false)
+    {
+        std::cout << "Failed to create the render pass of the " << pass.name << " pass.\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
+
+bool VulkanRenderGraph::createTransientImages(VkDevice device, const VulkanPhysicalDevice &physicalDevice, VulkanMemoryAllocator &allocator)
+{
+    std::vector<uint32_t> aliasedResources;
+    std::vector<uint32_t> lazyResources;
+    const VkPhysicalDeviceMemoryProperties &memoryProperties = physicalDevice.getMemoryProperties();
+
+    for (uint32_t resourceIndex = 0; resourceIndex < m_resources.size(); ++resourceIndex)
+    {
+        Resource &resource = m_resources[resourceIndex];
+        if (resource.imported || resource.firstPass > resource.lastPass)
+            continue;
+
+        // Attachments that are never read outside their render pass can live in tile memory
+        const bool attachmentOnly = (resource.usage & ~AttachmentUsageMask) == 0;
+
+        VkImageCreateInfo imageCreateInfo = {};
+        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.format = resource.desc.format;
+        imageCreateInfo.extent = { resource.desc.extent.width, resource.desc.extent.height, 1 };
+        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.arrayLayers = 1;
+        imageCreateInfo.samples = resource.desc.samples;
+        imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageCreateInfo.usage = resource.usage | (attachmentOnly ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : 0);
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (vkCreateImage(device, &imageCreateInfo, nullptr, &resource.image) != VK_SUCCESS)
+        {
+            std::cout << "Failed to create the " << resource.name << " render graph image.\n";
+            return false;
+        }
+        vkGetImageMemoryRequirements(device, resource.image, &resource.memoryRequirements);
+        m_transientBytes += resource.memoryRequirements.size;
+
+        bool lazilyAllocated = false;
+        for (uint32_t memoryTypeIndex = 0; memoryTypeIndex < memoryProperties.memoryTypeCount && attachmentOnly; ++memoryTypeIndex)
+        {
+            lazilyAllocated |= (resource.memoryRequirements.memoryTypeBits & (1 << memoryTypeIndex)) &&
+                (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+        }
+        if (lazilyAllocated)
+            lazyResources.push_back(resourceIndex);
+        else
+            aliasedResources.push_back(resourceIndex);
+    }
+
+    // Largest images first, each one joins the first group whose images are all dead during its lifetime
+    std::sort(aliasedResources.begin(), aliasedResources.end(), [this](uint32_t a, uint32_t b) {
+        return m_resources[a].memoryRequirements.size > m_resources[b].memoryRequirements.size;
+    });
+    const size_t aliasedGroupCount = m_aliasGroups.size();
+    for (uint32_t resourceIndex : aliasedResources)
+    {
+        Resource &resource = m_resources[resourceIndex];
+        AliasGroup *aliasGroup = nullptr;
+        for (size_t groupIndex = aliasedGroupCount; groupIndex < m_aliasGroups.size() && aliasGroup == nullptr; ++groupIndex)
+        {
+            AliasGroup &candidate = m_aliasGroups[groupIndex];
+            if ((candidate.memoryRequirements.memoryTypeBits & resource.memoryRequirements.memoryTypeBits) == 0)
+                continue;
+            const bool overlaps = std::any_of(candidate.resources.begin(), candidate.resources.end(), [this, &resource](uint32_t other) {
+                return m_resources[other].firstPass <= resource.lastPass && resource.firstPass <= m_resources[other].lastPass;
+            });
+            if (overlaps == false)
+                aliasGroup = &candidate;
+        }
+        if (aliasGroup == nullptr)
+        {
+            m_aliasGroups.push_back(AliasGroup());
+            aliasGroup = &m_aliasGroups.back();
+            aliasGroup->memoryRequirements = resource.memoryRequirements;
+        }
+
+        aliasGroup->memoryRequirements.size = std::max(aliasGroup->memoryRequirements.size, resource.memoryRequirements.size);
+        aliasGroup->memoryRequirements.alignment = std::max(aliasGroup->memoryRequirements.alignment, resource.memoryRequirements.alignment);
+        aliasGroup->memoryRequirements.memoryTypeBits &= resource.memoryRequirements.memoryTypeBits;
+        aliasGroup->resources.push_back(resourceIndex);
+    }
+
+    // In use order - every image waits for the previous one, the first one for the last one of the previous frame
+    for (auto &aliasGroup : m_aliasGroups)
+    {
+        std::sort(aliasGroup.resources.begin(), aliasGroup.resources.end(), [this](uint32_t a, uint32_t b) {
+            return m_resources[a].firstPass < m_resources[b].firstPass;
+        });
+        if (aliasGroup.resources.size() < 2)
+            continue;
+        for (size_t memberIndex = 0; memberIndex < aliasGroup.resources.size(); ++memberIndex)
+        {
+            const size_t previousIndex = (memberIndex + aliasGroup.resources.size() - 1) % aliasGroup.resources.size();
+            m_resources[aliasGroup.resources[memberIndex]].aliasPredecessor = aliasGroup.resources[previousIndex];
+        }
+    }
+    const size_t lazyGroupIndex = m_aliasGroups.size();
+    for (uint32_t resourceIndex : lazyResources)
+    {
+        AliasGroup aliasGroup;
+        aliasGroup.memoryRequirements = m_resources[resourceIndex].memoryRequirements;
+        aliasGroup.resources.push_back(resourceIndex);
+        m_aliasGroups.push_back(aliasGroup);
+    }
+
+    // One allocation per group, shared by its images
+    for (size_t groupIndex = 0; groupIndex < m_aliasGroups.size(); ++groupIndex)
+    {
+        AliasGroup &aliasGroup = m_aliasGroups[groupIndex];
+        const VkMemoryPropertyFlags memoryPropertyFlags = (groupIndex >= lazyGroupIndex) ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        if (allocator.allocate(device, aliasGroup.memoryRequirements, memoryPropertyFlags, VulkanResourceType::Optimal, aliasGroup.memory) == false)
+            return false;
+        m_aliasedBytes += aliasGroup.memoryRequirements.size;
+
+        for (uint32_t resourceIndex : aliasGroup.resources)
+        {
+            Resource &resource = m_resources[resourceIndex];
+            resource.aliasGroup = static_cast<uint32_t>(groupIndex);
+            if (vkBindImageMemory(device, resource.image, aliasGroup.memory.memory, aliasGroup.memory.offset) != VK_SUCCESS)
+            {
+                std::cout << "Failed to bind the memory of the " << resource.name << " render graph image.\n";
+                return false;
+            }
+
+            VkImageViewCreateInfo imageViewCreateInfo = {};
+            imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            imageViewCreateInfo.image = resource.image;
+            imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            imageViewCreateInfo.format = resource.desc.format;
+            imageViewCreateInfo.components = { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+            imageViewCreateInfo.subresourceRange = { formatAspectMask(resource.desc.format), 0, 1, 0, 1 };
+            if (vkCreateImageView(device, &imageViewCreateInfo, nullptr, &resource.imageView) != VK_SUCCESS)
+            {
+                std::cout << "Failed to create the view of the " << resource.name << " render graph image.\n";
+                return false;
+            }
+        }
+    }
+
+    // Success
+    return true;
+}
+
+bool VulkanRenderGraph::isReadLater(uint32_t resourceIndex, uint32_t passIndex) const
+{
+    // The next use decides - a read needs the contents, a full overwrite doesn't
+    for (uint32_t laterPassIndex = passIndex + 1; laterPassIndex < m_passes.size(); ++laterPassIndex)
+    {
+        const Pass &laterPass = m_passes[laterPassIndex];
+        if (laterPass.culled)
+            continue;
+
+        bool written = false;
+        for (const Access &access : laterPass.accesses)
+        {
+            if (access.resource != resourceIndex)
+                continue;
+            if (readsContents(access.usage, access.attachment, access.loadOp))
+                return true;
+            written |= writesContents(access.usage, access.attachment);
+        }
+        if (written)
+            return false;
+    }
+
+    // Imported images are read by their owner
+    return m_resources[resourceIndex].imported;
+}
+
+VkFramebuffer VulkanRenderGraph::getFramebuffer(uint32_t passIndex)
+{
+    const Pass &pass = m_passes[passIndex];
+
+    // Imported views change from frame to frame (one per swap chain image)
+    std::pair<uint32_t, std::vector<VkImageView>> key;
+    key.first = passIndex;
+    for (uint32_t accessIndex : pass.attachmentAccesses)
+        key.second.push_back(m_resources[pass.accesses[accessIndex].resource].imageView);
+
+    auto cached = m_framebuffers.find(key);
+    if (cached != m_framebuffers.end())
+        return cached->second;
+
+    VkFramebufferCreateInfo framebufferCreateInfo = {};
+    framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferCreateInfo.renderPass = pass.renderPass.get();
+    framebufferCreateInfo.attachmentCount = static_cast<uint32_t>(key.second.size());
+    framebufferCreateInfo.pAttachments = key.second.data();
+    framebufferCreateInfo.width = pass.extent.width;
+    framebufferCreateInfo.height = pass.extent.height;
+    framebufferCreateInfo.layers = 1;
+
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    if (vkCreateFramebuffer(m_device, &framebufferCreateInfo, nullptr, &framebuffer) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create the framebuffer of the " << pass.name << " pass.\n";
+        return VK_NULL_HANDLE;
+    }
+
+    m_framebuffers[key] = framebuffer;
+    return framebuffer;
+}
\ No newline at end of file
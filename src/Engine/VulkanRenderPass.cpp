@@ -2,61 +2,63 @@
 
 #include <iostream>
 
-bool VulkanRenderPass::init(VkDevice device, VkFormat swapChainFormat)
+bool VulkanRenderPass::init(VkDevice device,
+    const std::vector<VkAttachmentDescription> &colorAttachments,
+    const VkAttachmentDescription *depthStencilAttachment)
 {
-    VkAttachmentDescription colorAttachment = {};
-    colorAttachment.format = swapChainFormat;
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    // What to do with the data in the attachment berfore rendering
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    // What to do with the data in the attachment after rendering
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; // ?
-    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE; // ?
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    // Attachment reference
-    VkAttachmentReference colorAttachmentReference = {};
-    // Index of the attachment in the attachment description array
-    colorAttachmentReference.attachment = 0;
-    // The layout of the attachment during the subpass
-    colorAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    // Color attachments first, the depth stencil attachment last
+    std::vector<VkAttachmentDescription> attachments = colorAttachments;
+    std::vector<VkAttachmentReference> colorAttachmentReferences;
+    for (uint32_t attachmentIndex = 0; attachmentIndex < colorAttachments.size(); ++attachmentIndex)
+    {
+        // Index of the attachment in the attachment description array and its layout during the subpass
+        colorAttachmentReferences.push_back({ attachmentIndex, colorAttachments[attachmentIndex].initialLayout });
+    }
+    VkAttachmentReference depthStencilAttachmentReference = {};
+    if (depthStencilAttachment != nullptr)
+    {
+        depthStencilAttachmentReference.attachment = static_cast<uint32_t>(attachments.size());
+        depthStencilAttachmentReference.layout = depthStencilAttachment->initialLayout;
+        attachments.push_back(*depthStencilAttachment);
+    }
 
     // Subpass description
     VkSubpassDescription subpassDescription = {};
     subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpassDescription.colorAttachmentCount = 1;
-    subpassDescription.pColorAttachments = &colorAttachmentReference;
-
-    // Dependency
-    VkSubpassDependency dependency = {};
-    // Implicit subpass before of after the render pass
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    // Dependent subpass index
-    dependency.dstSubpass = 0;
-    // Specifies the stages to wait for
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    // Specifies the operations to wait for
-    dependency.srcAccessMask = 0;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    subpassDescription.colorAttachmentCount = static_cast<uint32_t>(colorAttachmentReferences.size());
+    subpassDescription.pColorAttachments = colorAttachmentReferences.data();
+    subpassDescription.pDepthStencilAttachment = (depthStencilAttachment != nullptr) ? &depthStencilAttachmentReference : nullptr;
 
-    // Render pass
+    // Render pass - no dependencies, the implicit external ones are enough since there is no layout transition
     VkRenderPassCreateInfo renderPassCreateInfo = {};
     renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassCreateInfo.attachmentCount = 1;
-    renderPassCreateInfo.pAttachments = &colorAttachment;
+    renderPassCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+    renderPassCreateInfo.pAttachments = attachments.data();
     renderPassCreateInfo.subpassCount = 1;
     renderPassCreateInfo.pSubpasses = &subpassDescription;
-    renderPassCreateInfo.dependencyCount = 1;
-    renderPassCreateInfo.pDependencies = &dependency;
+    renderPassCreateInfo.dependencyCount = 0;
+    renderPassCreateInfo.pDependencies = nullptr;
     
     if (vkCreateRenderPass(device, &renderPassCreateInfo, nullptr, &m_renderPass) != VK_SUCCESS)
     {
         std::cout << "Failed to create render pass.\n";
         return false;
     }
+    m_attachmentCount = static_cast<uint32_t>(attachments.size());
+
+    // Single subpass - the formats and the sample counts of the attachments are all that can differ.
+    // FNV-1a over them, a missing depth attachment counts as one more attachment.
+    m_compatibilityKey = 14695981039346656037ull;
+    const auto hashValue = [this](uint64_t value) {
+        m_compatibilityKey ^= value;
+        m_compatibilityKey *= 1099511628211ull;
+    };
+    for (const auto &colorAttachment : colorAttachments)
+        hashValue((static_cast<uint64_t>(colorAttachment.format) << 32) | static_cast<uint64_t>(colorAttachment.samples));
+    if (depthStencilAttachment != nullptr)
+        hashValue((static_cast<uint64_t>(depthStencilAttachment->format) << 32) | static_cast<uint64_t>(depthStencilAttachment->samples));
+    else
+        hashValue(0);
 
     // Success
     return true;
@@ -66,4 +68,5 @@ void VulkanRenderPass::cleanup(VkDevice device)
 {
     if (m_renderPass != VK_NULL_HANDLE)
         vkDestroyRenderPass(device, m_renderPass, nullptr);
+    m_renderPass = VK_NULL_HANDLE;
 }
\ No newline at end of file
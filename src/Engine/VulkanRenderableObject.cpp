@@ -0,0 +1,67 @@
+#include "VulkanRenderableObject.h"
+
+#include <assert.h>
+#include <algorithm>
+
+bool VulkanRenderableObject::pushConstants(VkCommandBuffer commandBuffer, 
+    VkPipelineLayout pipelineLayout, 
+    uint32_t offset, 
+    uint32_t size, 
+    const void *data) const
+{
+    // Every stage whose range overlaps the written bytes has to be in the flags
+    VkShaderStageFlags stageFlags = 0;
+    for (const auto &range : m_pushConstantRanges)
+    {
+        if (offset < range.offset + range.size && range.offset < offset + size)
+        {
+            // And its range has to contain all of them
+            if (offset < range.offset || offset + size > range.offset + range.size)
+            {
+                assert(false && "Push constant write across several ranges.");
+                return false;
+            }
+            stageFlags |= range.stageFlags;
+        }
+    }
+    if (stageFlags == 0)
+    {
+        assert(false && "Push constant write outside of the pipeline layout ranges.");
+        return false;
+    }
+
+    vkCmdPushConstants(commandBuffer, pipelineLayout, stageFlags, offset, size, data);
+
+    // Success
+    return true;
+}
+
+void sortDrawList(const std::vector<const VulkanRenderableObject*> &renderables,
+    std::vector<std::pair<float, const VulkanRenderableObject*>> &sortKeys,
+    std::vector<const VulkanRenderableObject*> &drawList)
+{
+    // Opaque renderables nearest first, then the blended ones farthest first. The keys are read
+    // once per renderable, the sort is stable so equal depths keep the order they were added in.
+    sortKeys.clear();
+    for (const VulkanRenderableObject *renderableObject : renderables)
+    {
+        if (renderableObject->isOpaque())
+            sortKeys.push_back({ renderableObject->sortDepth(), renderableObject });
+    }
+    const size_t opaqueCount = sortKeys.size();
+    for (const VulkanRenderableObject *renderableObject : renderables)
+    {
+        if (renderableObject->isOpaque() == false)
+            sortKeys.push_back({ -renderableObject->sortDepth(), renderableObject });
+    }
+
+    auto byKey = [](const std::pair<float, const VulkanRenderableObject*> &a, const std::pair<float, const VulkanRenderableObject*> &b) {
+        return a.first < b.first;
+    };
+    std::stable_sort(sortKeys.begin(), sortKeys.begin() + opaqueCount, byKey);
+    std::stable_sort(sortKeys.begin() + opaqueCount, sortKeys.end(), byKey);
+
+    drawList.clear();
+    for (const auto &sortKey : sortKeys)
+        drawList.push_back(sortKey.second);
+}
\ No newline at end of file
@@ -8,11 +8,21 @@ bool VulkanShader::init(VkDevice device,
     VkShaderStageFlagBits shaderStage)
 {
     // Shader module
-    if (createShaderModule(device, shaderFilename) == 0)
+    std::vector<char> shaderBinary;
+    if (createShaderModule(device, shaderFilename, shaderBinary) == 0)
+        return false;
+
+    // Resource interface - used to build the pipeline layouts
+    if (m_reflection.init(shaderBinary, shaderStage) == false)
+    {
+        std::cout << "Failed to reflect the shader: " << shaderFilename << ".\n";
         return false;
+    }
 
     // Shader stage
     m_shaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    m_shaderStageCreateInfo.pNext = nullptr;
+    m_shaderStageCreateInfo.flags = 0;
     m_shaderStageCreateInfo.stage = shaderStage;
     m_shaderStageCreateInfo.pName = "main";
     m_shaderStageCreateInfo.module = m_shaderModule;
@@ -22,23 +32,41 @@ bool VulkanShader::init(VkDevice device,
     return true;
 }
 
+VkPipelineShaderStageCreateInfo VulkanShader::shaderStageInfo(const VulkanSpecializationConstants &constants) const
+{
+    const auto &declaredConstants = m_reflection.specializationConstants();
+    for (const auto &value : constants.values())
+    {
+        auto declaredConstant = declaredConstants.find(value.first);
+        if (declaredConstant == declaredConstants.end())
+            std::cout << "Specialization constant " << value.first << " isn't declared by the shader.\n";
+        else if (declaredConstant->second != value.second.size())
+            std::cout << "Specialization constant " << value.first << " has the wrong size.\n";
+    }
+
+    VkPipelineShaderStageCreateInfo shaderStageCreateInfo = m_shaderStageCreateInfo;
+    shaderStageCreateInfo.pSpecializationInfo = constants.info();
+    return shaderStageCreateInfo;
+}
+
 void VulkanShader::cleanup(VkDevice device)
 {
     vkDestroyShaderModule(device, m_shaderModule, nullptr);
 }
 
 bool VulkanShader::createShaderModule(VkDevice device,
-    const std::string &shaderFilename)
+    const std::string &shaderFilename,
+    std::vector<char> &shaderBinary)
 {
     // Read the spir-v binary
-    auto vertexShaderBinary = readFile(shaderFilename);
+    shaderBinary = readFile(shaderFilename);
 
-    if (vertexShaderBinary.size() != 0)
+    if (shaderBinary.size() != 0)
     {
         VkShaderModuleCreateInfo shaderModuleCreateInfo = {};
         shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        shaderModuleCreateInfo.pCode = reinterpret_cast<uint32_t*>(vertexShaderBinary.data());
-        shaderModuleCreateInfo.codeSize = vertexShaderBinary.size();
+        shaderModuleCreateInfo.pCode = reinterpret_cast<uint32_t*>(shaderBinary.data());
+        shaderModuleCreateInfo.codeSize = shaderBinary.size();
 
         if (vkCreateShaderModule(device, &shaderModuleCreateInfo, nullptr, &m_shaderModule) != VK_SUCCESS)
         {
@@ -0,0 +1,483 @@
+#include "VulkanShaderReflection.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    // SPIR-V constants used by the parser - see the SPIR-V specification
+    const uint32_t SpirvMagicNumber = 0x07230203;
+    const uint32_t SpirvHeaderWordCount = 5;
+
+    enum SpirvOp : uint32_t
+    {
+        OpDecorate = 71,
+        OpMemberDecorate = 72,
+        OpTypeBool = 20,
+        OpTypeInt = 21,
+        OpTypeFloat = 22,
+        OpTypeVector = 23,
+        OpTypeMatrix = 24,
+        OpTypeImage = 25,
+        OpTypeSampler = 26,
+        OpTypeSampledImage = 27,
+        OpTypeArray = 28,
+        OpTypeRuntimeArray = 29,
+        OpTypeStruct = 30,
+        OpTypePointer = 32,
+        OpConstant = 43,
+        OpSpecConstantTrue = 48,
+        OpSpecConstantFalse = 49,
+        OpSpecConstant = 50,
+        OpVariable = 59,
+        OpFunction = 54
+    };
+
+    enum SpirvDecoration : uint32_t
+    {
+        DecorationSpecId = 1,
+        DecorationBlock = 2,
+        DecorationBufferBlock = 3,
+        DecorationArrayStride = 6,
+        DecorationMatrixStride = 7,
+        DecorationBuiltIn = 11,
+        DecorationLocation = 30,
+        DecorationBinding = 33,
+        DecorationDescriptorSet = 34,
+        DecorationOffset = 35
+    };
+
+    enum SpirvStorageClass : uint32_t
+    {
+        StorageClassUniformConstant = 0,
+        StorageClassInput = 1,
+        StorageClassUniform = 2,
+        StorageClassPushConstant = 9,
+        StorageClassStorageBuffer = 12
+    };
+
+    enum SpirvDim : uint32_t
+    {
+        DimBuffer = 5,
+        DimSubpassData = 6
+    };
+}
+
+bool VulkanShaderReflection::init(const std::vector<char> &spirv, VkShaderStageFlagBits stage)
+{
+    m_stage = stage;
+    m_descriptorSets.clear();
+    m_pushConstantRanges.clear();
+    m_inputs.clear();
+    m_specializationConstants.clear();
+
+    if (spirv.size() % sizeof(uint32_t) != 0)
+    {
+        std::cout << "Invalid SPIR-V size.\n";
+        return false;
+    }
+
+    // The file data isn't guaranteed to be aligned for 32 bit reads
+    std::vector<uint32_t> code(spirv.size() / sizeof(uint32_t));
+    std::memcpy(code.data(), spirv.data(), spirv.size());
+
+    std::vector<SpirvId> ids;
+    if (parse(code, ids) == false)
+        return false;
+
+    for (uint32_t id = 0; id < ids.size(); ++id)
+    {
+        const SpirvId &variable = ids[id];
+
+        // Specialization constants are identified by their SpecId, not by their SPIR-V id
+        if (variable.hasSpecId &&
+            (variable.opcode == OpSpecConstantTrue || variable.opcode == OpSpecConstantFalse || variable.opcode == OpSpecConstant))
+        {
+            m_specializationConstants[variable.specId] = typeSize(ids, variable.typeId);
+            continue;
+        }
+
+        if (variable.opcode != OpVariable)
+            continue;
+
+        // Variables are pointers, the resource type is the pointee
+        const uint32_t typeId = ids[variable.typeId].typeId;
+
+        switch (variable.storageClass)
+        {
+            case StorageClassUniformConstant:
+            case StorageClassUniform:
+            case StorageClassStorageBuffer:
+            {
+                VkDescriptorSetLayoutBinding binding = {};
+                if (variable.hasBinding == false ||
+                    descriptorType(ids, typeId, variable.storageClass, binding.descriptorType, binding.descriptorCount) == false)
+                {
+                    break;
+                }
+                binding.binding = variable.binding;
+                binding.stageFlags = stage;
+                binding.pImmutableSamplers = nullptr;
+                m_descriptorSets[variable.set].push_back(binding);
+                break;
+            }
+            case StorageClassPushConstant:
+            {
+                // One block per stage - the range starts at its first member
+                const SpirvId &block = ids[typeId];
+                if (block.memberOffsets.empty())
+                    break;
+                const uint32_t offset = *std::min_element(block.memberOffsets.begin(), block.memberOffsets.end());
+                m_pushConstantRanges.push_back({
+                    static_cast<VkShaderStageFlags>(stage),     // stageFlags
+                    offset,                                     // offset
+                    typeSize(ids, typeId) - offset              // size
+                });
+                break;
+            }
+            case StorageClassInput:
+            {
+                // gl_VertexIndex and the like aren't fed by the vertex input state
+                if (variable.isBuiltIn || ids[typeId].isBuiltIn || variable.hasLocation == false)
+                    break;
+                m_inputs.push_back({ variable.location, inputFormat(ids, typeId) });
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Sorted so identical interfaces compare equal
+    for (auto &set : m_descriptorSets)
+    {
+        std::sort(set.second.begin(), set.second.end(),
+            [](const VkDescriptorSetLayoutBinding &a, const VkDescriptorSetLayoutBinding &b) { return a.binding < b.binding; });
+    }
+    std::sort(m_inputs.begin(), m_inputs.end(),
+        [](const VulkanShaderInput &a, const VulkanShaderInput &b) { return a.location < b.location; });
+
+    // Success
+    return true;
+}
+
+bool VulkanShaderReflection::parse(const std::vector<uint32_t> &code, std::vector<SpirvId> &ids) const
+{
+    // Header
+    //  - magic number
+    //  - version
+    //  - generator
+    //  - id bound - every id is smaller
+    //  - schema
+    if (code.size() < SpirvHeaderWordCount || code[0] != SpirvMagicNumber)
+    {
+        std::cout << "Invalid SPIR-V header.\n";
+        return false;
+    }
+    ids.resize(code[3]);
+
+    // Instructions - the first word holds the word count in its high half and the opcode in its low half
+    size_t offset = SpirvHeaderWordCount;
+    while (offset < code.size())
+    {
+        const uint32_t opcode = code[offset] & 0xffff;
+        const uint32_t wordCount = code[offset] >> 16;
+        if (wordCount == 0 || offset + wordCount > code.size())
+        {
+            std::cout << "Invalid SPIR-V instruction.\n";
+            return false;
+        }
+        const uint32_t *operands = &code[offset + 1];
+        const uint32_t operandCount = wordCount - 1;
+        offset += wordCount;
+
+        // Declarations are over once the function bodies start
+        if (opcode == OpFunction)
+            break;
+
+        switch (opcode)
+        {
+            case OpDecorate:
+            {
+                if (operandCount < 2 || operands[0] >= ids.size())
+                    break;
+                SpirvId &target = ids[operands[0]];
+                const uint32_t literal = (operandCount > 2) ? operands[2] : 0;
+                switch (operands[1])
+                {
+                    case DecorationSpecId: target.specId = literal; target.hasSpecId = true; break;
+                    case DecorationBlock: target.isBlock = true; break;
+                    case DecorationBufferBlock: target.isBufferBlock = true; break;
+                    case DecorationArrayStride: target.arrayStride = literal; break;
+                    case DecorationBuiltIn: target.isBuiltIn = true; break;
+                    case DecorationLocation: target.location = literal; target.hasLocation = true; break;
+                    case DecorationBinding: target.binding = literal; target.hasBinding = true; break;
+                    case DecorationDescriptorSet: target.set = literal; break;
+                    default: break;
+                }
+                break;
+            }
+            case OpMemberDecorate:
+            {
+                if (operandCount < 4 || operands[0] >= ids.size())
+                    break;
+                SpirvId &target = ids[operands[0]];
+                const uint32_t member = operands[1];
+                if (operands[2] == DecorationOffset)
+                {
+                    target.memberOffsets.resize(std::max<size_t>(target.memberOffsets.size(), member + 1), 0);
+                    target.memberOffsets[member] = operands[3];
+                }
+                else if (operands[2] == DecorationMatrixStride)
+                {
+                    target.memberMatrixStrides.resize(std::max<size_t>(target.memberMatrixStrides.size(), member + 1), 0);
+                    target.memberMatrixStrides[member] = operands[3];
+                }
+                break;
+            }
+            case OpTypeBool:
+            case OpTypeSampler:
+            {
+                if (operandCount < 1 || operands[0] >= ids.size())
+                    break;
+                ids[operands[0]].opcode = opcode;
+                break;
+            }
+            case OpTypeInt:
+            case OpTypeFloat:
+            {
+                if (operandCount < 2 || operands[0] >= ids.size())
+                    break;
+                SpirvId &type = ids[operands[0]];
+                type.opcode = opcode;
+                type.count = operands[1];
+                type.storageClass = (opcode == OpTypeInt && operandCount > 2) ? operands[2] : 1;
+                break;
+            }
+            case OpTypeVector:
+            case OpTypeMatrix:
+            case OpTypeArray:
+            {
+                if (operandCount < 3 || operands[0] >= ids.size())
+                    break;
+                SpirvId &type = ids[operands[0]];
+                type.opcode = opcode;
+                type.typeId = operands[1];
+                type.count = operands[2];
+                break;
+            }
+            case OpTypeRuntimeArray:
+            case OpTypeSampledImage:
+            {
+                if (operandCount < 2 || operands[0] >= ids.size())
+                    break;
+                SpirvId &type = ids[operands[0]];
+                type.opcode = opcode;
+                type.typeId = operands[1];
+                break;
+            }
+            case OpTypeImage:
+            {
+                // Result, sampled type, dim, depth, arrayed, multisampled, sampled, format
+                if (operandCount < 8 || operands[0] >= ids.size())
+                    break;
+                SpirvId &type = ids[operands[0]];
+                type.opcode = opcode;
+                type.typeId = operands[1];
+                type.count = operands[2];
+                type.storageClass = operands[6];
+                break;
+            }
+            case OpTypeStruct:
+            {
+                if (operandCount < 1 || operands[0] >= ids.size())
+                    break;
+                SpirvId &type = ids[operands[0]];
+                type.opcode = opcode;
+                type.members.assign(operands + 1, operands + operandCount);
+                break;
+            }
+            case OpTypePointer:
+            {
+                if (operandCount < 3 || operands[0] >= ids.size())
+                    break;
+                SpirvId &type = ids[operands[0]];
+                type.opcode = opcode;
+                type.storageClass = operands[1];
+                type.typeId = operands[2];
+                break;
+            }
+            case OpConstant:
+            {
+                // Result type, result, value - only the low word matters for array lengths
+                if (operandCount < 3 || operands[1] >= ids.size())
+                    break;
+                SpirvId &constant = ids[operands[1]];
+                constant.opcode = opcode;
+                constant.typeId = operands[0];
+                constant.value = operands[2];
+                break;
+            }
+            case OpSpecConstantTrue:
+            case OpSpecConstantFalse:
+            case OpSpecConstant:
+            {
+                // Result type, result, default value
+                if (operandCount < 2 || operands[1] >= ids.size())
+                    break;
+                SpirvId &constant = ids[operands[1]];
+                constant.opcode = opcode;
+                constant.typeId = operands[0];
+                // Arrays sized by a specialization constant are reflected with the default size
+                constant.value = (opcode == OpSpecConstant && operandCount > 2) ? operands[2] : 0;
+                break;
+            }
+            case OpVariable:
+            {
+                // Result type, result, storage class
+                if (operandCount < 3 || operands[1] >= ids.size())
+                    break;
+                SpirvId &variable = ids[operands[1]];
+                variable.opcode = opcode;
+                variable.typeId = operands[0];
+                variable.storageClass = operands[2];
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Every id used by a variable must have been declared
+    for (const auto &id : ids)
+    {
+        if (id.opcode == OpVariable && (id.typeId >= ids.size() || ids[id.typeId].typeId >= ids.size()))
+        {
+            std::cout << "Invalid SPIR-V variable type.\n";
+            return false;
+        }
+    }
+
+    // Success
+    return true;
+}
+
+bool VulkanShaderReflection::descriptorType(const std::vector<SpirvId> &ids,
+    uint32_t typeId,
+    uint32_t storageClass,
+    VkDescriptorType &type,
+    uint32_t &count) const
+{
+    // Arrays of descriptors
+    count = 1;
+    while (typeId < ids.size() && (ids[typeId].opcode == OpTypeArray || ids[typeId].opcode == OpTypeRuntimeArray))
+    {
+        if (ids[typeId].opcode == OpTypeRuntimeArray)
+            count = 0;
+        else if (ids[typeId].count < ids.size())
+            count *= ids[ids[typeId].count].value;
+        typeId = ids[typeId].typeId;
+    }
+    if (typeId >= ids.size())
+        return false;
+
+    const SpirvId &resource = ids[typeId];
+    switch (resource.opcode)
+    {
+        case OpTypeStruct:
+            if (storageClass == StorageClassStorageBuffer || resource.isBufferBlock)
+                type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            else
+                type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            return true;
+        case OpTypeSampledImage:
+            type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            return true;
+        case OpTypeSampler:
+            type = VK_DESCRIPTOR_TYPE_SAMPLER;
+            return true;
+        case OpTypeImage:
+            // Sampled operand - 1 used with a sampler, 2 read/written without one
+            if (resource.count == DimBuffer)
+                type = (resource.storageClass == 1) ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+            else if (resource.count == DimSubpassData)
+                type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            else
+                type = (resource.storageClass == 1) ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint32_t VulkanShaderReflection::typeSize(const std::vector<SpirvId> &ids, uint32_t typeId, uint32_t matrixStride) const
+{
+    if (typeId >= ids.size())
+        return 0;
+
+    const SpirvId &type = ids[typeId];
+    switch (type.opcode)
+    {
+        case OpTypeBool:
+            return 4;
+        case OpTypeInt:
+        case OpTypeFloat:
+            return type.count / 8;
+        case OpTypeVector:
+            return type.count * typeSize(ids, type.typeId);
+        case OpTypeMatrix:
+            // Columns are matrixStride bytes apart in blocks
+            return type.count * ((matrixStride != 0) ? matrixStride : typeSize(ids, type.typeId));
+        case OpTypeArray:
+        {
+            const uint32_t length = (type.count < ids.size()) ? ids[type.count].value : 0;
+            return length * ((type.arrayStride != 0) ? type.arrayStride : typeSize(ids, type.typeId, matrixStride));
+        }
+        case OpTypeStruct:
+        {
+            // End of the last member
+            uint32_t size = 0;
+            for (size_t memberIndex = 0; memberIndex < type.members.size(); ++memberIndex)
+            {
+                const uint32_t memberOffset = (memberIndex < type.memberOffsets.size()) ? type.memberOffsets[memberIndex] : size;
+                const uint32_t memberMatrixStride = (memberIndex < type.memberMatrixStrides.size()) ? type.memberMatrixStrides[memberIndex] : 0;
+                size = std::max(size, memberOffset + typeSize(ids, type.members[memberIndex], memberMatrixStride));
+            }
+            return size;
+        }
+        default:
+            return 0;
+    }
+}
+
+VkFormat VulkanShaderReflection::inputFormat(const std::vector<SpirvId> &ids, uint32_t typeId) const
+{
+    if (typeId >= ids.size())
+        return VK_FORMAT_UNDEFINED;
+
+    // Scalar or vector of 32 bit components
+    uint32_t componentCount = 1;
+    uint32_t componentTypeId = typeId;
+    if (ids[typeId].opcode == OpTypeVector)
+    {
+        componentCount = ids[typeId].count;
+        componentTypeId = ids[typeId].typeId;
+    }
+    if (componentTypeId >= ids.size() || componentCount < 1 || componentCount > 4)
+        return VK_FORMAT_UNDEFINED;
+
+    const SpirvId &component = ids[componentTypeId];
+    if (component.count != 32)
+        return VK_FORMAT_UNDEFINED;
+
+    static const VkFormat floatFormats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+    static const VkFormat intFormats[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+    static const VkFormat uintFormats[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+    if (component.opcode == OpTypeFloat)
+        return floatFormats[componentCount - 1];
+    if (component.opcode == OpTypeInt)
+        return (component.storageClass != 0) ? intFormats[componentCount - 1] : uintFormats[componentCount - 1];
+    return VK_FORMAT_UNDEFINED;
+}
\ No newline at end of file
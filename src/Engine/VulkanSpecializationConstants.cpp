@@ -0,0 +1,66 @@
+#include "VulkanSpecializationConstants.h"
+
+VulkanSpecializationConstants::VulkanSpecializationConstants(const VulkanSpecializationConstants &other)
+    : m_values(other.m_values)
+{
+    updateInfo();
+}
+
+VulkanSpecializationConstants &VulkanSpecializationConstants::operator=(const VulkanSpecializationConstants &other)
+{
+    // The info points into the copied vectors
+    m_values = other.m_values;
+    updateInfo();
+    return *this;
+}
+
+void VulkanSpecializationConstants::set(uint32_t constantId, bool value)
+{
+    // SPIR-V booleans are specialized with a 32 bit value
+    const VkBool32 boolValue = value ? VK_TRUE : VK_FALSE;
+    setValue(constantId, &boolValue, sizeof(boolValue));
+}
+
+void VulkanSpecializationConstants::set(uint32_t constantId, int32_t value)
+{
+    setValue(constantId, &value, sizeof(value));
+}
+
+void VulkanSpecializationConstants::set(uint32_t constantId, uint32_t value)
+{
+    setValue(constantId, &value, sizeof(value));
+}
+
+void VulkanSpecializationConstants::set(uint32_t constantId, float value)
+{
+    setValue(constantId, &value, sizeof(value));
+}
+
+void VulkanSpecializationConstants::setValue(uint32_t constantId, const void *value, size_t size)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(value);
+    m_values[constantId].assign(bytes, bytes + size);
+    updateInfo();
+}
+
+void VulkanSpecializationConstants::updateInfo()
+{
+    m_mapEntries.clear();
+    m_data.clear();
+    for (const auto &value : m_values)
+    {
+        m_mapEntries.push_back({
+            value.first,                                // constantID
+            static_cast<uint32_t>(m_data.size()),       // offset
+            value.second.size()                         // size
+        });
+        m_data.insert(m_data.end(), value.second.begin(), value.second.end());
+    }
+
+    m_info = {
+        static_cast<uint32_t>(m_mapEntries.size()),     // mapEntryCount
+        m_mapEntries.data(),                            // pMapEntries
+        m_data.size(),                                  // dataSize
+        m_data.data()                                   // pData
+    };
+}
\ No newline at end of file
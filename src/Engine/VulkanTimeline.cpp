@@ -0,0 +1,98 @@
+#include "VulkanTimeline.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <iostream>
+
+bool VulkanTimeline::init(VkDevice device)
+{
+    m_device = device;
+
+    m_getSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR");
+    m_waitSemaphores = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR");
+    if (m_getSemaphoreCounterValue == nullptr || m_waitSemaphores == nullptr)
+    {
+        std::cout << "Failed to load the timeline semaphore functions.\n";
+        return false;
+    }
+
+    // Timeline semaphores start at 0 - nothing submitted yet
+    VkSemaphoreTypeCreateInfoKHR semaphoreTypeCreateInfo = {};
+    semaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    semaphoreTypeCreateInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+
+    if (vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &m_semaphore) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create timeline semaphore.\n";
+        return false;
+    }
+
+    m_lastSubmittedValue = 0;
+    m_completedValue = 0;
+
+    // Success
+    return true;
+}
+
+void VulkanTimeline::cleanup(VkDevice device)
+{
+    if (m_semaphore != VK_NULL_HANDLE)
+        vkDestroySemaphore(device, m_semaphore, nullptr);
+    m_semaphore = VK_NULL_HANDLE;
+}
+
+uint64_t VulkanTimeline::completedValue()
+{
+    uint64_t value = 0;
+    if (VULKAN_API_CALL_POINTER(vkGetSemaphoreCounterValueKHR, m_getSemaphoreCounterValue, m_device, m_semaphore, &value) != VK_SUCCESS)
+    {
+        std::cout << "Failed to read the timeline semaphore value.\n";
+        return m_completedValue;
+    }
+
+    // Values only move forward - another thread may have read a later value meanwhile
+    uint64_t completedValue = m_completedValue;
+    while (completedValue < value && m_completedValue.compare_exchange_weak(completedValue, value) == false);
+
+    return std::max(completedValue, value);
+}
+
+bool VulkanTimeline::hasCompleted(uint64_t value)
+{
+    if (value <= m_completedValue)
+        return true;
+
+    return value <= completedValue();
+}
+
+bool VulkanTimeline::wait(uint64_t value, uint64_t timeout)
+{
+    assert(value <= m_lastSubmittedValue && "Waiting for a value that was never submitted.");
+
+    if (value <= m_completedValue)
+        return true;
+
+    VkSemaphoreWaitInfoKHR waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_semaphore;
+    waitInfo.pValues = &value;
+
+    if (VULKAN_API_CALL_POINTER(vkWaitSemaphoresKHR, m_waitSemaphores, m_device, &waitInfo, timeout) != VK_SUCCESS)
+    {
+        std::cout << "Failed to wait for the timeline semaphore to reach " << value << ".\n";
+        return false;
+    }
+
+    // Values only move forward
+    uint64_t completedValue = m_completedValue;
+    while (completedValue < value && m_completedValue.compare_exchange_weak(completedValue, value) == false);
+
+    // Success
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "VulkanUniformRing.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+bool VulkanUniformRing::init(VkDevice device,
+    VulkanMemoryAllocator &allocator,
+    const VulkanPhysicalDevice &physicalDevice,
+    VkDeviceSize frameSize,
+    uint32_t framesInFlight)
+{
+    assert(frameSize > 0 && "Invalid uniform ring frame size.");
+    assert(framesInFlight > 0 && "Invalid frames in flight count.");
+
+    m_allocator = &allocator;
+    m_framesInFlight = framesInFlight;
+
+    // Every dynamic offset has to be a multiple of minUniformBufferOffsetAlignment.
+    // Frame slices are aligned as well so the offsets inside a slice stay aligned.
+    m_alignment = std::max<VkDeviceSize>(physicalDevice.getDeviceProperties().limits.minUniformBufferOffsetAlignment, 1);
+    m_frameSize = (frameSize + m_alignment - 1) & ~(m_alignment - 1);
+
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = m_frameSize * m_framesInFlight;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    bufferCreateInfo.flags = 0;
+
+    // Create buffer
+    if (vkCreateBuffer(device, &bufferCreateInfo, nullptr, &m_buffer) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create uniform ring buffer.\n";
+        return false;
+    }
+
+    // Host visible memory is persistently mapped by the allocator
+    if (m_allocator->allocateForBuffer(device,
+        m_buffer,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        m_memory) == false)
+    {
+        std::cout << "Failed to allocate uniform ring memory.\n";
+        return false;
+    }
+    assert(m_memory.mappedData != nullptr && "Uniform ring memory is not mapped.");
+
+    beginFrame(0);
+
+    // Success
+    return true;
+}
+
+void VulkanUniformRing::cleanup(VkDevice device)
+{
+    if (m_buffer != VK_NULL_HANDLE)
+        vkDestroyBuffer(device, m_buffer, nullptr);
+    if (m_allocator != nullptr)
+        m_allocator->free(device, m_memory);
+    m_buffer = VK_NULL_HANDLE;
+}
+
+void VulkanUniformRing::beginFrame(uint32_t frameIndex)
+{
+    assert(frameIndex < m_framesInFlight && "Invalid frame index.");
+
+    m_frameBegin = m_frameSize * frameIndex;
+    m_head.store(m_frameBegin);
+}
+
+void *VulkanUniformRing::allocate(VkDeviceSize size, uint32_t &dynamicOffset)
+{
+    assert(size > 0 && "Invalid uniform block size.");
+
+    const VkDeviceSize alignedSize = (size + m_alignment - 1) & ~(m_alignment - 1);
+    const VkDeviceSize offset = m_head.fetch_add(alignedSize);
+    if (offset + alignedSize > m_frameBegin + m_frameSize)
+    {
+        std::cout << "Uniform ring frame slice is full.\n";
+        return nullptr;
+    }
+
+    dynamicOffset = static_cast<uint32_t>(offset);
+    return static_cast<char*>(m_memory.mappedData) + offset;
+}
+
+bool VulkanUniformRing::write(const void *data, VkDeviceSize size, uint32_t &dynamicOffset)
+{
+    assert(data != nullptr && "Invalid uniform data.");
+
+    void *cpuMem = allocate(size, dynamicOffset);
+    if (cpuMem == nullptr)
+        return false;
+
+    // The memory is host coherent so there is nothing to flush
+    memcpy(cpuMem, data, (size_t)size);
+
+    // Success
+    return true;
+}
\ No newline at end of file
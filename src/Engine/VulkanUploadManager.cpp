@@ -0,0 +1,547 @@
+#include "VulkanUploadManager.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    // Buffer copy offsets only need to be 4 byte aligned. Image copies need a multiple of the
+    // texel size, 16 covers every uncompressed format and the 4x4 compressed blocks.
+    const VkDeviceSize BufferCopyAlignment = 4;
+    const VkDeviceSize ImageCopyAlignment = 16;
+
+    inline VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+bool VulkanUploadManager::init(VkDevice device,
+    VulkanMemoryAllocator &allocator,
+    VulkanQueue &transferQueue,
+    VulkanQueue &graphicsQueue,
+    VkDeviceSize stagingSize,
+    uint32_t contextCount)
+{
+    assert(stagingSize > 0 && "Invalid staging ring size.");
+    assert(contextCount > 0 && "Invalid upload context count.");
+
+    m_device = device;
+    m_transferQueue = &transferQueue;
+    m_graphicsQueue = &graphicsQueue;
+    m_transferQueueFamilyIndex = transferQueue.familyIndex();
+    m_graphicsQueueFamilyIndex = graphicsQueue.familyIndex();
+    m_allocator = &allocator;
+    m_stagingSize = alignUp(stagingSize, ImageCopyAlignment);
+
+    // Staging ring
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = m_stagingSize;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    bufferCreateInfo.flags = 0;
+
+    if (vkCreateBuffer(device, &bufferCreateInfo, nullptr, &m_stagingBuffer) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create upload staging buffer.\n";
+        return false;
+    }
+
+    // Host visible memory is persistently mapped by the allocator
+    if (m_allocator->allocateForBuffer(device,
+        m_stagingBuffer,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        m_stagingMemory) == false)
+    {
+        std::cout << "Failed to allocate upload staging memory.\n";
+        return false;
+    }
+    assert(m_stagingMemory.mappedData != nullptr && "Upload staging memory is not mapped.");
+
+    // Upload contexts - command buffers are short lived so they come from transient pools
+    // which are reset as a whole when the context is recycled
+    m_contexts.resize(contextCount);
+    for (auto &context : m_contexts)
+    {
+        if (context.commandPool.init(device, m_transferQueueFamilyIndex, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT) == false)
+            return false;
+        if (context.commandBuffers.init(device, context.commandPool.get(), 1) == false)
+            return false;
+
+        if (transfersOwnership())
+        {
+            if (context.acquireCommandPool.init(device, m_graphicsQueueFamilyIndex, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT) == false)
+                return false;
+            if (context.acquireCommandBuffers.init(device, context.acquireCommandPool.get(), 1) == false)
+                return false;
+        }
+    }
+
+    // Success
+    return true;
+}
+
+void VulkanUploadManager::cleanup(VkDevice device)
+{
+    waitIdle();
+
+    for (auto &context : m_contexts)
+    {
+        // Frees the command buffers as well
+        context.commandPool.cleanup(device);
+        context.acquireCommandPool.cleanup(device);
+    }
+    m_contexts.clear();
+    m_inFlight.clear();
+
+    if (m_stagingBuffer != VK_NULL_HANDLE)
+        vkDestroyBuffer(device, m_stagingBuffer, nullptr);
+    if (m_allocator != nullptr)
+        m_allocator->free(device, m_stagingMemory);
+    m_stagingBuffer = VK_NULL_HANDLE;
+}
+
+bool VulkanUploadManager::uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size, VulkanUploadToken &token)
+{
+    assert(dstBuffer != VK_NULL_HANDLE && "Invalid upload destination buffer.");
+    assert(data != nullptr && "Invalid upload data.");
+    assert(size > 0 && "Invalid upload size.");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (beginBatch() == false)
+        return false;
+
+    // Split the upload in chunks the staging ring can hold
+    const char *srcData = static_cast<const char*>(data);
+    VkDeviceSize uploadedBytes = 0;
+    while (uploadedBytes < size)
+    {
+        const VkDeviceSize chunkSize = std::min(size - uploadedBytes, m_stagingSize);
+
+        VkDeviceSize stagingOffset = 0;
+        if (reserveStaging(chunkSize, BufferCopyAlignment, stagingOffset) == false)
+            return false;
+        memcpy(static_cast<char*>(m_stagingMemory.mappedData) + stagingOffset, srcData + uploadedBytes, (size_t)chunkSize);
+
+        VkBufferCopy copyRegion = {};
+        copyRegion.srcOffset = stagingOffset;
+        copyRegion.dstOffset = dstOffset + uploadedBytes;
+        copyRegion.size = chunkSize;
+        vkCmdCopyBuffer(m_contexts[m_currentContext].commandBuffers.get()[0], m_stagingBuffer, dstBuffer, 1, &copyRegion);
+
+        // Hand the copied range over to the graphics queue family when the batch is flushed
+        if (transfersOwnership())
+        {
+            VkBufferMemoryBarrier bufferBarrier = {};
+            bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            bufferBarrier.srcQueueFamilyIndex = m_transferQueueFamilyIndex;
+            bufferBarrier.dstQueueFamilyIndex = m_graphicsQueueFamilyIndex;
+            bufferBarrier.buffer = dstBuffer;
+            bufferBarrier.offset = copyRegion.dstOffset;
+            bufferBarrier.size = chunkSize;
+            m_contexts[m_currentContext].bufferOwnershipBarriers.push_back(bufferBarrier);
+        }
+
+        uploadedBytes += chunkSize;
+    }
+
+    token = m_contexts[m_currentContext].token;
+
+    // Success
+    return true;
+}
+
+bool VulkanUploadManager::uploadImage(VkImage dstImage,
+    VkImageAspectFlags aspect,
+    VkExtent3D extent,
+    uint32_t layerCount,
+    const void *data,
+    VkDeviceSize size,
+    VkImageLayout finalLayout,
+    VulkanUploadToken &token)
+{
+    assert(dstImage != VK_NULL_HANDLE && "Invalid upload destination image.");
+    assert(data != nullptr && "Invalid upload data.");
+    assert(size > 0 && "Invalid upload size.");
+
+    // Images are copied in one go
+    if (size > m_stagingSize)
+    {
+        std::cout << "Image upload of " << size << " bytes doesn't fit in the staging ring.\n";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (beginBatch() == false)
+        return false;
+
+    VkDeviceSize stagingOffset = 0;
+    if (reserveStaging(size, ImageCopyAlignment, stagingOffset) == false)
+        return false;
+    memcpy(static_cast<char*>(m_stagingMemory.mappedData) + stagingOffset, data, (size_t)size);
+
+    VkCommandBuffer commandBuffer = m_contexts[m_currentContext].commandBuffers.get()[0];
+
+    VkImageSubresourceRange subresourceRange = {};
+    subresourceRange.aspectMask = aspect;
+    subresourceRange.baseMipLevel = 0;
+    subresourceRange.levelCount = 1;
+    subresourceRange.baseArrayLayer = 0;
+    subresourceRange.layerCount = layerCount;
+
+    // The previous contents are overwritten so the old layout can be discarded
+    VkImageMemoryBarrier imageBarrier = {};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask = 0;
+    imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = dstImage;
+    imageBarrier.subresourceRange = subresourceRange;
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    // Texel data is tightly packed
+    VkBufferImageCopy copyRegion = {};
+    copyRegion.bufferOffset = stagingOffset;
+    copyRegion.bufferRowLength = 0;
+    copyRegion.bufferImageHeight = 0;
+    copyRegion.imageSubresource.aspectMask = aspect;
+    copyRegion.imageSubresource.mipLevel = 0;
+    copyRegion.imageSubresource.baseArrayLayer = 0;
+    copyRegion.imageSubresource.layerCount = layerCount;
+    copyRegion.imageOffset = { 0, 0, 0 };
+    copyRegion.imageExtent = extent;
+    vkCmdCopyBufferToImage(commandBuffer, m_stagingBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+
+    // Move the image to the layout it is going to be used in
+    imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageBarrier.newLayout = finalLayout;
+    if (transfersOwnership())
+    {
+        // Release - the layout transition is repeated by the acquire barrier on the graphics queue
+        imageBarrier.dstAccessMask = 0;
+        imageBarrier.srcQueueFamilyIndex = m_transferQueueFamilyIndex;
+        imageBarrier.dstQueueFamilyIndex = m_graphicsQueueFamilyIndex;
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+        m_contexts[m_currentContext].imageOwnershipBarriers.push_back(imageBarrier);
+    }
+    else
+    {
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+    }
+
+    token = m_contexts[m_currentContext].token;
+
+    // Success
+    return true;
+}
+
+bool VulkanUploadManager::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Recycle whatever the GPU is already done with
+    while (m_inFlight.empty() == false && retireOldest(false));
+
+    return flushBatch();
+}
+
+bool VulkanUploadManager::isComplete(VulkanUploadToken token)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    while (token > m_completedToken && m_inFlight.empty() == false && retireOldest(false));
+
+    return token <= m_completedToken;
+}
+
+bool VulkanUploadManager::wait(VulkanUploadToken token)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (token <= m_completedToken)
+        return true;
+
+    // The batch of the token may still be recording
+    const UploadContext &currentContext = m_contexts[m_currentContext];
+    if (currentContext.recording && currentContext.token <= token)
+    {
+        if (flushBatch() == false)
+            return false;
+    }
+
+    while (token > m_completedToken && m_inFlight.empty() == false)
+    {
+        if (retireOldest(true) == false)
+            return false;
+    }
+
+    return token <= m_completedToken;
+}
+
+bool VulkanUploadManager::waitIdle()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_contexts.empty())
+        return true;
+
+    if (flushBatch() == false)
+        return false;
+
+    while (m_inFlight.empty() == false)
+    {
+        if (retireOldest(true) == false)
+            return false;
+    }
+
+    // Success
+    return true;
+}
+
+bool VulkanUploadManager::beginBatch()
+{
+    UploadContext &context = m_contexts[m_currentContext];
+    if (context.recording)
+        return true;
+
+    // Contexts are used round robin so a context that is still in flight is always the oldest one
+    if (m_inFlight.empty() == false && m_inFlight.front() == m_currentContext)
+    {
+        if (retireOldest(true) == false)
+            return false;
+    }
+
+    // Recycle the command buffers of the context
+    if (context.commandPool.reset(m_device) == false)
+        return false;
+    if (transfersOwnership() && context.acquireCommandPool.reset(m_device) == false)
+        return false;
+    context.bufferOwnershipBarriers.clear();
+    context.imageOwnershipBarriers.clear();
+    if (context.commandBuffers.beginCommandBuffer(0, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT) == false)
+        return false;
+
+    context.token = m_nextToken++;
+    context.ringBytes = 0;
+    context.recording = true;
+
+    // Success
+    return true;
+}
+
+bool VulkanUploadManager::flushBatch()
+{
+    UploadContext &context = m_contexts[m_currentContext];
+    if (context.recording == false)
+        return true;
+
+    VkCommandBuffer commandBuffer = context.commandBuffers.get()[0];
+
+    if (transfersOwnership())
+    {
+        // Release the copied buffer ranges. The image releases were recorded after their copies.
+        for (auto &bufferBarrier : context.bufferOwnershipBarriers)
+        {
+            bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            bufferBarrier.dstAccessMask = 0;
+        }
+        if (context.bufferOwnershipBarriers.empty() == false)
+        {
+            vkCmdPipelineBarrier(commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                0, 0, nullptr, 
+                context.bufferOwnershipBarriers.size(), context.bufferOwnershipBarriers.data(), 
+                0, nullptr);
+        }
+
+        if (context.commandBuffers.endCommandBuffer(0) == false)
+            return false;
+
+        // The graphics queue waits for the copies on the GPU through the transfer timeline
+        uint64_t transferValue = 0;
+        if (m_transferQueue->submitCommandBuffers(context.commandBuffers.get(), transferValue) == false)
+            return false;
+        if (submitOwnershipAcquire(context, transferValue) == false)
+            return false;
+    }
+    else
+    {
+        // Make the copied buffer data visible to every command submitted after this batch
+        VkMemoryBarrier memoryBarrier = {};
+        memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        if (context.commandBuffers.endCommandBuffer(0) == false)
+            return false;
+
+        // One submit for the whole batch - its timeline value retires the batch and its staging range
+        if (m_transferQueue->submitCommandBuffers(context.commandBuffers.get(), context.submissionValue) == false)
+            return false;
+    }
+
+    context.ringEnd = m_head;
+    context.recording = false;
+    m_inFlight.push_back(m_currentContext);
+    m_currentContext = (m_currentContext + 1) % m_contexts.size();
+
+    // Success
+    return true;
+}
+
+bool VulkanUploadManager::submitOwnershipAcquire(UploadContext &context, uint64_t transferValue)
+{
+    VkCommandBuffer commandBuffer = context.acquireCommandBuffers.get()[0];
+
+    if (context.acquireCommandBuffers.beginCommandBuffer(0, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT) == false)
+        return false;
+
+    // Acquire barriers mirror the release barriers. Their second scope covers every command
+    // submitted to the graphics queue after this one so the frames see the uploaded data.
+    for (auto &bufferBarrier : context.bufferOwnershipBarriers)
+    {
+        bufferBarrier.srcAccessMask = 0;
+        bufferBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    }
+    for (auto &imageBarrier : context.imageOwnershipBarriers)
+    {
+        imageBarrier.srcAccessMask = 0;
+        imageBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    }
+    if (context.bufferOwnershipBarriers.empty() == false || context.imageOwnershipBarriers.empty() == false)
+    {
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            0, 0, nullptr,
+            context.bufferOwnershipBarriers.size(), context.bufferOwnershipBarriers.data(),
+            context.imageOwnershipBarriers.size(), context.imageOwnershipBarriers.data());
+    }
+
+    if (context.acquireCommandBuffers.endCommandBuffer(0) == false)
+        return false;
+
+    // Wait for the copies on the GPU, the graphics timeline value retires the whole batch
+    if (m_graphicsQueue->submitCommandBuffers(context.acquireCommandBuffers.get(),
+        context.submissionValue,
+        { { m_transferQueue->timeline().get(), transferValue, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT } }) == false)
+        return false;
+
+    // Success
+    return true;
+}
+
+bool VulkanUploadManager::retireOldest(bool block)
+{
+    assert(m_inFlight.empty() == false && "No upload batch in flight.");
+
+    UploadContext &context = m_contexts[m_inFlight.front()];
+
+    VulkanTimeline &timeline = completionQueue().timeline();
+    if (block)
+    {
+        if (timeline.wait(context.submissionValue) == false)
+            return false;
+    }
+    else if (timeline.hasCompleted(context.submissionValue) == false)
+    {
+        return false;
+    }
+
+    // Give the staging range of the batch back to the ring
+    m_usedBytes -= context.ringBytes;
+    m_tail = context.ringEnd;
+    m_completedToken = context.token;
+    m_inFlight.pop_front();
+
+    // Success
+    return true;
+}
+
+bool VulkanUploadManager::reserveStaging(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset)
+{
+    assert(size <= m_stagingSize && "Staging reservation bigger than the ring.");
+
+    // Free staging space by submitting the current batch and waiting for the oldest ones
+    while (tryReserveStaging(size, alignment, offset) == false)
+    {
+        if (flushBatch() == false)
+            return false;
+        if (retireOldest(true) == false)
+            return false;
+        if (beginBatch() == false)
+            return false;
+    }
+
+    // Success
+    return true;
+}
+
+bool VulkanUploadManager::tryReserveStaging(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset)
+{
+    if (m_usedBytes == 0)
+    {
+        // Empty ring - start over at the beginning
+        m_head = 0;
+        m_tail = 0;
+    }
+    else if (m_head == m_tail)
+    {
+        // Full ring
+        return false;
+    }
+
+    VkDeviceSize begin = alignUp(m_head, alignment);
+    VkDeviceSize consumedBytes = 0;
+    if (m_head >= m_tail)
+    {
+        // Free space is [head, end) followed by [0, tail)
+        if (begin + size <= m_stagingSize)
+        {
+            consumedBytes = begin + size - m_head;
+        }
+        else if (size <= m_tail)
+        {
+            // Wrap around, the bytes left at the end belong to the current batch
+            begin = 0;
+            consumedBytes = m_stagingSize - m_head + size;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // Free space is [head, tail)
+        if (begin + size > m_tail)
+            return false;
+        consumedBytes = begin + size - m_head;
+    }
+
+    m_head = begin + size;
+    m_usedBytes += consumedBytes;
+    m_contexts[m_currentContext].ringBytes += consumedBytes;
+    offset = begin;
+
+    // Success
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,361 @@
+#include "EngineMicrobenchmarks.h"
+
+#include "VertexFormat.h"
+#include "VulkanGpuProfiler.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+
+VkDeviceSize EngineMicrobenchmarks::uniformFrameSize(uint32_t objectCount)
+{
+    // One aligned block per renderable and per frame
+    return std::max<VkDeviceSize>(MicrobenchDevice::DefaultUniformFrameSize, VkDeviceSize(objectCount) * 256);
+}
+
+bool EngineMicrobenchmarks::init(MicrobenchDevice &device, uint32_t objectCount, uint32_t seed)
+{
+    m_device = &device;
+
+    if (createPipelineState() == false)
+        return false;
+
+    if (createDescriptors() == false)
+        return false;
+
+    if (createRenderables(objectCount, seed) == false)
+        return false;
+
+    // Submission - one primary command buffer, waiting on a binary semaphore like the swap chain one
+    if (m_commandBuffers.init(device.device(), device.commandPool(), 1) == false)
+        return false;
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    if (vkCreateSemaphore(device.device(), &semaphoreCreateInfo, nullptr, &m_waitSemaphore) != VK_SUCCESS ||
+        vkCreateSemaphore(device.device(), &semaphoreCreateInfo, nullptr, &m_signalSemaphore) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create the microbenchmark semaphores.\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
+
+void EngineMicrobenchmarks::cleanup()
+{
+    if (m_device == nullptr)
+        return;
+    const VkDevice device = m_device->device();
+
+    m_renderableList.clear();
+    m_drawList.clear();
+    m_sortKeys.clear();
+    m_renderables.clear();
+    m_device->pipelineRegistry().release(m_drawState.pipeline);
+
+    if (m_waitSemaphore != VK_NULL_HANDLE)
+        vkDestroySemaphore(device, m_waitSemaphore, nullptr);
+    if (m_signalSemaphore != VK_NULL_HANDLE)
+        vkDestroySemaphore(device, m_signalSemaphore, nullptr);
+    if (m_drawState.vertexBuffer != VK_NULL_HANDLE)
+        vkDestroyBuffer(device, m_drawState.vertexBuffer, nullptr);
+    if (m_drawState.indexBuffer != VK_NULL_HANDLE)
+        vkDestroyBuffer(device, m_drawState.indexBuffer, nullptr);
+    if (m_imageView != VK_NULL_HANDLE)
+        vkDestroyImageView(device, m_imageView, nullptr);
+    if (m_sampler != VK_NULL_HANDLE)
+        vkDestroySampler(device, m_sampler, nullptr);
+    if (m_renderPass != VK_NULL_HANDLE)
+        vkDestroyRenderPass(device, m_renderPass, nullptr);
+    if (m_vertexShaderModule != VK_NULL_HANDLE)
+        vkDestroyShaderModule(device, m_vertexShaderModule, nullptr);
+    if (m_fragmentShaderModule != VK_NULL_HANDLE)
+        vkDestroyShaderModule(device, m_fragmentShaderModule, nullptr);
+    m_waitSemaphore = m_signalSemaphore = VK_NULL_HANDLE;
+    m_device = nullptr;
+}
+
+void EngineMicrobenchmarks::addBenchmarks(Microbench &microbench)
+{
+    const std::string objectCount = std::to_string(m_renderables.size());
+
+    // Vertex input - a new vector per call
+    microbench.add("VertexPC::getBindingDescription", [](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            const std::vector<VkVertexInputBindingDescription> bindingDescriptions = VertexPC::getBindingDescription();
+            keepValue(bindingDescriptions.data());
+        }
+    });
+    microbench.add("VertexPC::getAttributeDescriptions", [](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            const std::vector<VkVertexInputAttributeDescription> attributeDescriptions = VertexPC::getAttributeDescriptions();
+            keepValue(attributeDescriptions.data());
+        }
+    });
+
+    // Submission - the semaphore lists are built once, the queue builds its own arrays every submit
+    microbench.add("VulkanQueue::submitCommandBuffers", [this](uint64_t iterations) {
+        const std::vector<VulkanSemaphoreWait> waitSemaphores = { { m_waitSemaphore, 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT } };
+        const std::vector<VkSemaphore> signalSemaphores = { m_signalSemaphore };
+        VulkanQueue &queue = m_device->graphicsQueue();
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            uint64_t submissionValue = 0;
+            queue.submitCommandBuffers(m_commandBuffers.get(), submissionValue, waitSemaphores, signalSemaphores);
+            keepValue(submissionValue);
+        }
+    });
+
+    // Uniforms - one block, then every renderable of a frame
+    microbench.add("VulkanUniformRing::write", [this](uint64_t iterations) {
+        VulkanUniformRing &uniformRing = m_device->uniformRing();
+        const VkDeviceSize blockSize = (sizeof(MicrobenchUniforms) + uniformRing.alignment() - 1) & ~(uniformRing.alignment() - 1);
+        const uint64_t blocksPerFrame = uniformRing.frameSize() / blockSize;
+        MicrobenchUniforms uniformData = {};
+        uniformRing.beginFrame(0);
+        for (uint64_t i = 0, frameBlock = 0; i < iterations; ++i, ++frameBlock)
+        {
+            if (frameBlock == blocksPerFrame)
+            {
+                uniformRing.beginFrame(0);
+                frameBlock = 0;
+            }
+            uint32_t dynamicOffset = 0;
+            uniformData.tint.x = static_cast<float>(i);
+            uniformRing.write(&uniformData, sizeof(MicrobenchUniforms), dynamicOffset);
+            keepValue(dynamicOffset);
+        }
+    });
+    microbench.add("update renderables/" + objectCount, [this](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            m_device->uniformRing().beginFrame(0);
+            for (auto &renderable : m_renderables)
+                renderable->update(1.0 / 60.0, 0);
+        }
+    });
+
+    // Render list - the sort and the inline recording loop of the main pass
+    microbench.add("sortDrawList/" + objectCount, [this](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            sortDrawList(m_renderableList, m_sortKeys, m_drawList);
+            keepValue(m_drawList.data());
+        }
+    });
+    microbench.add("record draw list/" + objectCount, [this](uint64_t iterations) {
+        const VkCommandBuffer commandBuffer = m_commandBuffers.get()[0];
+        sortDrawList(m_renderableList, m_sortKeys, m_drawList);
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            for (const VulkanRenderableObject *renderableObject : m_drawList)
+            {
+                VulkanGpuScope renderableScope(nullptr, commandBuffer, 0);
+                renderableObject->render(commandBuffer);
+            }
+        }
+    });
+
+    // Pipeline lookup - serializing, hashing and comparing the create state of an existing pipeline
+    microbench.add("VulkanPipelineRegistry::acquire hit", [this](uint64_t iterations) {
+        VulkanPipelineRegistry &pipelineRegistry = m_device->pipelineRegistry();
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            VulkanPipelineHandle pipeline = pipelineRegistry.acquire(m_pipelineDesc);
+            keepValue(pipeline.valid());
+            pipelineRegistry.release(pipeline);
+        }
+    });
+
+    // Descriptors - a persistent set rewritten, then per frame sets allocated and written
+    microbench.add("VulkanDescriptorAllocator::write", [this](uint64_t iterations) {
+        VulkanDescriptorAllocator &descriptorAllocator = m_device->descriptorAllocator();
+        for (uint64_t i = 0; i < iterations; ++i)
+            descriptorAllocator.write(m_drawState.descriptorSet, m_setLayout, m_descriptors);
+    });
+    microbench.add("VulkanDescriptorAllocator::allocate frame set", [this](uint64_t iterations) {
+        VulkanDescriptorAllocator &descriptorAllocator = m_device->descriptorAllocator();
+        const uint64_t setsPerFrame = 1024;
+        descriptorAllocator.beginFrame(0);
+        for (uint64_t i = 0, frameSet = 0; i < iterations; ++i, ++frameSet)
+        {
+            if (frameSet == setsPerFrame)
+            {
+                descriptorAllocator.beginFrame(0);
+                frameSet = 0;
+            }
+            VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+            descriptorAllocator.allocate(m_setLayout, descriptorSet, VulkanDescriptorLifetime::Frame);
+            keepValue(descriptorSet);
+        }
+    });
+}
+
+bool EngineMicrobenchmarks::createPipelineState()
+{
+    const VkDevice device = m_device->device();
+
+    // Empty shader modules and render pass - only their handles are part of the pipeline state
+    const uint32_t shaderCode = 0x07230203;
+    VkShaderModuleCreateInfo shaderModuleCreateInfo = {};
+    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleCreateInfo.codeSize = sizeof(shaderCode);
+    shaderModuleCreateInfo.pCode = &shaderCode;
+    if (vkCreateShaderModule(device, &shaderModuleCreateInfo, nullptr, &m_vertexShaderModule) != VK_SUCCESS ||
+        vkCreateShaderModule(device, &shaderModuleCreateInfo, nullptr, &m_fragmentShaderModule) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create the microbenchmark shader modules.\n";
+        return false;
+    }
+
+    VkAttachmentDescription colorAttachment = {};
+    colorAttachment.format = VK_FORMAT_B8G8R8A8_UNORM;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    VkAttachmentReference colorAttachmentReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorAttachmentReference;
+    VkRenderPassCreateInfo renderPassCreateInfo = {};
+    renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassCreateInfo.attachmentCount = 1;
+    renderPassCreateInfo.pAttachments = &colorAttachment;
+    renderPassCreateInfo.subpassCount = 1;
+    renderPassCreateInfo.pSubpasses = &subpass;
+    if (vkCreateRenderPass(device, &renderPassCreateInfo, nullptr, &m_renderPass) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create the microbenchmark render pass.\n";
+        return false;
+    }
+
+    // Layouts of shaders/benchmark.vert and shaders/benchmark.frag
+    VulkanLayoutCache &layoutCache = m_device->layoutCache();
+    m_setLayout = layoutCache.getDescriptorSetLayout({
+        { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr },
+        { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }
+    });
+    m_drawState.pushConstantRanges = { { VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4) } };
+    m_drawState.pipelineLayout = layoutCache.getPipelineLayout({ m_setLayout }, m_drawState.pushConstantRanges);
+    if (m_setLayout == VK_NULL_HANDLE || m_drawState.pipelineLayout == VK_NULL_HANDLE)
+        return false;
+
+    // Specialized fragment shader - part of the hashed state
+    m_specializationMapEntry = { 0, 0, sizeof(float) };
+    m_specializationInfo = { 1, &m_specializationMapEntry, sizeof(float), &m_brightness };
+
+    VkPipelineShaderStageCreateInfo vertexStage = {};
+    vertexStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertexStage.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    vertexStage.module = m_vertexShaderModule;
+    vertexStage.pName = "main";
+    VkPipelineShaderStageCreateInfo fragmentStage = vertexStage;
+    fragmentStage.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fragmentStage.module = m_fragmentShaderModule;
+    fragmentStage.pSpecializationInfo = &m_specializationInfo;
+
+    VkPipelineColorBlendAttachmentState colorBlendState = {};
+    colorBlendState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    m_pipelineDesc.width = 1280;
+    m_pipelineDesc.height = 720;
+    m_pipelineDesc.vertexInputState.vertexBindingDescriptions = VertexPC::getBindingDescription();
+    m_pipelineDesc.vertexInputState.vertexAttributeDescriptions = VertexPC::getAttributeDescriptions();
+    m_pipelineDesc.shaderStagesInfo = { vertexStage, fragmentStage };
+    m_pipelineDesc.colorBlendStates = { colorBlendState };
+    m_pipelineDesc.dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT };
+    m_pipelineDesc.pipelineLayout = m_drawState.pipelineLayout;
+    m_pipelineDesc.renderPass = m_renderPass;
+    m_pipelineDesc.renderPassCompatibilityKey = 1;
+
+    // Kept for the whole run so the lookups always hit
+    m_drawState.pipeline = m_device->pipelineRegistry().acquire(m_pipelineDesc);
+    if (m_drawState.pipeline.valid() == false)
+    {
+        std::cout << "Failed to create the microbenchmark pipeline.\n";
+        return false;
+    }
+
+    // Success
+    return true;
+}
+
+bool EngineMicrobenchmarks::createDescriptors()
+{
+    const VkDevice device = m_device->device();
+
+    VkSamplerCreateInfo samplerCreateInfo = {};
+    samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+    samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+    if (vkCreateSampler(device, &samplerCreateInfo, nullptr, &m_sampler) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create the microbenchmark sampler.\n";
+        return false;
+    }
+
+    // The view is never sampled so it doesn't need an image
+    VkImageViewCreateInfo imageViewCreateInfo = {};
+    imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    imageViewCreateInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageViewCreateInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    if (vkCreateImageView(device, &imageViewCreateInfo, nullptr, &m_imageView) != VK_SUCCESS)
+    {
+        std::cout << "Failed to create the microbenchmark image view.\n";
+        return false;
+    }
+
+    VulkanDescriptorInfo uniformBufferDescriptor = {};
+    uniformBufferDescriptor.buffer = { m_device->uniformRing().get(), 0, sizeof(MicrobenchUniforms) };
+    VulkanDescriptorInfo textureDescriptor = {};
+    textureDescriptor.image = { m_sampler, m_imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    m_descriptors = { uniformBufferDescriptor, textureDescriptor };
+
+    // Shared by every renderable
+    if (m_device->descriptorAllocator().allocate(m_setLayout, m_drawState.descriptorSet) == false)
+        return false;
+
+    return m_device->descriptorAllocator().write(m_drawState.descriptorSet, m_setLayout, m_descriptors);
+}
+
+bool EngineMicrobenchmarks::createRenderables(uint32_t objectCount, uint32_t seed)
+{
+    const VkDevice device = m_device->device();
+
+    // Quad geometry - never read, only bound
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    bufferCreateInfo.size = 4 * sizeof(VertexPC);
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    if (vkCreateBuffer(device, &bufferCreateInfo, nullptr, &m_drawState.vertexBuffer) != VK_SUCCESS)
+        return false;
+    bufferCreateInfo.size = 6 * sizeof(uint16_t);
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    if (vkCreateBuffer(device, &bufferCreateInfo, nullptr, &m_drawState.indexBuffer) != VK_SUCCESS)
+        return false;
+    m_drawState.indexCount = 6;
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> depth(0.1f, 0.9f);
+    for (uint32_t objectIndex = 0; objectIndex < objectCount; ++objectIndex)
+    {
+        const bool opaque = (random() % 8) != 0;
+        m_renderables.push_back(std::make_unique<MicrobenchRenderable>(m_drawState, m_device->uniformRing(), depth(random), opaque));
+        m_renderableList.push_back(m_renderables.back().get());
+    }
+
+    // Success
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "Microbench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+void Microbench::add(const std::string &name, RunCallback run)
+{
+    m_benchmarks.push_back({ name, run });
+}
+
+void Microbench::run(const MicrobenchConfig &config)
+{
+    m_results.clear();
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (const Benchmark &benchmark : m_benchmarks)
+    {
+        if (config.filter.empty() == false && benchmark.name.find(config.filter) == std::string::npos)
+            continue;
+
+        // Same iteration count for every sample so they can be compared
+        const uint64_t iterations = calibrate(benchmark.run, config.minSampleMilliseconds);
+        for (uint32_t warmupIndex = 0; warmupIndex < config.warmupSampleCount; ++warmupIndex)
+            sampleNanoseconds(benchmark.run, iterations);
+
+        std::vector<double> samples(config.sampleCount);
+        for (uint32_t sampleIndex = 0; sampleIndex < config.sampleCount; ++sampleIndex)
+            samples[sampleIndex] = sampleNanoseconds(benchmark.run, iterations) / iterations;
+
+        const MicrobenchResult result = computeResult(benchmark.name, iterations, samples);
+        m_results.push_back(result);
+
+        std::cout << std::left << std::setw(48) << result.name << std::right
+            << std::setw(12) << result.medianNanoseconds << " ns"
+            << "  [" << result.medianLowNanoseconds << ", " << result.medianHighNanoseconds << "]"
+            << "  mad " << result.madNanoseconds
+            << "  " << result.iterationsPerSample << " x " << result.sampleCount << "\n";
+    }
+}
+
+bool Microbench::writeResults(const std::string &filename) const
+{
+    std::ofstream file(filename);
+    if (file.is_open() == false)
+    {
+        std::cout << "Failed to open the microbenchmark output file " << filename << ".\n";
+        return false;
+    }
+
+    // One benchmark per line - read back by compareBaseline
+    file << std::fixed << std::setprecision(3);
+    file << "{\n";
+    file << "  \"benchmarks\": [\n";
+    for (size_t resultIndex = 0; resultIndex < m_results.size(); ++resultIndex)
+    {
+        const MicrobenchResult &result = m_results[resultIndex];
+        file << "    { \"name\": \"" << result.name << "\""
+            << ", \"iterations\": " << result.iterationsPerSample
+            << ", \"samples\": " << result.sampleCount
+            << ", \"minNs\": " << result.minNanoseconds
+            << ", \"medianNs\": " << result.medianNanoseconds
+            << ", \"meanNs\": " << result.meanNanoseconds
+            << ", \"maxNs\": " << result.maxNanoseconds
+            << ", \"madNs\": " << result.madNanoseconds
+            << ", \"stddevNs\": " << result.stddevNanoseconds
+            << ", \"medianLowNs\": " << result.medianLowNanoseconds
+            << ", \"medianHighNs\": " << result.medianHighNanoseconds << " }"
+            << ((resultIndex + 1 < m_results.size()) ? ",\n" : "\n");
+    }
+    file << "  ]\n";
+    file << "}\n";
+
+    std::cout << "\nMicrobenchmarks: " << m_results.size() << " results written to " << filename << "\n";
+
+    return file.good();
+}
+
+bool Microbench::compareBaseline(const std::string &filename, double thresholdPercent) const
+{
+    std::vector<MicrobenchResult> baseline;
+    if (readResults(filename, baseline) == false)
+    {
+        std::cout << "Failed to read the microbenchmark baseline " << filename << ".\n";
+        return false;
+    }
+
+    std::cout << "\nComparison with " << filename << ":\n";
+    uint32_t regressionCount = 0;
+    for (const MicrobenchResult &result : m_results)
+    {
+        auto baselineIt = std::find_if(baseline.begin(), baseline.end(), [&result](const MicrobenchResult &baselineResult) {
+            return baselineResult.name == result.name;
+        });
+        if (baselineIt == baseline.end())
+        {
+            std::cout << std::left << std::setw(48) << result.name << std::right << "         new\n";
+            continue;
+        }
+
+        const double changePercent = (baselineIt->medianNanoseconds > 0.0) ?
+            100.0 * (result.medianNanoseconds - baselineIt->medianNanoseconds) / baselineIt->medianNanoseconds : 0.0;
+        // Both the threshold and the confidence intervals - noisy benchmarks don't fail the run
+        const bool regressed = changePercent > thresholdPercent && result.medianLowNanoseconds > baselineIt->medianHighNanoseconds;
+        const bool improved = changePercent < -thresholdPercent && result.medianHighNanoseconds < baselineIt->medianLowNanoseconds;
+
+        std::cout << std::left << std::setw(48) << result.name << std::right
+            << std::setw(12) << baselineIt->medianNanoseconds << " ns -> "
+            << std::setw(12) << result.medianNanoseconds << " ns "
+            << std::showpos << std::setw(8) << changePercent << std::noshowpos << "%"
+            << (regressed ? "  REGRESSION" : (improved ? "  improvement" : "")) << "\n";
+
+        if (regressed)
+            ++regressionCount;
+    }
+
+    if (regressionCount != 0)
+        std::cout << regressionCount << " microbenchmarks regressed by more than " << thresholdPercent << "%.\n";
+
+    return regressionCount == 0;
+}
+
+double Microbench::sampleNanoseconds(const RunCallback &run, uint64_t iterations)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    run(iterations);
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - begin).count();
+}
+
+uint64_t Microbench::calibrate(const RunCallback &run, double minSampleMilliseconds)
+{
+    uint64_t iterations = 1;
+    while (sampleNanoseconds(run, iterations) < minSampleMilliseconds * 1e6 && iterations < (1ull << 40))
+        iterations *= 2;
+
+    return iterations;
+}
+
+MicrobenchResult Microbench::computeResult(const std::string &name, uint64_t iterations, std::vector<double> samples)
+{
+    MicrobenchResult result;
+    result.name = name;
+    result.iterationsPerSample = iterations;
+    result.sampleCount = static_cast<uint32_t>(samples.size());
+    if (samples.empty())
+        return result;
+
+    std::sort(samples.begin(), samples.end());
+    const size_t sampleCount = samples.size();
+
+    auto median = [](const std::vector<double> &sorted) {
+        const size_t middle = sorted.size() / 2;
+        return (sorted.size() % 2 == 0) ? 0.5 * (sorted[middle - 1] + sorted[middle]) : sorted[middle];
+    };
+
+    double total = 0.0;
+    for (double sample : samples)
+        total += sample;
+
+    result.minNanoseconds = samples.front();
+    result.maxNanoseconds = samples.back();
+    result.medianNanoseconds = median(samples);
+    result.meanNanoseconds = total / sampleCount;
+
+    double squaredDeviations = 0.0;
+    std::vector<double> absoluteDeviations(sampleCount);
+    for (size_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex)
+    {
+        const double deviation = samples[sampleIndex] - result.meanNanoseconds;
+        squaredDeviations += deviation * deviation;
+        absoluteDeviations[sampleIndex] = std::abs(samples[sampleIndex] - result.medianNanoseconds);
+    }
+    std::sort(absoluteDeviations.begin(), absoluteDeviations.end());
+    result.madNanoseconds = median(absoluteDeviations);
+    result.stddevNanoseconds = (sampleCount > 1) ? std::sqrt(squaredDeviations / (sampleCount - 1)) : 0.0;
+
+    // Distribution free - the ranks bounding the median with 95% confidence come from the binomial distribution
+    const double halfWidth = 1.96 * std::sqrt(static_cast<double>(sampleCount)) / 2.0;
+    const double lowRank = std::floor(sampleCount / 2.0 - halfWidth);
+    const double highRank = std::ceil(sampleCount / 2.0 + halfWidth);
+    result.medianLowNanoseconds = samples[static_cast<size_t>(std::max(0.0, lowRank))];
+    result.medianHighNanoseconds = samples[std::min(sampleCount - 1, static_cast<size_t>(std::max(0.0, highRank)))];
+
+    return result;
+}
+
+bool Microbench::readResults(const std::string &filename, std::vector<MicrobenchResult> &results)
+{
+    std::ifstream file(filename);
+    if (file.is_open() == false)
+        return false;
+
+    // Only reads the layout written by writeResults
+    auto readNumber = [](const std::string &line, const std::string &key) {
+        const size_t keyPosition = line.find("\"" + key + "\": ");
+        return (keyPosition == std::string::npos) ? 0.0 : std::strtod(line.c_str() + keyPosition + key.size() + 4, nullptr);
+    };
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const std::string nameKey = "\"name\": \"";
+        const size_t nameBegin = line.find(nameKey);
+        if (nameBegin == std::string::npos)
+            continue;
+        const size_t nameEnd = line.find('"', nameBegin + nameKey.size());
+        if (nameEnd == std::string::npos)
+            continue;
+
+        MicrobenchResult result;
+        result.name = line.substr(nameBegin + nameKey.size(), nameEnd - nameBegin - nameKey.size());
+        result.iterationsPerSample = static_cast<uint64_t>(readNumber(line, "iterations"));
+        result.sampleCount = static_cast<uint32_t>(readNumber(line, "samples"));
+        result.minNanoseconds = readNumber(line, "minNs");
+        result.medianNanoseconds = readNumber(line, "medianNs");
+        result.meanNanoseconds = readNumber(line, "meanNs");
+        result.maxNanoseconds = readNumber(line, "maxNs");
+        result.madNanoseconds = readNumber(line, "madNs");
+        result.stddevNanoseconds = readNumber(line, "stddevNs");
+        result.medianLowNanoseconds = readNumber(line, "medianLowNs");
+        result.medianHighNanoseconds = readNumber(line, "medianHighNs");
+        results.push_back(result);
+    }
+
+    return results.empty() == false;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "MicrobenchDevice.h"
+
+#include <iostream>
+
+bool MicrobenchDevice::init(VkDeviceSize uniformFrameSize)
+{
+    // Headless - no window system
+    if (m_instance.init("Microbenchmarks", 0, 1, 0, 1, true) == false)
+    {
+        std::cout << "Failed to create the microbenchmark instance.\n";
+        return false;
+    }
+
+    if (m_physicalDevice.init(m_instance.get(), VK_QUEUE_GRAPHICS_BIT, VK_NULL_HANDLE) == false)
+        return false;
+
+    const uint32_t graphicsQueueFamilyIndex = m_physicalDevice.getGraphicsQueueFamilyIndex();
+    if (m_logicalDevice.init(m_physicalDevice.get(), { graphicsQueueFamilyIndex }, 1, nullptr, false) == false)
+        return false;
+
+    const VkDevice device = m_logicalDevice.get();
+
+    // Small blocks - the resources of the microbenchmarks are tiny
+    if (m_memoryAllocator.init(m_physicalDevice, 16 * 1024 * 1024) == false)
+        return false;
+
+    if (m_graphicsQueue.init(device, graphicsQueueFamilyIndex, 0) == false)
+        return false;
+
+    if (m_commandPool.init(device, graphicsQueueFamilyIndex, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT) == false)
+        return false;
+
+    if (m_layoutCache.init(device) == false)
+        return false;
+
+    if (m_descriptorAllocator.init(device, m_layoutCache, FramesInFlight) == false)
+        return false;
+
+    if (m_uniformRing.init(device, m_memoryAllocator, m_physicalDevice, uniformFrameSize, FramesInFlight) == false)
+        return false;
+
+    // Pipelines are compiled on the calling thread
+    if (m_pipelineRegistry.init(device, m_graphicsQueue.timeline(), nullptr, 0) == false)
+        return false;
+
+    // Success
+    return true;
+}
+
+void MicrobenchDevice::cleanup()
+{
+    const VkDevice device = m_logicalDevice.get();
+
+    m_pipelineRegistry.cleanup(device);
+    m_uniformRing.cleanup(device);
+    m_descriptorAllocator.cleanup(device);
+    m_layoutCache.cleanup(device);
+    m_commandPool.cleanup(device);
+    m_graphicsQueue.cleanup(device);
+    m_memoryAllocator.cleanup(device);
+    m_logicalDevice.cleanup();
+    m_instance.cleanup();
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "MicrobenchRenderable.h"
+
+#include <cmath>
+#include <iostream>
+
+MicrobenchRenderable::MicrobenchRenderable(const MicrobenchDrawState &drawState, VulkanUniformRing &uniformRing, float depth, bool opaque)
+    : m_drawState(drawState),
+    m_uniformRing(uniformRing),
+    m_depth(depth),
+    m_opaque(opaque)
+{
+    m_pushConstantRanges = drawState.pushConstantRanges;
+    m_pushConstants.model = glm::mat4(1.0f);
+    m_pushConstants.model[3][2] = -depth;
+    m_uniformData.view = glm::mat4(1.0f);
+    m_uniformData.proj = glm::mat4(1.0f);
+    m_uniformData.tint = glm::vec4(1.0f);
+}
+
+void MicrobenchRenderable::render(VkCommandBuffer currentCommandBuffer) const
+{
+    const VkPipeline pipeline = m_drawState.pipeline.get();
+    if (pipeline == VK_NULL_HANDLE)
+        return;
+
+    VkViewport viewport = {};
+    viewport.width = 1280.0f;
+    viewport.height = 720.0f;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(currentCommandBuffer, 0, 1, &viewport);
+
+    vkCmdBindPipeline(currentCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdBindDescriptorSets(currentCommandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        m_drawState.pipelineLayout,
+        0, 1, &m_drawState.descriptorSet,
+        1, &m_uniformDynamicOffset);
+    pushConstants(currentCommandBuffer, m_drawState.pipelineLayout, 0, sizeof(PushConstants), &m_pushConstants);
+
+    VkBuffer vertexBuffers[] = { m_drawState.vertexBuffer };
+    VkDeviceSize offsets[] = { 0 };
+    vkCmdBindVertexBuffers(currentCommandBuffer, 0, 1, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(currentCommandBuffer, m_drawState.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+    vkCmdDrawIndexed(currentCommandBuffer, m_drawState.indexCount, 1, 0, 0, 0);
+}
+
+void MicrobenchRenderable::update(double dt, uint32_t frameIndex)
+{
+    // Something changes every frame so the write can't be skipped
+    m_time += dt;
+    const float pulse = 0.75f + 0.25f * static_cast<float>(std::sin(m_time));
+    m_uniformData.tint = glm::vec4(pulse, pulse, pulse, 1.0f);
+    if (m_uniformRing.write(&m_uniformData, sizeof(MicrobenchUniforms), m_uniformDynamicOffset) == false)
+        std::cout << "Failed to update microbenchmark renderable uniform data.\n";
+}
\ No newline at end of file